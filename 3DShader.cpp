@@ -7,225 +7,628 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "3DShaderViewer.hpp"
+#include "MeshCache.hpp"
+#include "MeshLoader.hpp"
+#include "Profiler.hpp"
+#include "Renderer.hpp"
 #include <windows.h>
+#include <dwmapi.h>
 #include <vector>
-#include <fstream>
 #include <sstream>
 #include <string>
 #include <algorithm>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
 
 #undef min
 #undef max
 
+#ifdef _MSC_VER
+#pragma comment(lib, "dwmapi.lib")
+#endif
+
 // Window dimensions
 const int WIDTH = 800;
 const int HEIGHT = 600;
 
-// Global variables for storing geometry and transformations
+// Global variables for storing geometry and transformations: the active level and the window's render context
+// live in the portable core's structs, and the names the viewer has always used refer into them
 std::vector<Vertex> vertices;
-std::vector<Face> faces;
-std::vector<Vertex> transformed;
+DetailLevel activeLevel;
+RenderContext renderContext;
+std::vector<Face>& faces = activeLevel.faces;
+VertexStream& normalized = activeLevel.normalized;
+QuantizedStream& quantized = activeLevel.quantized;
+VertexStream& faceNormals = activeLevel.faceNormals;
+std::vector<uint8_t>& degenerateFaces = activeLevel.degenerateFaces;
+EdgeList& meshEdges = activeLevel.edges;
+MeshBvh& meshBvh = activeLevel.bvh;
+ScreenStream& screen = renderContext.screen;
+AlignedFloats& normalDepth = renderContext.normalDepth;
+ViewState frameView;
+
+// Full-detail normalization and the LOD levels built from the same mesh
+ModelFrame modelFrame = { 0, 0, 0, 1 };
+std::vector<DetailLevel> detailLevels;
+int activeDetail = 0;
+int dragDetail = 0;
+
+// Counts geometry changes (a detail level swap, a reassembled stream) so cached frames can tell they are stale
+uint64_t meshVersion = 0;
+
+// Key of the frame currently in the back buffer, if renderedFrameValid
+FrameKey renderedFrame;
+bool renderedFrameValid = false;
+
+// Offscreen back buffer and GDI object cache, kept for the window's lifetime
+RenderTarget renderTarget;
+
+// Tile-binned parallel rasterizer and its settings (-tile N, -threads N on the command line)
+TileRenderer& tileRenderer = renderContext.tiles;
+TileRendererConfig rendererConfig;
+
+// Back-to-front face order for the GDI painter's path, refreshed incrementally between frames
+DepthSorter painterSorter;
+
+// Scratch for everything that lives for one frame, reset at the start of each renderFrame
+FrameArena& frameArena = renderContext.arena;
+
+// Out-of-core streaming ("-stream path", "-budget MB"): chunks are paged in as the view needs them
+// and the render globals are rebuilt from whatever is resident
+ChunkStream chunkStream;
+bool streamingMesh = false;
+std::string streamPath;
+
+// Instanced scene ("-scene file.scene"): unique meshes swapped into the render globals one batch at a time
+Scene scene;
+std::string scenePath;
+uint64_t streamBudgetMB = CHUNK_DEFAULT_BUDGET_MB;
 
 // Mouse dragging state for rotation
 bool dragging = false;
 POINT lastMouse;    // Previous mouse position 
 float angleX = 0.0f, angleY = 0.0f; // Rotation angles
 
-// Project a 3D vertex to 2D screen coordinates
-POINT project(const Vertex& v) {
-    float scale = std::min(WIDTH, HEIGHT) * 0.4f;
-    return {
-        static_cast<LONG>(WIDTH / 2 + v.x * scale),
-        static_cast<LONG>(HEIGHT / 2 - v.y * scale)
-    };
+// Set when the angles move; the next paint re-runs applyTransform, so bursts of input cost one transform
+bool viewDirty = false;
+
+// Progressive refinement ("-progressive"): frames drawn while the view moves are previews without outlines or dots,
+// at half resolution with "-halfres", and the full frame follows once input has been idle for "-refine MS"
+bool progressiveMode = false;
+bool halfResolutionPreview = false;
+UINT refineDelayMs = 200;
+bool refinePending = false;
+bool refining = false;
+float frameScale = 1.0f;
+RenderTarget previewTarget;
+const UINT_PTR REFINE_TIMER = 1;
+
+// Rendering path: z-buffered software rasterizer, or the GDI painter's algorithm ('R' toggles)
+bool useSoftwareRasterizer = true;
+
+// Window renderers: the CPU paths above, and Direct3D 11 when a device is available ('G' toggles, "-cpu" starts on the CPU)
+std::unique_ptr<Renderer> cpuRenderer;
+std::unique_ptr<Renderer> gpuRenderer;
+Renderer* activeRenderer = nullptr;
+bool preferGpuRenderer = true;
+
+// Reorder faces and vertices for cache reuse when the mesh is loaded ("-reorder"); the cache keeps the result
+bool reorderMeshLayout = false;
+
+// Keep positions quantized to 16 bits in memory and indices in 16 bits in the binary cache ("-compact")
+bool compactMesh = false;
+
+// Reload object.txt in the background whenever it changes on disk ("-watch")
+bool watchMesh = false;
+MeshWatcher meshWatcher;
+
+// Back-face culling for closed meshes ('C' toggles it off for open or inconsistently wound meshes)
+bool cullBackFaces = true;
+
+// Outline only silhouettes, creases, boundaries and non-manifold edges ('E' toggles)
+bool featureEdgesOnly = false;
+
+// Per-stage timing overlay ('P' toggles; "-profile file.csv" also logs every frame)
+bool showProfiler = false;
+
+// Face counts from the most recent cull pass
+CullStats cullStats;
+
+// Dot counts from the most recent dot pass
+DotStats dotStats;
+
+// Face and vertex under the cursor at the last click
+BvhHit lastPick;
+
+// Center the model on its centroid and scale it into the unit sphere; runs once per load
+void normalizeVertices() {
+    modelFrame = computeModelFrame(vertices);
+    normalizePositions(vertices, normalized);
 }
 
-// Rotate a vertex around the X-axis
-Vertex rotateX(const Vertex& v, float angle) {
-    float rad = angle * 3.14159265f / 180.0f;
-    float c = cosf(rad), s = sinf(rad);
-    return {
-        v.id,
-        v.x,
-        v.y * c - v.z * s,
-        v.y * s + v.z * c
-    };
+// Same centering and scale as the full mesh, whatever the source
+void normalizePositions(const std::vector<Vertex>& source, VertexStream& out) {
+    normalizePositions(source, modelFrame, out);
 }
 
-// Rotate a vertex around the Y-axis 
-Vertex rotateY(const Vertex& v, float angle) {
-    float rad = angle * 3.14159265f / 180.0f;
-    float c = cosf(rad), s = sinf(rad);
-    return {
-        v.id,
-        v.x * c + v.z * s,
-        v.y,
-        -v.x * s + v.z * c
-    };
+// Fixed pixel mapping from view space: the unit sphere fills 80% of the shorter window side
+Projection screenProjection() {
+    return fitProjection(WIDTH, HEIGHT);
 }
 
-// Normalize, center, and rotate all vertices
+// Trig, rotation and the window's pixel mapping for one pair of angles
+ViewState makeViewState(float angleX, float angleY) {
+    return makeViewState(angleX, angleY, screenProjection());
+}
+
+// View for the current angles, then the mesh in the globals through it
 void applyTransform() {
-    transformed.clear();
-
-    // Compute model centroid
-    float cx = 0, cy = 0, cz = 0;
-    for (const auto& v : vertices) {
-        cx += v.x; cy += v.y; cz += v.z;
-    }
-    cx /= vertices.size();
-    cy /= vertices.size();
-    cz /= vertices.size();
-
-    // Calculate max distance from center
-    float maxExtent = 0;
-    for (const auto& v : vertices) {
-        float dx = v.x - cx, dy = v.y - cy, dz = v.z - cz;
-        float dist = sqrtf(dx * dx + dy * dy + dz * dz);
-        if (dist > maxExtent) maxExtent = dist;
-    }
-
-    // Normalize, rotate, and store transformed vertices
-    for (const auto& v : vertices) {
-        Vertex normed = {
-            v.id,
-            (v.x - cx) / maxExtent,
-            (v.y - cy) / maxExtent,
-            (v.z - cz) / maxExtent
-        };
-        Vertex t = rotateX(normed, angleX);
-        t = rotateY(t, angleY);
-        transformed.push_back(t);
+    frameView = makeViewState(angleX, angleY);
+    if (frameScale != 1.0f) frameView = scaledViewState(frameView, frameScale);
+    projectMesh();
+}
+
+// Project the active level's vertices once each and rotate its face normals, into the render context's streams
+void projectMesh() {
+    ProfileScope scope(STAGE_TRANSFORM);
+    projectLevel(activeLevel, frameView, renderContext);
+}
+
+// Compute unit object-space normals for every face of the globals
+void computeFaceNormals() {
+    computeFaceNormals(normalized, faces, faceNormals, degenerateFaces);
+}
+
+// Level 0 is the mesh already in the globals; its slot stays empty until another level is swapped in.
+// With compactMesh every level ends up quantized and the parsed vertices are released.
+void prepareDetailLevels(std::vector<LodLevel>& chain, std::vector<MeshBvh>& bvhs) {
+    // Levels without a hierarchy fall back to the linear cull; building one here would reorder faces after the normals
+    bvhs.resize(chain.size() + 1);
+    meshBvh = std::move(bvhs[0]);
+    normalizeBvhBounds(meshBvh, modelFrame);
+    buildMeshEdges(faces, faceNormals, degenerateFaces, meshEdges);
+    detailLevels.clear();
+    detailLevels.resize(chain.size() + 1);
+    detailLevels[0].faceCount = faces.size();
+    detailLevels[0].vertexCount = normalized.count;
+    activeDetail = 0;
+    if (compactMesh) {
+        compactPositions(normalized, quantized);
+        std::vector<Vertex>().swap(vertices);
     }
+
+    for (size_t i = 0; i < chain.size(); ++i) {
+        buildDetailLevel(chain[i].vertices, chain[i].faces, bvhs[i + 1], modelFrame, compactMesh, detailLevels[i + 1]);
+    }
+    dragDetail = dragDetailLevel(detailLevels);
+    chain.clear();
+    bvhs.clear();
+    ++meshVersion;
 }
 
-// Load vertices from file
-std::vector<Vertex> loadVertices(std::ifstream& file, int vertexCount) {
-    std::vector<Vertex> vertices;
-    std::string line;
-    for (int i = 0; i < vertexCount; ++i) {
-        std::getline(file, line);
-        if (line.empty()) { --i; continue; }
-        std::replace(line.begin(), line.end(), ',', ' ');
-        std::istringstream iss(line);
-        Vertex v;
-        iss >> v.id >> v.x >> v.y >> v.z;
-        vertices.push_back(v);
-    }
-    return vertices;
+// Exchange the globals with a level's slot
+void swapDetailLevel(DetailLevel& level) {
+    swapLevelGeometry(activeLevel, level);
 }
 
-// Load faces from file
-std::vector<Face> loadFaces(std::ifstream& file, int faceCount) {
-    std::vector<Face> faces;
-    std::string line;
-    for (int i = 0; i < faceCount; ++i) {
-        std::getline(file, line);
-        if (line.empty()) { --i; continue; }
-        std::replace(line.begin(), line.end(), ',', ' ');
-        std::istringstream iss(line);
-        Face f;
-        iss >> f.v1 >> f.v2 >> f.v3;
-        faces.push_back(f);
-    }
-    return faces;
+// The outgoing levels, active one included, are swapped into the snapshot and freed along with it
+void installMeshSnapshot(MeshSnapshot& snapshot) {
+    if (!detailLevels.empty()) swapDetailLevel(detailLevels[activeDetail]);
+    std::swap(detailLevels, snapshot.levels);
+    std::swap(vertices, snapshot.vertices);
+    modelFrame = snapshot.frame;
+    swapDetailLevel(detailLevels[0]);
+    activeDetail = 0;
+    dragDetail = snapshot.dragDetail;
+    lastPick = BvhHit();
+    ++meshVersion;
+    viewDirty = true;
+    if (activeRenderer) activeRenderer->invalidateMesh();
 }
 
-// Draw shaded model using face normals to control blue intensity
-void drawShadedModel(HDC hdc) {
-    RECT rect;
-    GetClientRect(WindowFromDC(hdc), &rect);
-
-    // Offscreen buffer for smooth rendering
-    HDC memDC = CreateCompatibleDC(hdc);
-    HBITMAP memBitmap = CreateCompatibleBitmap(hdc, rect.right, rect.bottom);
-    HBITMAP oldBitmap = (HBITMAP)SelectObject(memDC, memBitmap);
-    FillRect(memDC, &rect, (HBRUSH)(COLOR_WINDOW + 1));
-
-    std::vector<bool> vertexVisible(transformed.size(), false);
-
-    // Sort faces by average Z-depth
-    struct IndexedFace { Face face; float avgZ; };
-    std::vector<IndexedFace> sortedFaces;
-    for (const auto& f : faces) {
-        float zAvg = (transformed[f.v1 - 1].z + transformed[f.v2 - 1].z + transformed[f.v3 - 1].z) / 3.0f;
-        sortedFaces.push_back({ f, zAvg });
-    }
-    std::sort(sortedFaces.begin(), sortedFaces.end(), [](const IndexedFace& a, const IndexedFace& b) {
-        return a.avgZ < b.avgZ;
-        });
-
-    for (const auto& entry : sortedFaces) {
-        const Face& f = entry.face;
-        const Vertex& v1 = transformed[f.v1 - 1];
-        const Vertex& v2 = transformed[f.v2 - 1];
-        const Vertex& v3 = transformed[f.v3 - 1];
-
-        // Compute face normal
-        float ux = v2.x - v1.x;
-        float uy = v2.y - v1.y;
-		float uz = v2.z - v1.z;
-        float vx = v3.x - v1.x;
-		float vy = v3.y - v1.y;
-		float vz = v3.z - v1.z;
-        float nx = uy * vz - uz * vy;
-        float ny = uz * vx - ux * vz;
-        float nz = ux * vy - uy * vx;
-        float length = sqrtf(nx * nx + ny * ny + nz * nz);
-        if (length < 1e-6f) continue;
-        nx /= length; ny /= length; nz /= length;
-
-        // Blue shading based on angle with Z-axis
-        float intensity = fabs(nz);
-        int blue = static_cast<int>(0x5F + intensity * (0xFF - 0x5F));
-        COLORREF color = RGB(0, 0, blue);
+// Return the active level to its slot and bring the requested one in; the next paint re-transforms
+bool setDetailLevel(int level) {
+    if (level == activeDetail || level < 0 || level >= static_cast<int>(detailLevels.size())) return false;
+    swapDetailLevel(detailLevels[activeDetail]);
+    swapDetailLevel(detailLevels[level]);
+    activeDetail = level;
+    ++meshVersion;
+    viewDirty = true;
+    return true;
+}
+
+// Each unique mesh goes through the binary cache like object.txt and keeps its own frame and its full detail
+// level only; the render globals are left empty, since drawScene draws every mesh from its own level
+bool openScene(const char* path) {
+    SceneFile file;
+    if (!loadSceneFile(path, file)) return false;
+
+    Scene loaded;
+    std::vector<ModelFrame> meshFrames(file.meshPaths.size());
+    loaded.meshes.resize(file.meshPaths.size());
+    for (size_t i = 0; i < file.meshPaths.size(); ++i) {
+        std::vector<Vertex> positions;
+        std::vector<Face> faceList;
+        std::vector<LodLevel> lods;
+        std::vector<MeshBvh> bvhs;
+        if (!loadMeshCached(file.meshPaths[i].c_str(), positions, faceList, lods, bvhs, reorderMeshLayout, compactMesh)) return false;
+        bvhs.resize(1);
+        SceneMesh& mesh = loaded.meshes[i];
+        mesh.path = file.meshPaths[i];
+        mesh.frame = meshFrames[i] = computeModelFrame(positions);
+        buildDetailLevel(positions, faceList, bvhs[0], mesh.frame, compactMesh, mesh.level);
+    }
+    loaded.instances = std::move(file.instances);
+    loaded.frame = sceneFrame(meshFrames, loaded.instances);
+    for (const SceneInstance& instance : loaded.instances) {
+        loaded.placements.push_back(normalizedInstance(instance, meshFrames[instance.mesh], loaded.frame));
+    }
+    scene = std::move(loaded);
+
+    DetailLevel empty;
+    swapDetailLevel(empty);
+    vertices.clear();
+    modelFrame = scene.frame;
+    detailLevels.clear();
+    activeDetail = 0;
+    dragDetail = 0;
+    lastPick = BvhHit();
+    ++meshVersion;
+    return true;
+}
+
+// The header carries the full mesh's frame, so every chunk normalizes to the same space
+bool openStreamedMesh(const char* path) {
+    if (!openMeshChunks(path, streamBudgetMB << 20, chunkStream)) return false;
+    const MeshChunkHeader& header = chunkStream.header;
+    modelFrame = { header.center[0], header.center[1], header.center[2], header.extent };
+    vertices.clear();
+    streamingMesh = true;
+
+    // Chunks are decoded as floats and reassembled whenever residency changes, so streams stay full precision
+    compactMesh = false;
+    assembleStreamedMesh();
+    return true;
+}
+
+// The assembled mesh is the only detail level; it has no hierarchy, so it culls face by face and cannot be picked
+void assembleStreamedMesh() {
+    assembleResidentChunks(chunkStream, activeLevel);
+    detailLevels.clear();
+    detailLevels.resize(1);
+    detailLevels[0].faceCount = faces.size();
+    detailLevels[0].vertexCount = normalized.count;
+    activeDetail = 0;
+    dragDetail = 0;
+    lastPick = BvhHit();
+    ++meshVersion;
+    if (activeRenderer) activeRenderer->invalidateMesh();
+}
+
+// Visibility uses the window size the pick also assumes; the cull still runs against the real frame
+bool updateStreamedMesh() {
+    if (!streamingMesh) return false;
+    const ViewState state = makeViewState(angleX, angleY);
+    const BvhView view = makeBvhView(state.rotation, state.projection, WIDTH, HEIGHT, cullBackFaces);
+    if (!updateChunkStream(chunkStream, view)) return false;
+    assembleStreamedMesh();
+    return true;
+}
+
+// Fetch a projected vertex's screen position as a GDI point
+POINT screenPoint(const ScreenStream& screen, size_t i) {
+    return { static_cast<LONG>(screen.x[i]), static_cast<LONG>(screen.y[i]) };
+}
+
+// Mark vertices of front-facing triangles for the vertex-dot pass
+void markVisibleVertices(const Face& f, float nz, uint8_t* vertexVisible) {
+    if (nz > 0) {
+        vertexVisible[f.v1 - 1] = 1;
+        vertexVisible[f.v2 - 1] = 1;
+        vertexVisible[f.v3 - 1] = 1;
+    }
+}
+
+// Only a refine pass gives way to input. A held button also counts mouse moves, since those continue a drag.
+bool renderInterrupted() {
+    if (!refining) return false;
+    const UINT input = QS_MOUSEBUTTON | QS_KEY | (dragging ? QS_MOUSEMOVE : 0);
+    return HIWORD(GetQueueStatus(input)) != 0;
+}
+
+// Painter's-algorithm fallback: radix/insertion sort faces back to front and fill each with cached GDI brushes
+void drawFacesGDI(RenderTarget& target, const DetailLevel& level, RenderContext& context, const FrameArray<VisibleFace>& visible,
+    const RenderSettings& settings, uint8_t* vertexVisible) {
+    HDC memDC = target.memDC;
+    const std::vector<Face>& faces = level.faces;
+    const EdgeList& meshEdges = level.edges;
+    const ScreenStream& screen = context.screen;
+
+    // Depth key per face; the sum orders faces the same as the average
+    float* faceDepth = frameAllocate<float>(context.arena, faces.size());
+    {
+        ProfileScope scope(STAGE_SORT);
+        for (size_t i = 0; i < faces.size(); ++i) {
+            const Face& f = faces[i];
+            faceDepth[i] = screen.z[f.v1 - 1] + screen.z[f.v2 - 1] + screen.z[f.v3 - 1];
+        }
+
+        // Sorting every face (not just the visible ones) keeps the item set stable between frames,
+        // which is what lets the sorter refresh last frame's order instead of starting over
+        sortByDepth(painterSorter, faceDepth, faces.size());
+    }
+
+    // Fill and outline have to alternate face by face here, so both count as fill time
+    ProfileScope scope(STAGE_FILL);
+
+    // Look up each face's culling result while walking the sorted order, and count how many
+    // visible faces share each edge: an edge is stroked once, right after the last of them is
+    // filled, so it lands on top of both neighbours and under anything painted later
+    int32_t* visibleSlot = frameAllocate<int32_t>(context.arena, faces.size());
+    uint16_t* edgePending = frameAllocateZeroed<uint16_t>(context.arena, meshEdges.edges.size());
+    std::fill(visibleSlot, visibleSlot + faces.size(), -1);
+    for (size_t i = 0; i < visible.size; ++i) {
+        visibleSlot[visible[i].face] = static_cast<int32_t>(i);
+        if (!settings.outlines) continue;
+        const uint32_t* links = &meshEdges.faceEdges[visible[i].face * 3];
+        for (int k = 0; k < 3; ++k) {
+            if (links[k] != NO_FACE && edgePending[links[k]] < UINT16_MAX) ++edgePending[links[k]];
+        }
+    }
+
+    HGDIOBJ nullPen = GetStockObject(NULL_PEN);
+    HGDIOBJ wirePen = GetStockObject(BLACK_PEN);
+    HBRUSH oldBrush = (HBRUSH)SelectObject(memDC, shadeBrush(target, 0xFF));
+    HPEN oldPen = (HPEN)SelectObject(memDC, nullPen);
+
+    for (uint32_t faceIndex : painterSorter.order) {
+        if (visibleSlot[faceIndex] < 0) continue;
+        const Face& f = faces[faceIndex];
+        float nz = visible[visibleSlot[faceIndex]].nz;
 
         // Fill triangle
-        HBRUSH brush = CreateSolidBrush(color);
-        HBRUSH oldBrush = (HBRUSH)SelectObject(memDC, brush);
-        HPEN pen = CreatePen(PS_NULL, 0, 0);
-        HPEN oldPen = (HPEN)SelectObject(memDC, pen);
-        POINT pts[3] = { project(v1), project(v2), project(v3) };
+        SelectObject(memDC, shadeBrush(target, shadeBlue(nz)));
+        SelectObject(memDC, nullPen);
+        POINT pts[3] = { screenPoint(screen, f.v1 - 1), screenPoint(screen, f.v2 - 1), screenPoint(screen, f.v3 - 1) };
         Polygon(memDC, pts, 3);
-        SelectObject(memDC, oldBrush); DeleteObject(brush);
-        SelectObject(memDC, oldPen); DeleteObject(pen);
-
-        // Draw wireframe overlay
-        HPEN wirePen = CreatePen(PS_SOLID, 1, RGB(0, 0, 0));
-        HPEN prevPen = (HPEN)SelectObject(memDC, wirePen);
-        MoveToEx(memDC, pts[0].x, pts[0].y, nullptr);
-        LineTo(memDC, pts[1].x, pts[1].y);
-        LineTo(memDC, pts[2].x, pts[2].y);
-        LineTo(memDC, pts[0].x, pts[0].y);
-        SelectObject(memDC, prevPen); DeleteObject(wirePen);
-
-        // Mark vertices of front-facing triangles
-        if (nz > 0) {
-            vertexVisible[f.v1 - 1] = true;
-            vertexVisible[f.v2 - 1] = true;
-            vertexVisible[f.v3 - 1] = true;
+
+        // A preview draws neither outlines nor dots
+        if (vertexVisible) markVisibleVertices(f, nz, vertexVisible);
+        if (!settings.outlines) continue;
+
+        // Draw wireframe overlay for the edges this face completes
+        const uint32_t* links = &meshEdges.faceEdges[faceIndex * 3];
+        bool penSelected = false;
+        for (int k = 0; k < 3; ++k) {
+            if (links[k] == NO_FACE || --edgePending[links[k]] != 0) continue;
+            if (!edgeShown(level, context.normalDepth, settings.featureEdgesOnly, links[k])) continue;
+            if (!penSelected) {
+                SelectObject(memDC, wirePen);
+                penSelected = true;
+            }
+            const MeshEdge& e = meshEdges.edges[links[k]];
+            POINT a = screenPoint(screen, e.v[0]), b = screenPoint(screen, e.v[1]);
+            MoveToEx(memDC, a.x, a.y, nullptr);
+            LineTo(memDC, b.x, b.y);
         }
     }
 
-    // Draw visible vertex dots in blue
-    HBRUSH blueDot = CreateSolidBrush(RGB(0, 0, 255));
-    HBRUSH oldBrush = (HBRUSH)SelectObject(memDC, blueDot);
-    for (size_t i = 0; i < transformed.size(); ++i) {
-        if (!vertexVisible[i]) continue;
-        if (transformed[i].z <= 0) continue;
+    SelectObject(memDC, oldBrush);
+    SelectObject(memDC, oldPen);
+}
 
-        POINT p = project(transformed[i]);
-        Ellipse(memDC, p.x - 3, p.y - 3, p.x + 3, p.y + 3);
+namespace {
+
+// Profiler stage each core pass is timed under
+const ProfileStage PROFILE_STAGES[RENDER_STAGE_COUNT] = {
+    STAGE_TRANSFORM, STAGE_CULL, STAGE_SORT, STAGE_FILL, STAGE_WIREFRAME, STAGE_DOTS
+};
+
+// What the core's passes need from the window: profiler timing, the refine interruption, and the GDI painter's path
+class WindowRenderHooks : public RenderHooks {
+public:
+    explicit WindowRenderHooks(RenderTarget& target) : target(target) {}
+
+    void beginStage(RenderStage stage) override {
+        stageStart[stage] = profiler.enabled ? profileNow() : 0;
+    }
+
+    void endStage(RenderStage stage) override {
+        addProfileTime(PROFILE_STAGES[stage], stageStart[stage]);
+    }
+
+    bool interrupted() override {
+        return renderInterrupted();
+    }
+
+    bool paintsFaces() const override {
+        return !useSoftwareRasterizer;
+    }
+
+    // The dots go straight into the DIB, so whatever GDI has queued must land first
+    void paintFaces(const DetailLevel& level, RenderContext& context, const FrameArray<VisibleFace>& visible,
+        const RenderSettings& settings, uint8_t* vertexVisible) override {
+        drawFacesGDI(target, level, context, visible, settings, vertexVisible);
+        GdiFlush();
     }
-    SelectObject(memDC, oldBrush);
-    DeleteObject(blueDot);
+
+private:
+    RenderTarget& target;
+    LONGLONG stageStart[RENDER_STAGE_COUNT] = {};
+};
+
+} // namespace
+
+// Cull, shade, outline and dot the current view into a back buffer, without presenting it
+bool renderFrame(RenderTarget& target, bool preview) {
+    HDC memDC = target.memDC;
+    FrameBuffer& frame = target.frame;
+
+    // Finish any GDI drawing still queued against the DIB before touching its pixels
+    GdiFlush();
+
+    // Last frame's scratch is dead once a new frame starts
+    resetFrameArena(frameArena);
+
+    // A preview only shades; the clear color follows the window's
+    RenderSettings settings;
+    settings.cullBackFaces = cullBackFaces;
+    settings.featureEdgesOnly = featureEdgesOnly;
+    settings.outlines = !preview;
+    settings.dots = !preview;
+    const COLORREF background = GetSysColor(COLOR_WINDOW);
+    settings.background = packPixel(GetRValue(background), GetGValue(background), GetBValue(background));
+
+    // Counts and the dot density cap cover the whole frame, however many passes draw it
+    cullStats = CullStats();
+    dotStats = DotStats();
+    uint8_t* dotGrid = frameAllocateZeroed<uint8_t>(frameArena, dotGridSize(frame));
+    WindowRenderHooks hooks(target);
+    const bool complete = scene.instances.empty()
+        ? drawLevel(activeLevel, frameView, settings, renderContext, frame, true, dotGrid, hooks, cullStats, dotStats)
+        : drawScene(scene, frameView, settings, renderContext, frame, dotGrid, hooks, cullStats, dotStats);
+    if (!complete) return false;
+
+    // Statistics go on top of the finished image and are not themselves timed
+    if (showProfiler) {
+        char heading[64];
+        snprintf(heading, sizeof(heading), "%s / %s", useSoftwareRasterizer ? "raster" : "GDI",
+            transformKernelName(renderContext.kernel));
+        drawProfilerOverlay(memDC, heading);
+    }
+    return true;
+}
+
+// Snapshot of the inputs renderFrame reads
+FrameKey currentFrameKey() {
+    FrameKey key;
+    key.angleX = angleX;
+    key.angleY = angleY;
+    key.meshVersion = meshVersion;
+    key.targetGeneration = renderTarget.generation;
+    key.softwareRasterizer = useSoftwareRasterizer;
+    key.cullBackFaces = cullBackFaces;
+    key.featureEdgesOnly = featureEdgesOnly;
+    key.showProfiler = showProfiler;
+    key.preview = progressiveMode && refinePending;
+    key.halfResolution = key.preview && halfResolutionPreview;
+    return key;
+}
+
+// Field by field, since the bools leave padding that memcmp would read
+bool sameFrame(const FrameKey& a, const FrameKey& b) {
+    return a.angleX == b.angleX && a.angleY == b.angleY && a.meshVersion == b.meshVersion &&
+        a.targetGeneration == b.targetGeneration && a.softwareRasterizer == b.softwareRasterizer &&
+        a.cullBackFaces == b.cullBackFaces && a.featureEdgesOnly == b.featureEdgesOnly && a.showProfiler == b.showProfiler &&
+        a.preview == b.preview && a.halfResolution == b.halfResolution;
+}
+
+// Copies part of the rendered frame to the window; a half-resolution preview is stretched back over all of it
+void presentFrame(HDC hdc, const RECT& rect, bool halfResolution) {
+    if (halfResolution) {
+        const FrameBuffer& half = previewTarget.frame;
+        SetStretchBltMode(hdc, COLORONCOLOR);
+        StretchBlt(hdc, 0, 0, half.width * 2, half.height * 2, previewTarget.memDC, 0, 0, half.width, half.height, SRCCOPY);
+    }
+    else {
+        BitBlt(hdc, rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top, renderTarget.memDC, rect.left, rect.top, SRCCOPY);
+    }
+}
+
+// Draw shaded model using face normals to control blue intensity, then blit it to the window
+void drawShadedModel(HDC hdc) {
+    // The back buffer normally tracks WM_SIZE; allocate it here if no resize has arrived yet
+    if (!renderTarget.bitmap) {
+        RECT rect;
+        GetClientRect(WindowFromDC(hdc), &rect);
+        if (!resizeRenderTarget(renderTarget, rect.right, rect.bottom)) return;
+    }
+
+    // Uncovering, restoring or re-showing the window repaints without changing the view: the back buffer
+    // still holds that frame, so only the invalid rectangle is copied and nothing is re-rendered
+    const FrameBuffer& frame = renderTarget.frame;
+    const FrameKey key = currentFrameKey();
+    const RECT whole = { 0, 0, frame.width, frame.height };
+    if (renderedFrameValid && sameFrame(key, renderedFrame)) {
+        RECT dirty;
+        if (GetClipBox(hdc, &dirty) == ERROR) dirty = whole;
+        presentFrame(hdc, dirty, key.halfResolution);
+        return;
+    }
+
+    // A half-resolution preview goes to its own target, projected at half scale
+    if (key.halfResolution && !resizeRenderTarget(previewTarget, (frame.width + 1) / 2, (frame.height + 1) / 2)) return;
+    const float scale = key.halfResolution ? 0.5f : 1.0f;
+    if (scale != frameScale) {
+        frameScale = scale;
+        applyTransform();
+    }
+    if (!renderFrame(key.halfResolution ? previewTarget : renderTarget, key.preview)) {
+        // New input arrived mid-refine: keep the preview on screen and refine again once it goes quiet
+        renderedFrameValid = false;
+        refinePending = true;
+        SetTimer(WindowFromDC(hdc), REFINE_TIMER, refineDelayMs, nullptr);
+        return;
+    }
+    renderedFrame = key;
+    renderedFrameValid = true;
 
     // Blit the final image to screen
-    BitBlt(hdc, 0, 0, rect.right, rect.bottom, memDC, 0, 0, SRCCOPY);
-    SelectObject(memDC, oldBitmap);
-    DeleteObject(memBitmap);
-    DeleteDC(memDC);
+    {
+        ProfileScope scope(STAGE_BLIT);
+        presentFrame(hdc, whole, key.halfResolution);
+        GdiFlush();
+    }
+    endProfileFrame();
+}
+
+// Ray-cast the current detail level under a window pixel; a miss clears the pick
+void pickAt(int x, int y) {
+    // Faces are only numbered within a mesh, so a scene has nothing meaningful to report
+    if (!scene.instances.empty()) {
+        lastPick = BvhHit();
+        return;
+    }
+    const ViewState state = makeViewState(angleX, angleY);
+    BvhView view = makeBvhView(state.rotation, state.projection, WIDTH, HEIGHT, cullBackFaces);
+    if (!compactMesh) {
+        lastPick = pickBvh(meshBvh, normalized, faces, view, x + 0.5f, y + 0.5f);
+        return;
+    }
+
+    // Clicks are rare enough that expanding a temporary copy beats quantized variants of the ray tests
+    VertexStream positions;
+    dequantizeVertexStream(quantized, positions);
+    lastPick = pickBvh(meshBvh, positions, faces, view, x + 0.5f, y + 0.5f);
+}
+
+// Show the latest cull counts and pick in the caption, touching it only when they change
+void updateWindowTitle(HWND hwnd) {
+    static CullStats shown = { SIZE_MAX, 0, 0, 0 };
+    static BvhHit shownPick;
+    static uint64_t shownResidentBytes = 0;
+    const ChunkResidencyStats& residency = chunkStream.stats;
+    if (memcmp(&shown, &cullStats, sizeof(CullStats)) == 0 && shownPick.hit == lastPick.hit &&
+        shownPick.face == lastPick.face && shownPick.vertex == lastPick.vertex && shownResidentBytes == residency.residentBytes) {
+        return;
+    }
+    shown = cullStats;
+    shownPick = lastPick;
+    shownResidentBytes = residency.residentBytes;
+
+    char title[288];
+    int length = snprintf(title, sizeof(title), "3D Wireframe Viewer - %zu faces, %zu culled (%zu back, %zu off-screen, %zu degenerate)",
+        cullStats.total, cullStats.backFacing + cullStats.offScreen + cullStats.degenerate,
+        cullStats.backFacing, cullStats.offScreen, cullStats.degenerate);
+    if (lastPick.hit && length > 0 && static_cast<size_t>(length) < sizeof(title)) {
+        length += snprintf(title + length, sizeof(title) - length, " - picked face %u, vertex %u", lastPick.face + 1, lastPick.vertex + 1);
+    }
+    if (streamingMesh && length > 0 && static_cast<size_t>(length) < sizeof(title)) {
+        snprintf(title + length, sizeof(title) - length, " - %zu of %zu chunks resident, %.0f of %.0f MB",
+            residency.residentChunks, chunkStream.chunks.size(), residency.residentBytes / 1048576.0, chunkStream.budgetBytes / 1048576.0);
+    }
+    SetWindowTextA(hwnd, title);
 }
 
 // Handle user input and window messages
@@ -235,9 +638,18 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
         dragging = true;
         lastMouse.x = LOWORD(lParam);
         lastMouse.y = HIWORD(lParam);
+
+        // Report what was clicked in the caption
+        pickAt(lastMouse.x, lastMouse.y);
+        updateWindowTitle(hwnd);
         break;
     case WM_LBUTTONUP:
         dragging = false;
+
+        // Back to full detail for the still frame; the message loop repaints it. A progressive view keeps
+        // its preview until the refine timer fires.
+        if (refinePending) SetTimer(hwnd, REFINE_TIMER, refineDelayMs, nullptr);
+        else setDetailLevel(0);
         break;
     case WM_MOUSEMOVE:
         if (dragging) {
@@ -248,19 +660,94 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             lastMouse.y = y;
             angleY += dx * 0.5f;
             angleX += dy * 0.5f;
-            applyTransform();
-            InvalidateRect(hwnd, nullptr, TRUE);
+
+            // Only record the new view; the message loop paints it once per display refresh
+            viewDirty = true;
+            setDetailLevel(dragDetail);
+
+            // Every move pushes the full frame back until the mouse has been still for refineDelayMs
+            if (progressiveMode) {
+                refinePending = true;
+                SetTimer(hwnd, REFINE_TIMER, refineDelayMs, nullptr);
+            }
+        }
+        break;
+    case WM_TIMER:
+        if (wParam == REFINE_TIMER) {
+            // Paint the full frame right away; it is abandoned if input arrives while it is drawn
+            KillTimer(hwnd, REFINE_TIMER);
+            refinePending = false;
+            setDetailLevel(0);
+            refining = true;
+            InvalidateRect(hwnd, nullptr, FALSE);
+            UpdateWindow(hwnd);
+            refining = false;
+        }
+        break;
+    case WM_KEYDOWN:
+        if (wParam == 'R') {
+            useSoftwareRasterizer = !useSoftwareRasterizer;
+            InvalidateRect(hwnd, nullptr, FALSE);
+        }
+        else if (wParam == 'C') {
+            cullBackFaces = !cullBackFaces;
+            InvalidateRect(hwnd, nullptr, FALSE);
+        }
+        else if (wParam == 'E') {
+            featureEdgesOnly = !featureEdgesOnly;
+            InvalidateRect(hwnd, nullptr, FALSE);
+        }
+        else if (wParam == 'G' && gpuRenderer) {
+            activeRenderer = activeRenderer == gpuRenderer.get() ? cpuRenderer.get() : gpuRenderer.get();
+            RECT rect;
+            GetClientRect(hwnd, &rect);
+            activeRenderer->resize(rect.right, rect.bottom);
+
+            // The GPU path never runs applyTransform, so the CPU streams may be stale
+            viewDirty = true;
+            InvalidateRect(hwnd, nullptr, FALSE);
+        }
+        else if (wParam == 'P') {
+            // A CSV log keeps the timers running after the overlay is hidden
+            showProfiler = !showProfiler;
+            setProfilerEnabled(showProfiler || profiler.logFrames);
+            InvalidateRect(hwnd, nullptr, FALSE);
         }
         break;
+    case WM_ERASEBKGND:
+        // Every paint covers the whole client area, so erasing first would only flicker
+        return 1;
     case WM_PAINT:
     {
+        if (updateStreamedMesh()) viewDirty = true;
+        if (viewDirty) {
+            if (activeRenderer->usesCpuTransform()) applyTransform();
+            viewDirty = false;
+        }
         PAINTSTRUCT ps;
         HDC hdc = BeginPaint(hwnd, &ps);
-        drawShadedModel(hdc);
+        activeRenderer->draw(hdc);
         EndPaint(hwnd, &ps);
+        updateWindowTitle(hwnd);
+
+        // Keep painting while chunks are still on their way in
+        if (streamingMesh && chunkStream.stats.pending > 0) viewDirty = true;
     }
     break;
+    case WM_SIZE:
+        if (activeRenderer) activeRenderer->resize(LOWORD(lParam), HIWORD(lParam));
+        break;
+    case WM_MESH_RELOADED:
+        // The snapshot is complete, so installing it is a handful of swaps; the old mesh is freed with it
+        if (std::shared_ptr<MeshSnapshot> snapshot = takeMeshSnapshot(meshWatcher)) installMeshSnapshot(*snapshot);
+        break;
     case WM_DESTROY:
+        KillTimer(hwnd, REFINE_TIMER);
+        stopMeshWatcher(meshWatcher);
+        if (profiler.logFrames) writeProfileCsv(profiler.csvPath.c_str());
+        activeRenderer = nullptr;
+        gpuRenderer.reset();
+        cpuRenderer.reset();
         PostQuitMessage(0);
         break;
     default:
@@ -269,24 +756,79 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
     return 0;
 }
 
-// Entry point: load model, create window, start message loop
-int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int nCmdShow) {
-    std::ifstream file("object.txt");
-    if (!file.is_open()) {
-        MessageBoxA(nullptr, "Could not open object.txt", "Error", MB_OK);
-        return 1;
+// Pace presentation to the display: DwmFlush blocks until the compositor's next frame.
+// Without composition fall back to sleeping out the rest of a 60 Hz interval.
+void waitForVerticalBlank() {
+    static DWORD lastFrame = 0;
+    if (SUCCEEDED(DwmFlush())) {
+        lastFrame = GetTickCount();
+        return;
+    }
+    const DWORD interval = 16;
+    DWORD elapsed = GetTickCount() - lastFrame;
+    if (elapsed < interval) Sleep(interval - elapsed);
+    lastFrame = GetTickCount();
+}
+
+// Read "-tile N", "-threads N", "-profile file.csv", "-cpu", "-reorder", "-compact", "-watch", "-stream path",
+// "-budget MB", "-scene file.scene", "-progressive", "-halfres" and "-refine MS" from the command line; unknown
+// arguments are ignored
+void parseRendererOptions(const char* cmdLine, TileRendererConfig& config) {
+    std::istringstream args(cmdLine ? cmdLine : "");
+    std::string arg;
+    while (args >> arg) {
+        int value;
+        if (arg == "-tile" && args >> value && value > 0) config.tileSize = value;
+        else if (arg == "-threads" && args >> value && value >= 0) config.threadCount = static_cast<unsigned>(value);
+        else if (arg == "-cpu") preferGpuRenderer = false;
+        else if (arg == "-reorder") reorderMeshLayout = true;
+        else if (arg == "-compact") compactMesh = true;
+        else if (arg == "-watch") watchMesh = true;
+        else if (arg == "-stream") args >> streamPath;
+        else if (arg == "-scene") args >> scenePath;
+        else if (arg == "-progressive") progressiveMode = true;
+        else if (arg == "-halfres") halfResolutionPreview = true;
+        else if (arg == "-refine" && args >> value && value >= 0) refineDelayMs = static_cast<UINT>(value);
+        else if (arg == "-budget" && args >> value && value > 0) streamBudgetMB = static_cast<uint64_t>(value);
+        else if (arg == "-profile" && args >> profiler.csvPath) {
+            profiler.logFrames = true;
+            setProfilerEnabled(true);
+        }
     }
+}
 
-    // Parse header: # vertices, # faces
-    std::string header;
-    std::getline(file, header);
-    std::replace(header.begin(), header.end(), ',', ' ');
-    std::istringstream hs(header);
-    int vertexCount, faceCount;
-    hs >> vertexCount >> faceCount;
+// Entry point: load model, create window, start message loop
+int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR lpCmdLine, int nCmdShow) {
+    parseRendererOptions(lpCmdLine, rendererConfig);
+    configureTileRenderer(tileRenderer, rendererConfig);
+
+    // Load from the binary cache next to object.txt, reparsing the text only when it has changed;
+    // a chunk file is streamed instead, starting empty and filling in from the first paint
+    if (!streamPath.empty()) {
+        if (!openStreamedMesh(streamPath.c_str())) {
+            MessageBoxA(nullptr, ("Could not open " + streamPath).c_str(), "Error", MB_OK);
+            return 1;
+        }
+        viewDirty = true;
+    }
+    else if (!scenePath.empty()) {
+        if (!openScene(scenePath.c_str())) {
+            MessageBoxA(nullptr, ("Could not load scene " + scenePath).c_str(), "Error", MB_OK);
+            return 1;
+        }
+    }
+    else {
+        std::vector<LodLevel> lods;
+        std::vector<MeshBvh> bvhs;
+        if (!loadMeshCached("object.txt", vertices, faces, lods, bvhs, reorderMeshLayout, compactMesh)) {
+            MessageBoxA(nullptr, "Could not load object.txt", "Error", MB_OK);
+            return 1;
+        }
 
-    vertices = loadVertices(file, vertexCount);
-    faces = loadFaces(file, faceCount);
+        normalizeVertices();
+        computeFaceNormals();
+        prepareDetailLevels(lods, bvhs);
+    }
     applyTransform();
 
     // Register window class
@@ -304,14 +846,41 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int nCmdShow) {
         nullptr, nullptr, hInstance, nullptr);
     if (!hwnd) return 0;
 
+    // GDI is always there to fall back on when Direct3D is unavailable or disabled
+    cpuRenderer = createGdiRenderer();
+    if (preferGpuRenderer && scene.instances.empty()) gpuRenderer = createD3D11Renderer(hwnd);
+    activeRenderer = gpuRenderer ? gpuRenderer.get() : cpuRenderer.get();
+
+    // A chunk file is never reloaded; the viewer keeps running on the mesh it has if the watch cannot start
+    if (watchMesh && streamPath.empty() && scenePath.empty()) startMeshWatcher(meshWatcher, "object.txt", reorderMeshLayout, compactMesh, hwnd);
+
     ShowWindow(hwnd, nCmdShow);
     UpdateWindow(hwnd);
 
-    // Main message loop
+    // Main message loop: block while idle; otherwise drain all queued input, then present one frame
     MSG msg = {};
-    while (GetMessage(&msg, nullptr, 0, 0)) {
-        TranslateMessage(&msg);
-        DispatchMessage(&msg);
+    for (;;) {
+        if (!viewDirty) {
+            if (!GetMessage(&msg, nullptr, 0, 0)) break;
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+        bool quit = false;
+        while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
+            if (msg.message == WM_QUIT) {
+                quit = true;
+                break;
+            }
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+        if (quit) break;
+
+        if (viewDirty) {
+            InvalidateRect(hwnd, nullptr, FALSE);
+            UpdateWindow(hwnd);
+            waitForVerticalBlank();
+        }
     }
 
     return 0;
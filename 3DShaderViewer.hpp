@@ -16,21 +16,44 @@
 #include <windows.h>
 #include <vector>
 #include <string>
-#include <fstream>
-
-// Structure representing a vertex in 3D space
-struct Vertex {
-    int id;     // Vertex identifier
-    float x;    // X coordinate
-    float y;    // Y coordinate
-    float z;    // Z coordinate
+#include "DepthSort.hpp"
+#include "FrameArena.hpp"
+#include "MeshBvh.hpp"
+#include "MeshChunks.hpp"
+#include "MeshEdges.hpp"
+#include "MeshLod.hpp"
+#include "MeshReload.hpp"
+#include "Rasterizer.hpp"
+#include "RenderCore.hpp"
+#include "RenderTarget.hpp"
+#include "Renderer.hpp"
+#include "Scene.hpp"
+#include "TileRenderer.hpp"
+#include "VertexTransform.hpp"
+
+// A reloaded mesh, built off the UI thread and ready to be swapped into the render globals
+struct MeshSnapshot {
+    uint64_t generation = 0;            // Reloads so far by the watcher that built it
+    std::vector<Vertex> vertices;       // Parsed positions in render order; empty in compact mode
+    ModelFrame frame = {};
+    std::vector<DetailLevel> levels;    // Full detail first, every slot filled
+    int dragDetail = 0;
+    bool positionsOnly = false;         // Topology matched the previous reload, so its edges and hierarchy were refitted
+    double buildMs = 0;                 // Parse and build time on the watcher thread
 };
 
-// Structure representing a triangular face using 1-based vertex indices
-struct Face {
-    int v1;     // Index of first vertex
-    int v2;     // Index of second vertex
-    int v3;     // Index of third vertex
+// Everything the pixels of a rendered frame depend on; a paint whose key matches the last rendered
+// frame only copies the damaged part of the back buffer to the window
+struct FrameKey {
+    float angleX, angleY;
+    uint64_t meshVersion;           // meshVersion when the frame was drawn
+    uint32_t targetGeneration;      // RenderTarget::generation, which covers the frame size
+    bool softwareRasterizer;
+    bool cullBackFaces;
+    bool featureEdgesOnly;
+    bool showProfiler;
+    bool preview;                   // Drawn without outlines or dots while a refine is pending
+    bool halfResolution;            // Preview drawn into previewTarget and stretched to the window
 };
 
 // Window dimensions
@@ -39,36 +62,160 @@ extern const int HEIGHT;
 
 // Global state used throughout the program
 extern std::vector<Vertex> vertices;      // List of original vertices loaded from file
-extern std::vector<Vertex> transformed;   // Transformed (normalized + rotated) vertices
-extern std::vector<Face> faces;           // List of triangular faces
+extern DetailLevel activeLevel;           // Geometry being drawn; a level swapped in leaves its slot in detailLevels empty
+extern RenderContext renderContext;       // Projection results and scratch for the window's frames
+
+// Render globals: the parts of activeLevel and renderContext the viewer works on directly
+extern VertexStream& normalized;          // Centered, unit-extent vertices (computed once per load)
+extern QuantizedStream& quantized;        // The same positions in 16 bits, held instead of normalized when compactMesh is set
+extern ScreenStream& screen;              // Pixel position and view depth of every vertex, projected once per frame
+extern ViewState frameView;               // View the screen stream was last projected with
+extern VertexStream& faceNormals;         // Object-space unit normal per face, parallel to faces
+extern std::vector<uint8_t>& degenerateFaces; // 1 for zero-area faces, which are never drawn
+extern AlignedFloats& normalDepth;        // View-space z of each face normal for the current rotation
+extern std::vector<Face>& faces;          // List of triangular faces
+extern EdgeList& meshEdges;               // Each shared edge once, with its faces and feature flags
+extern MeshBvh& meshBvh;                  // Face hierarchy in normalized coordinates, for culling and picking
+extern ModelFrame modelFrame;             // Normalization of the full-detail mesh
+extern std::vector<DetailLevel> detailLevels; // Level 0 is full detail, then the LOD chain from coarse to coarser
+extern int activeDetail;                  // Level currently held by the globals above
+extern int dragDetail;                    // Level drawn while the mouse is dragging
+extern uint64_t meshVersion;              // Bumped whenever the render globals are given different geometry
+extern RenderTarget renderTarget;         // Window-lifetime back buffer and brush cache
+extern TileRenderer& tileRenderer;        // Parallel tile rasterizer used by the software path
+extern TileRendererConfig rendererConfig; // Tile size and thread count from the command line
+extern DepthSorter painterSorter;         // Persistent back-to-front face order for the GDI path
+extern FrameArena& frameArena;            // Frame-scoped scratch buffers, reset at the start of every renderFrame
+extern ChunkStream chunkStream;           // Out-of-core chunk file and its resident chunks, when streaming
+extern bool streamingMesh;                // True if the render globals are assembled from chunkStream
+extern std::string streamPath;            // "-stream path": stream this chunk file, or a text mesh's, instead of loading object.txt
+extern uint64_t streamBudgetMB;           // "-budget MB": residency budget for streamed chunks
+extern Scene scene;                       // Instanced scene; empty unless one was loaded, when the render globals are too
+extern std::string scenePath;             // "-scene file.scene": draw this scene instead of loading object.txt
 
 extern bool dragging;         // True if mouse is dragging 
 extern POINT lastMouse;       // Last mouse position recorded
 extern float angleX, angleY;  // Rotation angles in degrees for X and Y axes
+extern bool viewDirty;        // True if the angles changed since the last applyTransform
+
+extern bool progressiveMode;              // True to draw previews while the view moves and refine once input is idle
+extern bool halfResolutionPreview;        // True to draw those previews at half resolution
+extern UINT refineDelayMs;                // Idle time after the last input before the full frame is drawn
+extern bool refinePending;                // True while the frame on screen is a preview awaiting refinement
+extern bool refining;                     // True while the full frame is drawn; waiting input then abandons it
+extern float frameScale;                  // Size of the target frameView projects into, relative to the window
+extern RenderTarget previewTarget;        // Half-size back buffer for "-halfres" previews
 
-// Projects a 3D vertex to 2D screen coordinates
-POINT project(const Vertex& v);
+extern bool useSoftwareRasterizer;        // True to fill faces with the z-buffered rasterizer, false for GDI
+extern bool preferGpuRenderer;            // True to start on the Direct3D 11 renderer when it is available
+extern bool reorderMeshLayout;            // True to optimize face and vertex order for cache reuse at load
+extern bool compactMesh;                  // True to keep quantized positions in memory and 16-bit indices in the binary cache
+extern bool watchMesh;                    // True to reload object.txt whenever it changes on disk
+extern MeshWatcher meshWatcher;           // Background reloader; idle unless watchMesh
+extern std::unique_ptr<Renderer> cpuRenderer;   // Software rasterizer / GDI painter's path, presented with BitBlt
+extern std::unique_ptr<Renderer> gpuRenderer;   // Direct3D 11 backend, null if no device could be created
+extern Renderer* activeRenderer;          // The one WM_PAINT draws with
+extern bool cullBackFaces;                // True to discard back-facing faces (closed meshes only)
+extern bool featureEdgesOnly;             // True to outline only silhouette, crease and boundary edges
+extern bool showProfiler;                 // True to draw the per-stage timing overlay
+extern CullStats cullStats;               // Counts from the most recent cull pass
+extern BvhHit lastPick;                   // Result of the last click's ray pick
+extern DotStats dotStats;                 // Counts from the most recent dot pass
 
-// Rotates a vertex around the X-axis by a specified angle
-Vertex rotateX(const Vertex& v, float angle);
+// Centers the model and scales it into the unit sphere, filling the normalized buffer and modelFrame
+void normalizeVertices();
 
-// Rotates a vertex around the Y-axis by a specified angle
-Vertex rotateY(const Vertex& v, float angle);
+// Applies modelFrame to any set of positions (the loaded vertices or an LOD level)
+void normalizePositions(const std::vector<Vertex>& source, VertexStream& out);
 
-// Applies centering, normalization, and rotation transformations to all vertices
+// Pixel mapping shared by the transform, the BVH cull and picking: fitProjection for the window size
+Projection screenProjection();
+
+// Builds the view state for a pair of angles through screenProjection
+ViewState makeViewState(float angleX, float angleY);
+
+// Sets frameView from the current angles and projects the mesh in the render globals through it
 void applyTransform();
 
-// Loads vertex data from file and returns a list of Vertex structs
-std::vector<Vertex> loadVertices(std::ifstream& file, int vertexCount);
+// Projects activeLevel through frameView into renderContext (projectLevel, timed as a stage)
+void projectMesh();
+
+// Computes unit object-space face normals and flags degenerate faces for the render globals; runs once per load
+void computeFaceNormals();
+
+// Turns an LOD chain and its hierarchies (full detail first, from buildLevelBvhs) into render-ready
+// detail levels, consuming both, builds every level's edges and picks the drag level. With compactMesh the
+// levels keep only quantized positions and vertices is released.
+// Call after normalizeVertices and computeFaceNormals for the full-detail mesh.
+void prepareDetailLevels(std::vector<LodLevel>& chain, std::vector<MeshBvh>& bvhs);
+
+// Swaps a reloaded mesh into the render globals at full detail; must run on the UI thread
+void installMeshSnapshot(MeshSnapshot& snapshot);
+
+// Swaps a detail level into the render globals; returns true if the level changed
+bool setDetailLevel(int level);
+
+// Loads a scene file and every mesh it names into scene, replacing whatever the render globals held
+bool openScene(const char* path);
+
+// Opens a chunk file for streaming and sets the model frame from it; nothing is paged in until the first update
+bool openStreamedMesh(const char* path);
+
+// Assembles every resident chunk into the render globals as the only detail level
+void assembleStreamedMesh();
 
-// Loads face data (triangles) from file and returns a list of Face structs
-std::vector<Face> loadFaces(std::ifstream& file, int faceCount);
+// Pages chunks for the current view and reassembles the globals if the resident set changed; returns true
+// if it did. Does nothing unless streaming.
+bool updateStreamedMesh();
 
-// Renders the shaded 3D model (with smooth shading and edge overlay) to the provided HDC
+// Returns the projected screen position of a vertex by its 0-based index as a GDI point
+POINT screenPoint(const ScreenStream& screen, size_t i);
+
+// Marks a face's vertices for the painter's path dot pass if it faces the viewer; one byte per vertex
+void markVisibleVertices(const Face& f, float nz, uint8_t* vertexVisible);
+
+// Fallback path, as the window's RenderHooks::paintFaces: sorts a level's visible faces back to front and fills them
+// one by one with cached GDI brushes, outlining them if settings ask and marking front-face vertices unless
+// vertexVisible is null
+void drawFacesGDI(RenderTarget& target, const DetailLevel& level, RenderContext& context, const FrameArray<VisibleFace>& visible,
+    const RenderSettings& settings, uint8_t* vertexVisible);
+
+// Ray-picks the face and vertex under window pixel (x, y) into lastPick
+void pickAt(int x, int y);
+
+// Shows the latest cull counts and pick in the window caption
+void updateWindowTitle(HWND hwnd);
+
+// True if the frame being drawn should be abandoned for input that is waiting
+bool renderInterrupted();
+
+// Renders the current view into a back buffer, which must already be sized, through the core's drawLevel or
+// drawScene; a preview has no outlines or dots. Counts go to cullStats and dotStats. Returns false, leaving the
+// buffer partly drawn, if input interrupted a refine pass.
+bool renderFrame(RenderTarget& target = renderTarget, bool preview = false);
+
+// Copies a rectangle of the rendered frame to the window, or the whole stretched preview if halfResolution
+void presentFrame(HDC hdc, const RECT& rect, bool halfResolution);
+
+// Key of the frame the current view, mesh and toggles would render
+FrameKey currentFrameKey();
+
+// True if two keys describe the same pixels
+bool sameFrame(const FrameKey& a, const FrameKey& b);
+
+// Renders the shaded 3D model (with smooth shading and edge overlay) to the provided HDC. When nothing
+// has changed since the last render, only the paint's clip box is copied from the back buffer.
 void drawShadedModel(HDC hdc);
 
+// Blocks until the next display refresh (DwmFlush), or about 16 ms without desktop composition
+void waitForVerticalBlank();
+
 // Handles Win32 events: input, painting, and cleanup
 LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
+// Reads "-tile N", "-threads N", "-profile", "-cpu", "-reorder", "-compact", "-watch", "-stream", "-budget" and "-scene"
+// settings from the command line
+void parseRendererOptions(const char* cmdLine, TileRendererConfig& config);
+
 // Application entry point (main function for Win32 GUI apps)
-int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int nCmdShow);
+int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR lpCmdLine, int nCmdShow);
@@ -0,0 +1,27 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Batch Entry Point
+//
+//       Console entry point of the batchrender target, which links
+//       the portable rendercore library only and so builds on
+//       machines without Win32 too.
+//
+//       "batchrender -selftest" checks the core renders correctly;
+//       ctest runs it.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "BatchRender.hpp"
+#include <string>
+
+// The arguments are joined into one command line, the form WinMain hands the option parsers
+int main(int argc, char** argv) {
+    std::string cmdLine = "-batch";
+    for (int i = 1; i < argc; ++i) {
+        cmdLine += ' ';
+        cmdLine += argv[i];
+    }
+    BatchRenderOptions options;
+    parseBatchRenderOptions(cmdLine.c_str(), options);
+    return runBatchRender(options);
+}
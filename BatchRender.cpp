@@ -0,0 +1,257 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Batch Thumbnails
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "BatchRender.hpp"
+#include "BitmapFile.hpp"
+#include "MeshTypes.hpp"
+#include "RenderCore.hpp"
+#include "SyntheticMesh.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#undef min
+#undef max
+
+namespace {
+
+// Self-test mesh and frame: enough faces that the face-on center is flat-shaded, small enough to run in a blink
+const size_t SELF_TEST_TRIANGLES = 4000;
+const int SELF_TEST_SIZE = 128;
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Pixels that differ from the clear color; zero means the mesh drew nothing
+size_t coveredPixels(const std::vector<uint32_t>& pixels, uint32_t background) {
+    return static_cast<size_t>(std::count_if(pixels.begin(), pixels.end(), [background](uint32_t p) { return p != background; }));
+}
+
+// A file name placed in a directory; an empty directory is the current one
+std::string outputPath(const std::string& dir, const std::string& name) {
+    if (dir.empty() || dir.back() == '/' || dir.back() == '\\') return dir + name;
+    return dir + "/" + name;
+}
+
+// Lowercased copy for comparing file names, since Windows and macOS file systems ignore case
+std::string foldCase(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return s;
+}
+
+// A mesh path split into its directory (with the trailing slash), that directory's own name, and the file name
+// without its extension
+struct MeshPathParts {
+    std::string dir;
+    std::string parent;
+    std::string stem;
+};
+
+MeshPathParts splitMeshPath(const std::string& meshPath) {
+    MeshPathParts parts;
+    const size_t slash = meshPath.find_last_of("/\\");
+    const size_t nameStart = slash == std::string::npos ? 0 : slash + 1;
+    const size_t dot = meshPath.find_last_of('.');
+    const size_t nameEnd = dot == std::string::npos || dot < nameStart ? meshPath.size() : dot;
+    parts.dir = meshPath.substr(0, nameStart);
+    parts.stem = meshPath.substr(nameStart, nameEnd - nameStart);
+    if (slash != std::string::npos) {
+        const size_t parentSlash = slash == 0 ? std::string::npos : meshPath.find_last_of("/\\", slash - 1);
+        parts.parent = meshPath.substr(parentSlash == std::string::npos ? 0 : parentSlash + 1,
+            parentSlash == std::string::npos ? slash : slash - parentSlash - 1);
+    }
+    return parts;
+}
+
+// Each mesh's file name with its extension swapped for .bmp, in outputDir or else beside the mesh. In outputDir,
+// meshes sharing a file name (a library of object.txt files, say) are told apart by their directory's name:
+// chair/object.txt -> chair_object.bmp. Returns false if two meshes would still write the same file, with paths
+// filled up to and including the second of them.
+bool thumbnailPaths(const std::vector<std::string>& meshPaths, const std::string& outputDir, std::vector<std::string>& paths) {
+    std::vector<MeshPathParts> parts;
+    std::map<std::string, int> stemCounts;
+    for (const auto& meshPath : meshPaths) {
+        parts.push_back(splitMeshPath(meshPath));
+        ++stemCounts[foldCase(parts.back().stem)];
+    }
+
+    paths.clear();
+    std::set<std::string> taken;
+    for (const auto& mesh : parts) {
+        std::string name = mesh.stem;
+        if (!outputDir.empty() && !mesh.parent.empty() && stemCounts[foldCase(mesh.stem)] > 1) name = mesh.parent + "_" + name;
+        paths.push_back(outputPath(outputDir.empty() ? mesh.dir : outputDir, name + ".bmp"));
+        if (!taken.insert(foldCase(paths.back())).second) return false;
+    }
+    return true;
+}
+
+// One worker: its own context, mesh and pixels, reused for every mesh it takes off the shared counter
+void renderMeshes(const BatchRenderOptions& options, const std::vector<std::string>& outputPaths, std::atomic<size_t>& next,
+    std::atomic<int>& failures) {
+    RenderContext context;
+    RenderMesh mesh;
+    RenderSettings settings;
+    std::vector<uint32_t> pixels(static_cast<size_t>(options.width) * options.height);
+
+    for (size_t i = next++; i < options.meshPaths.size(); i = next++) {
+        const std::string& path = options.meshPaths[i];
+        const auto start = std::chrono::steady_clock::now();
+        if (!loadRenderMesh(path.c_str(), mesh)) {
+            fprintf(stderr, "Could not load %s\n", path.c_str());
+            ++failures;
+            continue;
+        }
+
+        const CullStats stats = renderToMemory(mesh, options.angleX, options.angleY, settings, context, pixels.data(),
+            options.width, options.height);
+        if (mesh.level.faceCount > 0 && coveredPixels(pixels, settings.background) == 0) {
+            fprintf(stderr, "%s rendered a blank image\n", path.c_str());
+            ++failures;
+            continue;
+        }
+
+        const std::string& out = outputPaths[i];
+        if (!writeBitmapFile(out.c_str(), pixels.data(), options.width, options.height)) {
+            fprintf(stderr, "Could not write %s\n", out.c_str());
+            ++failures;
+            continue;
+        }
+        printf("%s -> %s: %zu faces, %zu culled, %.1f ms\n", path.c_str(), out.c_str(), stats.total,
+            stats.backFacing + stats.offScreen + stats.degenerate, elapsedMs(start));
+    }
+}
+
+// Prints one check and passes its result through
+bool check(bool passed, const char* what) {
+    printf("  %-48s %s\n", what, passed ? "ok" : "FAILED");
+    return passed;
+}
+
+// A closed sphere seen head-on, written out and loaded back through the text loader: the corner keeps the clear
+// color, the center is the brightest blue (faces there point at the viewer), about half the faces are culled as
+// back-facing, and with outlines on some pixels turn black
+int runSelfTest(const BatchRenderOptions& options) {
+    std::vector<Vertex> vertices;
+    std::vector<Face> faces;
+    generateSyntheticMesh(SyntheticShape::Sphere, SELF_TEST_TRIANGLES, vertices, faces);
+    const std::string meshPath = outputPath(options.outputDir, "batch_selftest.txt");
+    if (!writeMeshFile(meshPath.c_str(), vertices, faces)) {
+        fprintf(stderr, "Could not write %s\n", meshPath.c_str());
+        return 1;
+    }
+    RenderMesh mesh;
+    const bool loaded = loadRenderMesh(meshPath.c_str(), mesh);
+    std::remove(meshPath.c_str());
+
+    printf("Self-test: %zu-face sphere, %dx%d\n", faces.size(), SELF_TEST_SIZE, SELF_TEST_SIZE);
+    if (!check(loaded, "mesh loads through loadRenderMesh")) return 2;
+
+    RenderContext context;
+    RenderSettings settings;
+    settings.outlines = false;
+    settings.dots = false;
+    std::vector<uint32_t> pixels(SELF_TEST_SIZE * SELF_TEST_SIZE);
+    const CullStats stats = renderToMemory(mesh, 0, 0, settings, context, pixels.data(), SELF_TEST_SIZE, SELF_TEST_SIZE);
+    const uint32_t center = pixels[(SELF_TEST_SIZE / 2) * SELF_TEST_SIZE + SELF_TEST_SIZE / 2];
+
+    bool passed = check(pixels[0] == settings.background, "corner keeps the background");
+    passed &= check((center & 0xFFFF00) == 0 && (center & 0xFF) >= 0xF0, "center is shaded face-on blue");
+    passed &= check(stats.total == faces.size() && stats.offScreen == 0, "every face is on screen");
+    passed &= check(stats.backFacing > stats.total / 3 && stats.backFacing < stats.total * 2 / 3, "about half the faces are back-facing");
+
+    settings.outlines = true;
+    settings.dots = true;
+    renderToMemory(mesh, 0, 0, settings, context, pixels.data(), SELF_TEST_SIZE, SELF_TEST_SIZE);
+    passed &= check(std::find(pixels.begin(), pixels.end(), packPixel(0, 0, 0)) != pixels.end(), "outlines draw black edges");
+
+    std::vector<std::string> names;
+    passed &= check(thumbnailPaths({ "a/chair/object.txt", "b/table/object.txt", "lamp.txt" }, "out", names)
+        && names[0] == "out/chair_object.bmp" && names[1] == "out/table_object.bmp" && names[2] == "out/lamp.bmp",
+        "shared mesh names get their directory's name");
+    passed &= check(thumbnailPaths({ "a/chair/object.txt", "b/chair/Object.txt" }, "", names)
+        && names[0] == "a/chair/object.bmp", "thumbnails without -out sit beside the meshes");
+    passed &= check(!thumbnailPaths({ "a/chair/object.txt", "b/chair/Object.txt" }, "out", names),
+        "thumbnails that would collide are refused");
+
+    if (!passed) return 2;
+    printf("Self-test passed\n");
+    return 0;
+}
+
+} // namespace
+
+// Unknown arguments are left for the other option parsers, which read the same command line
+bool parseBatchRenderOptions(const char* cmdLine, BatchRenderOptions& options) {
+    std::istringstream args(cmdLine ? cmdLine : "");
+    std::string arg;
+    while (args >> arg) {
+        std::string value;
+        int jobs;
+        if (arg == "-batch") options.run = true;
+        else if (arg == "-selftest") options.selfTest = true;
+        else if (arg == "-mesh" && args >> value) options.meshPaths.push_back(value);
+        else if (arg == "-list" && args >> value) {
+            std::ifstream list(value);
+            std::string line;
+            while (std::getline(list, line)) {
+                line.erase(line.find_last_not_of(" \t\r") + 1);
+                if (!line.empty()) options.meshPaths.push_back(line);
+            }
+        }
+        else if (arg == "-out") args >> options.outputDir;
+        else if (arg == "-size") args >> options.width >> options.height;
+        else if (arg == "-angles") args >> options.angleX >> options.angleY;
+        else if (arg == "-jobs" && args >> jobs && jobs >= 0) options.jobs = static_cast<unsigned>(jobs);
+    }
+    options.width = std::max(options.width, 1);
+    options.height = std::max(options.height, 1);
+    return options.run;
+}
+
+// Workers pull meshes off a shared counter, so one huge mesh does not hold up the rest of the list
+int runBatchRender(const BatchRenderOptions& options) {
+    if (options.selfTest) return runSelfTest(options);
+    if (options.meshPaths.empty()) {
+        fprintf(stderr, "No meshes to render: pass -mesh path or -list file\n");
+        return 1;
+    }
+
+    // Workers write their thumbnails unsynchronized, so two meshes mapping to one file must be caught up front
+    std::vector<std::string> outputPaths;
+    if (!thumbnailPaths(options.meshPaths, options.outputDir, outputPaths)) {
+        fprintf(stderr, "%s would overwrite the thumbnail of an earlier mesh, %s\n", options.meshPaths[outputPaths.size() - 1].c_str(),
+            outputPaths.back().c_str());
+        return 1;
+    }
+
+    unsigned jobs = options.jobs ? options.jobs : std::thread::hardware_concurrency();
+    jobs = static_cast<unsigned>(std::min<size_t>(std::max(jobs, 1u), options.meshPaths.size()));
+    printf("Rendering %zu meshes at %dx%d on %u threads\n", options.meshPaths.size(), options.width, options.height, jobs);
+
+    const auto start = std::chrono::steady_clock::now();
+    std::atomic<size_t> next(0);
+    std::atomic<int> failures(0);
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < jobs; ++i) {
+        workers.emplace_back(renderMeshes, std::cref(options), std::cref(outputPaths), std::ref(next), std::ref(failures));
+    }
+    renderMeshes(options, outputPaths, next, failures);
+    for (auto& worker : workers) worker.join();
+
+    const double ms = elapsedMs(start);
+    printf("%zu meshes in %.1f ms (%.1f per second), %d failed\n", options.meshPaths.size(), ms,
+        options.meshPaths.size() * 1000.0 / std::max(ms, 1e-3), failures.load());
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,38 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Batch thumbnail renderer: loads object.txt files through the
+//      portable render core and renders each one into memory with
+//      renderToMemory, several meshes at once with one
+//      RenderContext per worker thread, saving every image as a
+//      BMP. Nothing here touches the window or the viewer's
+//      globals, so the batchrender target builds it from the
+//      portable sources alone, on machines without Win32 too.
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <string>
+#include <vector>
+
+// Settings for a batch run, read from the command line
+struct BatchRenderOptions {
+    bool run = false;                   // "-batch": render thumbnails; BatchMain.cpp always passes it
+    std::vector<std::string> meshPaths; // "-mesh path", repeatable, plus every line of "-list file"
+    std::string outputDir;              // "-out dir": where the BMPs go, prefixed with the parent directory's name
+                                        // when file names repeat; next to each mesh if empty
+    int width = 256;                    // "-size W H": thumbnail size in pixels
+    int height = 256;
+    float angleX = 20.0f;               // "-angles X Y": view rotation in degrees, as a drag would set it
+    float angleY = 30.0f;
+    unsigned jobs = 0;                  // "-jobs N": meshes rendered at once; 0 uses every hardware thread
+    bool selfTest = false;              // "-selftest": render a generated sphere and check its pixels instead
+};
+
+// Reads the batch options; returns true if the command line asks for a batch run. A "-list" file that
+// cannot be read leaves run set and no meshes, which runBatchRender reports.
+bool parseBatchRenderOptions(const char* cmdLine, BatchRenderOptions& options);
+
+// Renders every mesh, or runs the self-test, and returns the process exit code: 0 on success,
+// 1 if any mesh fails to load, renders a blank image or cannot be saved (or two would save to the same file,
+// which is checked before anything renders), 2 if the self-test fails
+int runBatchRender(const BatchRenderOptions& options);
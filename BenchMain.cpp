@@ -0,0 +1,30 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Benchmark Entry Point
+//
+//       Console entry point of the headless-bench target: the viewer's
+//       renderers and mesh paths without its window, so timings,
+//       golden-image checks, -generate and -chunks run from a shell
+//       or a build script.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "3DShaderViewer.hpp"
+#include "Benchmark.hpp"
+#include <string>
+
+// The arguments are joined into one command line, the form the renderer and benchmark option parsers read.
+// With neither "-generate" nor "-chunks" the run is a benchmark, so "-bench" itself is optional here.
+int main(int argc, char** argv) {
+    std::string cmdLine;
+    for (int i = 1; i < argc; ++i) {
+        if (i > 1) cmdLine += ' ';
+        cmdLine += argv[i];
+    }
+    parseRendererOptions(cmdLine.c_str(), rendererConfig);
+    configureTileRenderer(tileRenderer, rendererConfig);
+
+    BenchmarkOptions options;
+    if (!parseBenchmarkOptions(cmdLine.c_str(), options)) options.benchmark = true;
+    return runBenchmark(options);
+}
@@ -0,0 +1,338 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Headless Benchmark
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Benchmark.hpp"
+#include "3DShaderViewer.hpp"
+#include "BitmapFile.hpp"
+#include "MeshCache.hpp"
+#include "MeshOptimize.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+#undef min
+#undef max
+
+namespace {
+
+// Frames allowed to allocate: the first spills into arena overflow, the second regrows the arena block
+const int BENCHMARK_WARMUP_FRAMES = 2;
+
+// Milliseconds between two performance counter readings
+double elapsedMs(LONGLONG start, LONGLONG end) {
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    return (end - start) * 1000.0 / frequency.QuadPart;
+}
+
+// "sphere:100000" style synthetic mesh specifications
+bool parseSyntheticSpec(const std::string& spec, BenchmarkOptions& options) {
+    size_t colon = spec.find(':');
+    if (colon == std::string::npos) return false;
+    if (!parseSyntheticShape(spec.substr(0, colon).c_str(), options.shape)) return false;
+    options.triangles = strtoull(spec.c_str() + colon + 1, nullptr, 10);
+    options.synthetic = true;
+    return true;
+}
+
+// Value at a fraction of the way through a sorted sample
+double percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) return 0;
+    size_t rank = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[rank];
+}
+
+// Pixel-exact comparison; the renderer is deterministic for a given path and mesh
+bool compareWithGolden(const char* path, const FrameBuffer& frame) {
+    std::vector<uint32_t> golden;
+    int width, height;
+    if (!readBitmapFile(path, golden, width, height)) {
+        fprintf(stderr, "Could not read golden image %s\n", path);
+        return false;
+    }
+    if (width != frame.width || height != frame.height) {
+        printf("golden      %s: size %dx%d, frame %dx%d\n", path, width, height, frame.width, frame.height);
+        return false;
+    }
+
+    size_t different = 0;
+    for (size_t i = 0; i < golden.size(); ++i) {
+        if ((frame.pixels[i] & 0xFFFFFF) != golden[i]) ++different;
+    }
+    printf("golden      %s: %zu of %zu pixels differ\n", path, different, golden.size());
+    return different == 0;
+}
+
+// Split a text mesh into the chunk file, streaming it rather than loading it
+bool writeChunks(const char* sourcePath, const char* chunkPath) {
+    LONGLONG start = profileNow();
+    ChunkBuildStats stats;
+    if (!buildChunkFile(sourcePath, chunkPath, &stats)) {
+        fprintf(stderr, "Could not build %s from %s\n", chunkPath, sourcePath);
+        return false;
+    }
+    printf("chunks      %s: %zu chunks, %zu levels, %.1f MB in %.2f ms\n", chunkPath, stats.chunkCount, stats.levelCount,
+        stats.fileBytes / 1048576.0, elapsedMs(start, profileNow()));
+    return true;
+}
+
+// What a scene holds against what it draws: geometry is stored once per unique mesh, instances are one placement each
+void printSceneSummary() {
+    size_t vertexCount = 0, faceCount = 0, instancedFaces = 0, geometryBytes = 0;
+    for (const SceneMesh& mesh : scene.meshes) {
+        const DetailLevel& level = mesh.level;
+        vertexCount += level.vertexCount;
+        faceCount += level.faceCount;
+        geometryBytes += 3 * (compactMesh ? level.quantized.x.size() * sizeof(uint16_t) : level.normalized.x.size() * sizeof(float)) +
+            level.faces.size() * sizeof(Face) + 3 * level.faceNormals.x.size() * sizeof(float) +
+            level.edges.edges.size() * sizeof(MeshEdge) + level.bvh.nodes.size() * (sizeof(BvhNode) + sizeof(BvhCone));
+    }
+    for (const SceneInstance& instance : scene.instances) instancedFaces += scene.meshes[instance.mesh].level.faceCount;
+    printf("scene       %s: %zu meshes, %zu instances, %zu faces drawn per frame%s\n", scenePath.c_str(), scene.meshes.size(),
+        scene.instances.size(), instancedFaces, compactMesh ? ", 16-bit positions" : "");
+    printf("memory      unique meshes %zu vertices, %zu faces, %.1f MB; placements %.1f KB\n", vertexCount, faceCount,
+        geometryBytes / 1048576.0, 2 * scene.instances.size() * sizeof(SceneInstance) / 1024.0);
+}
+
+// Reload the text mesh twice, as the file watcher would on two saves of the same file: the first has no basis
+// and rebuilds everything, the second sees the same faces and takes the positions-only path. The last frame is
+// then drawn again from the second snapshot, so -compare checks that a reload reproduces the mesh exactly.
+bool reloadAndRedraw(const BenchmarkOptions& options, RenderTarget& target) {
+    if (options.synthetic || streamingMesh || !scene.instances.empty()) {
+        fprintf(stderr, "-reload needs a text mesh: pass -mesh file.txt, or -generate one first, and no -scene\n");
+        return false;
+    }
+    MeshBasis basis;
+    for (int pass = 0; pass < 2; ++pass) {
+        MeshSnapshot snapshot;
+        if (!buildMeshSnapshot(options.meshPath.c_str(), options.reorder, compactMesh, basis, snapshot)) {
+            fprintf(stderr, "Could not reload %s\n", options.meshPath.c_str());
+            return false;
+        }
+        installMeshSnapshot(snapshot);
+        printf("reload      %s in %.2f ms\n", snapshot.positionsOnly ? "positions only" : "full rebuild", snapshot.buildMs);
+    }
+    setDetailLevel(options.detail);
+    applyTransform();
+    renderFrame(target, options.preview);
+    GdiFlush();
+    return true;
+}
+
+} // namespace
+
+// Unknown arguments are left for parseRendererOptions, so both can read the same command line
+bool parseBenchmarkOptions(const char* cmdLine, BenchmarkOptions& options) {
+    std::istringstream args(cmdLine ? cmdLine : "");
+    std::string arg;
+    while (args >> arg) {
+        std::string value;
+        if (arg == "-bench") options.benchmark = true;
+        else if (arg == "-gdi") options.gdi = true;
+        else if (arg == "-reload") options.reload = true;
+        else if (arg == "-preview") options.preview = true;
+        else if (arg == "-shuffle") options.shuffle = true;
+        else if (arg == "-reorder") options.reorder = true;
+        else if (arg == "-mesh" && args >> value) {
+            if (!parseSyntheticSpec(value, options)) options.meshPath = value;
+        }
+        else if (arg == "-generate") args >> options.generatePath;
+        else if (arg == "-chunks") args >> options.chunkPath;
+        else if (arg == "-frames") args >> options.frames;
+        else if (arg == "-lod") args >> options.detail;
+        else if (arg == "-step") args >> options.stepX >> options.stepY;
+        else if (arg == "-save") args >> options.savePath;
+        else if (arg == "-compare") args >> options.goldenPath;
+    }
+    if (options.frames < 1) options.frames = 1;
+    return options.benchmark || !options.generatePath.empty() || !options.chunkPath.empty();
+}
+
+// Load, optionally export, then time every frame of the scripted rotation
+int runBenchmark(const BenchmarkOptions& options) {
+    // A text mesh is chunked without loading it; a synthetic one has to be written out with -generate first
+    if (!options.chunkPath.empty() && !options.synthetic) {
+        if (!writeChunks(options.meshPath.c_str(), options.chunkPath.c_str())) return 1;
+        if (!options.benchmark) return 0;
+    }
+
+    LONGLONG loadStart = profileNow();
+    std::vector<LodLevel> lods;
+    std::vector<MeshBvh> bvhs;
+    MeshLayoutStats layout;
+    if (!streamPath.empty()) {
+        if (!openStreamedMesh(streamPath.c_str())) {
+            fprintf(stderr, "Could not open %s\n", streamPath.c_str());
+            return 1;
+        }
+    }
+    else if (!scenePath.empty()) {
+        if (!openScene(scenePath.c_str())) {
+            fprintf(stderr, "Could not load scene %s\n", scenePath.c_str());
+            return 1;
+        }
+    }
+    else if (options.synthetic) {
+        generateSyntheticMesh(options.shape, options.triangles, vertices, faces);
+        if (options.shuffle) shuffleMesh(vertices, faces);
+    }
+    else if (!loadMeshCached(options.meshPath.c_str(), vertices, faces, lods, bvhs, options.reorder, compactMesh, &layout)) {
+        fprintf(stderr, "Could not load %s\n", options.meshPath.c_str());
+        return 1;
+    }
+    LONGLONG loadEnd = profileNow();
+
+    if (!options.generatePath.empty()) {
+        if (!writeMeshFile(options.generatePath.c_str(), vertices, faces)) {
+            fprintf(stderr, "Could not write %s\n", options.generatePath.c_str());
+            return 1;
+        }
+        printf("wrote       %s: %zu vertices, %zu faces\n", options.generatePath.c_str(), vertices.size(), faces.size());
+        if (options.synthetic && !options.chunkPath.empty() && !writeChunks(options.generatePath.c_str(), options.chunkPath.c_str())) {
+            return 1;
+        }
+        if (!options.benchmark) return 0;
+    }
+    else if (!options.chunkPath.empty() && options.synthetic) {
+        fprintf(stderr, "-chunks needs a text mesh: pass -mesh file.txt, or -generate one first\n");
+        return 1;
+    }
+
+    // Synthetic meshes skip the cache, so what it would hold is built here; a stream assembles itself per frame
+    // and a scene was made render-ready as it loaded
+    if (!streamingMesh && scene.instances.empty()) {
+        if (options.synthetic) layout = buildDerivedMeshData(vertices, faces, lods, bvhs, options.reorder);
+        normalizeVertices();
+        computeFaceNormals();
+        prepareDetailLevels(lods, bvhs);
+    }
+    LONGLONG prepareEnd = profileNow();
+
+    // Without a pass this run, report the full-detail order as it stands
+    const float acmr = layout.optimized ? layout.acmrAfter : scene.instances.empty() ? averageCacheMissRatio(faces, detailLevels[0].vertexCount) : 0;
+    if (!setDetailLevel(options.detail) && options.detail != 0) {
+        fprintf(stderr, "Detail level %d not available (%zu levels)\n", options.detail, detailLevels.size());
+        return 1;
+    }
+
+    if (!resizeRenderTarget(renderTarget, WIDTH, HEIGHT)) {
+        fprintf(stderr, "Could not create a %dx%d back buffer\n", WIDTH, HEIGHT);
+        return 1;
+    }
+    useSoftwareRasterizer = !options.gdi;
+
+    // A half-resolution preview is projected at half scale into its own target, as drawShadedModel does
+    const bool halfResolution = options.preview && halfResolutionPreview;
+    if (halfResolution) {
+        if (!resizeRenderTarget(previewTarget, (WIDTH + 1) / 2, (HEIGHT + 1) / 2)) {
+            fprintf(stderr, "Could not create a preview back buffer\n");
+            return 1;
+        }
+        frameScale = 0.5f;
+    }
+    RenderTarget& target = halfResolution ? previewTarget : renderTarget;
+
+    // Same work as one mouse move plus one repaint, minus the blit to a window. Heap allocations are counted
+    // over the transform and render only, once the first two frames have sized the arena and the streams.
+    std::vector<double> frameMs(options.frames);
+    uint64_t steadyAllocations = 0;
+    LONGLONG runStart = profileNow();
+    for (int frame = 0; frame < options.frames; ++frame) {
+        LONGLONG start = profileNow();
+        angleX = frame * options.stepX;
+        angleY = frame * options.stepY;
+        updateStreamedMesh();
+        const uint64_t allocationsBefore = heapAllocationCount();
+        applyTransform();
+        renderFrame(target, options.preview);
+        GdiFlush();
+        if (frame >= BENCHMARK_WARMUP_FRAMES) steadyAllocations += heapAllocationCount() - allocationsBefore;
+        frameMs[frame] = elapsedMs(start, profileNow());
+        endProfileFrame();
+    }
+    const double runMs = elapsedMs(runStart, profileNow());
+
+    // The first frame pays for cold caches and lazily sized buffers
+    std::vector<double> sorted(frameMs.begin() + (options.frames > 1 ? 1 : 0), frameMs.end());
+    std::sort(sorted.begin(), sorted.end());
+    double mean = 0;
+    for (double ms : sorted) mean += ms;
+    mean /= sorted.size();
+
+    if (streamingMesh) {
+        const ChunkResidencyStats& residency = chunkStream.stats;
+        printf("mesh        %s: %llu vertices, %llu faces, %zu chunks\n", streamPath.c_str(),
+            static_cast<unsigned long long>(chunkStream.header.vertexCount), static_cast<unsigned long long>(chunkStream.header.faceCount),
+            chunkStream.chunks.size());
+        printf("residency   %zu resident (%zu visible), %zu faces, %.1f of %.1f MB, %zu pending\n", residency.residentChunks,
+            residency.visibleChunks, residency.residentFaces, residency.residentBytes / 1048576.0, chunkStream.budgetBytes / 1048576.0,
+            residency.pending);
+        printf("paging      %zu page-ins in %.2f ms, %zu evictions\n", residency.pageIns, residency.pageInMs, residency.evictions);
+    }
+    else if (!scene.instances.empty()) {
+        printSceneSummary();
+    }
+    else {
+        printf("mesh        %s: %zu vertices, %zu faces%s\n", options.synthetic ? "synthetic" : options.meshPath.c_str(),
+            detailLevels[0].vertexCount, detailLevels[0].faceCount, compactMesh ? ", 16-bit positions" : "");
+    }
+    if (scene.instances.empty()) {
+        printf("detail      level %d of %zu, %zu faces\n", activeDetail, detailLevels.size() - 1, faces.size());
+        printf("memory      positions %.1f MB, parsed vertices %.1f MB, faces %.1f MB\n",
+            (compactMesh ? 3 * quantized.x.size() * sizeof(uint16_t) : 3 * normalized.x.size() * sizeof(float)) / 1048576.0,
+            vertices.capacity() * sizeof(Vertex) / 1048576.0, faces.size() * sizeof(Face) / 1048576.0);
+    }
+    printf("config      %s path%s, %s kernel, %u threads, tile %d, %dx%d\n", options.gdi ? "GDI" : "raster",
+        options.preview ? " preview" : "", transformKernelName(renderContext.kernel), tileRenderer.pool ? tileRenderer.pool->size() : 1,
+        tileRenderer.config.tileSize, target.frame.width, target.frame.height);
+    printf("load        %.2f ms (+ %.2f ms layout, LOD, normalize and normals)\n", elapsedMs(loadStart, loadEnd), elapsedMs(loadEnd, prepareEnd));
+    if (layout.optimized) {
+        printf("layout      reordered, ACMR %.3f -> %.3f (FIFO %zu)\n", layout.acmrBefore, layout.acmrAfter, VERTEX_CACHE_SIZE);
+    }
+    else if (!streamingMesh && scene.instances.empty()) {
+        printf("layout      %s, ACMR %.3f (FIFO %zu)\n", options.reorder ? "reordered (cached)" : "leaf order", acmr, VERTEX_CACHE_SIZE);
+    }
+    printf("frames      %d, first %.2f ms\n", options.frames, frameMs[0]);
+    printf("latency     mean %.3f  p50 %.3f  p99 %.3f  max %.3f ms\n", mean,
+        percentile(sorted, 0.50), percentile(sorted, 0.99), sorted.back());
+    printf("throughput  %.1f fps, %.1f M faces/s\n", options.frames * 1000.0 / runMs,
+        cullStats.total * static_cast<double>(options.frames) / (runMs * 1000.0));
+    printf("dots        %zu drawn, %zu hidden, %zu over the density cap (last frame)\n", dotStats.drawn, dotStats.hidden,
+        dotStats.crowded);
+    if (heapAllocationsCounted()) {
+        printf("allocations %llu in %d steady frames, frame arena %.1f MB\n", static_cast<unsigned long long>(steadyAllocations),
+            std::max(0, options.frames - BENCHMARK_WARMUP_FRAMES), frameArena.capacity / 1048576.0);
+    }
+    else {
+        printf("allocations not counted in this build (define SHADER_COUNT_ALLOCATIONS), frame arena %.1f MB\n",
+            frameArena.capacity / 1048576.0);
+    }
+
+    if (options.reload && !reloadAndRedraw(options, target)) return 1;
+
+    int result = 0;
+    const FrameBuffer& frame = target.frame;
+    if (!options.savePath.empty()) {
+        if (writeBitmapFile(options.savePath.c_str(), frame.pixels, frame.width, frame.height)) {
+            printf("saved       %s\n", options.savePath.c_str());
+        }
+        else {
+            fprintf(stderr, "Could not write %s\n", options.savePath.c_str());
+            result = 1;
+        }
+    }
+    if (!options.goldenPath.empty() && !compareWithGolden(options.goldenPath.c_str(), frame)) {
+        result = 2;
+    }
+
+    if (profiler.logFrames) writeProfileCsv(profiler.csvPath.c_str());
+    releaseRenderTarget(renderTarget);
+    releaseRenderTarget(previewTarget);
+    fflush(stdout);
+    return result;
+}
@@ -0,0 +1,48 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Headless benchmark, built as the headless-bench target:
+//      loads, generates or streams a mesh, or loads an instanced
+//      scene, renders a scripted rotation into the offscreen back
+//      buffer without ever creating a window, and reports load
+//      time, per-frame latency, throughput, chunk residency and
+//      steady-state heap allocations. The frames can be the
+//      progressive previews a drag draws instead. The last frame
+//      can be saved as a BMP or compared against a golden image,
+//      optionally after reloading the mesh the way the file
+//      watcher would.
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstddef>
+#include <string>
+#include "SyntheticMesh.hpp"
+
+// Settings for a headless run, read from the command line
+struct BenchmarkOptions {
+    bool benchmark = false;             // "-bench": render frames and report timings
+    std::string meshPath = "object.txt";// "-mesh path": object.txt-format file to load
+    bool synthetic = false;             // "-mesh shape:triangles" generates instead of loading
+    SyntheticShape shape = SyntheticShape::Sphere;
+    size_t triangles = 0;
+    bool shuffle = false;               // "-shuffle": scramble the synthetic mesh's face and vertex order
+    bool reorder = false;               // "-reorder": optimize face and vertex order for cache reuse at load
+    std::string generatePath;           // "-generate out.txt": write the (synthetic) mesh and exit
+    std::string chunkPath;              // "-chunks out.chunks": split the text mesh into an out-of-core chunk file and exit
+    int frames = 360;                   // "-frames N"
+    float stepX = 0.5f;                 // "-step dx dy": degrees added to angleX / angleY per frame
+    float stepY = 1.0f;
+    int detail = 0;                     // "-lod N": render LOD level N (0 is full detail)
+    bool gdi = false;                   // "-gdi": benchmark the painter's path instead of the rasterizer
+    bool reload = false;                // "-reload": time a full and a positions-only hot reload, then redraw the last frame
+    bool preview = false;               // "-preview": draw progressive previews, half size with "-halfres", instead of full frames
+    std::string savePath;               // "-save out.bmp": write the final frame
+    std::string goldenPath;             // "-compare golden.bmp": fail if the final frame differs
+};
+
+// Reads the headless options; returns true if the command line asks for a headless run
+bool parseBenchmarkOptions(const char* cmdLine, BenchmarkOptions& options);
+
+// Runs a headless session and returns the process exit code:
+// 0 on success, 1 if the mesh or an output file fails, 2 if the golden image does not match
+int runBenchmark(const BenchmarkOptions& options);
@@ -0,0 +1,98 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - BMP Files
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "BitmapFile.hpp"
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// Both headers together, written field by field so struct packing never matters
+const size_t FILE_HEADER_SIZE = 14;
+const size_t INFO_HEADER_SIZE = 40;
+
+void put16(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void put32(uint8_t* p, uint32_t value) {
+    put16(p, value);
+    put16(p + 2, value >> 16);
+}
+
+uint32_t get16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+uint32_t get32(const uint8_t* p) {
+    return get16(p) | (get16(p + 2) << 16);
+}
+
+} // namespace
+
+// BITMAPFILEHEADER + BITMAPINFOHEADER with a negative height, then the rows as stored
+bool writeBitmapFile(const char* path, const uint32_t* pixels, int width, int height) {
+    if (width <= 0 || height <= 0) return false;
+    const uint32_t imageSize = static_cast<uint32_t>(width) * height * 4;
+
+    uint8_t header[FILE_HEADER_SIZE + INFO_HEADER_SIZE] = {};
+    header[0] = 'B';
+    header[1] = 'M';
+    put32(header + 2, static_cast<uint32_t>(sizeof(header)) + imageSize);
+    put32(header + 10, static_cast<uint32_t>(sizeof(header)));
+
+    uint8_t* info = header + FILE_HEADER_SIZE;
+    put32(info, INFO_HEADER_SIZE);
+    put32(info + 4, static_cast<uint32_t>(width));
+    put32(info + 8, static_cast<uint32_t>(-height));
+    put16(info + 12, 1);        // Planes
+    put16(info + 14, 32);       // Bits per pixel
+    put32(info + 20, imageSize);
+
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+    bool ok = fwrite(header, sizeof(header), 1, file) == 1
+        && fwrite(pixels, imageSize, 1, file) == 1;
+    return fclose(file) == 0 && ok;
+}
+
+// Only BI_RGB data is accepted; that covers what this viewer and common tools write
+bool readBitmapFile(const char* path, std::vector<uint32_t>& pixels, int& width, int& height) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+
+    std::vector<uint8_t> data;
+    uint8_t block[1 << 16];
+    size_t read;
+    while ((read = fread(block, 1, sizeof(block), file)) > 0) data.insert(data.end(), block, block + read);
+    fclose(file);
+
+    if (data.size() < FILE_HEADER_SIZE + INFO_HEADER_SIZE || data[0] != 'B' || data[1] != 'M') return false;
+    const uint8_t* info = data.data() + FILE_HEADER_SIZE;
+    const uint32_t offset = get32(data.data() + 10);
+    const int32_t w = static_cast<int32_t>(get32(info + 4));
+    const int32_t h = static_cast<int32_t>(get32(info + 8));
+    const uint32_t bits = get16(info + 14);
+    const uint32_t compression = get32(info + 16);
+    if (w <= 0 || h == 0 || h == INT32_MIN || (bits != 24 && bits != 32) || compression != 0) return false;
+
+    const bool topDown = h < 0;
+    width = w;
+    height = topDown ? -h : h;
+    const size_t stride = (static_cast<size_t>(width) * bits / 8 + 3) & ~static_cast<size_t>(3);
+    if (offset > data.size() || stride * height > data.size() - offset) return false;
+
+    pixels.resize(static_cast<size_t>(width) * height);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = data.data() + offset + stride * (topDown ? y : height - 1 - y);
+        for (int x = 0; x < width; ++x) {
+            const uint8_t* p = row + x * (bits / 8);
+            pixels[static_cast<size_t>(y) * width + x] = (p[2] << 16) | (p[1] << 8) | p[0];
+        }
+    }
+    return true;
+}
@@ -0,0 +1,17 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Minimal BMP reader/writer for 32-bit 0x00RRGGBB pixel buffers,
+//      used to save headless renders and compare them against golden
+//      images.
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Writes a top-down 32 bpp uncompressed BMP; returns false if the file cannot be written
+bool writeBitmapFile(const char* path, const uint32_t* pixels, int width, int height);
+
+// Reads an uncompressed 24 or 32 bpp BMP of either row order into top-down 0x00RRGGBB pixels
+bool readBitmapFile(const char* path, std::vector<uint32_t>& pixels, int& width, int& height);
@@ -0,0 +1,488 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Direct3D 11 Renderer
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Renderer.hpp"
+#include "3DShaderViewer.hpp"
+#include "Profiler.hpp"
+#include <d3d11.h>
+#include <d3dcompiler.h>
+#include <wrl/client.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#undef min
+#undef max
+
+#ifdef _MSC_VER
+#pragma comment(lib, "d3d11.lib")
+#pragma comment(lib, "d3dcompiler.lib")
+#endif
+
+using Microsoft::WRL::ComPtr;
+
+namespace {
+
+// Faces are shaded from the screen-space derivatives of their view position, which gives the
+// flat face normal without a per-face vertex copy. Depth is 0.5 - 0.5 * z, so nearer (larger z)
+// is smaller depth and the unit-sphere model always lands inside [0, 1].
+const char SHADER_SOURCE[] = R"(
+cbuffer View : register(b0) {
+    float4 row0;        // Rotation matrix rows (xyz) and translation (w), with any dequantization folded in
+    float4 row1;
+    float4 row2;
+    float4 viewport;    // View x/y to NDC: scale x, scale y, offset x, offset y
+    float4 color;       // Flat color for the edge and dot passes
+    float4 params;      // x: depth offset toward the viewer, yz: dot half-size in NDC
+};
+
+struct FaceVertex {
+    float4 pos : SV_Position;
+    float3 view : VIEWPOS;
+};
+
+float3 rotate(float3 p) {
+    return float3(dot(row0.xyz, p) + row0.w, dot(row1.xyz, p) + row1.w, dot(row2.xyz, p) + row2.w);
+}
+
+float4 toClip(float3 v) {
+    return float4(v.x * viewport.x + viewport.z, v.y * viewport.y + viewport.w, 0.5 - 0.5 * v.z - params.x, 1);
+}
+
+FaceVertex FaceVS(float3 p : POSITION) {
+    FaceVertex o;
+    o.view = rotate(p);
+    o.pos = toClip(o.view);
+    return o;
+}
+
+// Same mapping as shadeBlue: #00005F edge-on to #0000FF face-on
+float4 ShadePS(FaceVertex i) : SV_Target {
+    float3 n = normalize(cross(ddx(i.view), ddy(i.view)));
+    return float4(0, 0, floor(95.0 + abs(n.z) * 160.0) / 255.0, 1);
+}
+
+float4 SolidPS(FaceVertex i) : SV_Target {
+    return color;
+}
+
+struct DotVertex {
+    float4 pos : SV_Position;
+    float2 corner : CORNER;
+};
+
+// Six vertices per instance make a screen-aligned quad around each model vertex
+DotVertex DotVS(float3 p : POSITION, uint id : SV_VertexID) {
+    const float2 corners[6] = { float2(-1, -1), float2(-1, 1), float2(1, 1), float2(-1, -1), float2(1, 1), float2(1, -1) };
+    float3 v = rotate(p);
+    DotVertex o;
+    o.corner = corners[id];
+    o.pos = toClip(v);
+    o.pos.xy += o.corner * params.yz;
+    if (v.z <= 0) o.pos.z = -1;   // Dots only on the viewer's half, like the CPU path
+    return o;
+}
+
+float4 DotPS(DotVertex i) : SV_Target {
+    if (dot(i.corner, i.corner) > 1) discard;
+    return color;
+}
+)";
+
+// Must match the View cbuffer
+struct ViewConstants {
+    float row0[4];
+    float row1[4];
+    float row2[4];
+    float viewport[4];
+    float color[4];
+    float params[4];
+};
+static_assert(sizeof(ViewConstants) % 16 == 0, "Constant buffers are sized in 16-byte registers");
+
+// GPU copy of one detail level
+struct MeshBuffers {
+    ComPtr<ID3D11Buffer> vertices;      // float3 per vertex from the normalized stream, or unorm16x4 from the quantized one
+    ComPtr<ID3D11Buffer> indices;       // Index triple per face, 0-based
+    ComPtr<ID3D11Buffer> edgeIndices;   // Index pair per unique edge, flagged feature edges first
+    bool quantized = false;
+    float offset[3] = { 0, 0, 0 };      // Dequantization of the unorm positions: p = offset + unorm * scale
+    float scale[3] = { 1, 1, 1 };
+    DXGI_FORMAT indexFormat = DXGI_FORMAT_R32_UINT;   // 16-bit whenever the vertex count allows
+    UINT vertexCount = 0;
+    UINT indexCount = 0;
+    UINT edgeIndexCount = 0;
+    UINT featureIndexCount = 0;         // Leading part of edgeIndices holding the flagged edges
+};
+
+// Depth slack for edges and dots, in depth units (half the view-space bias)
+const float EDGE_DEPTH_OFFSET = 0.0025f;
+
+// 6x6 pixel dots, as drawn by the CPU path
+const float DOT_SIZE_PIXELS = 6.0f;
+
+class D3D11Renderer : public Renderer {
+public:
+    bool initialize(HWND window);
+
+    const char* name() const override {
+        return "D3D11";
+    }
+
+    bool usesCpuTransform() const override {
+        return false;
+    }
+
+    bool resize(int width, int height) override;
+
+    void invalidateMesh() override {
+        levels.clear();
+    }
+
+    void draw(HDC hdc) override;
+
+private:
+    bool createTargets();
+    bool compileShader(const char* entry, const char* target, ComPtr<ID3DBlob>& blob);
+    MeshBuffers* meshBuffers();
+
+    HWND hwnd = nullptr;
+    int width = 0;
+    int height = 0;
+    ComPtr<ID3D11Device> device;
+    ComPtr<ID3D11DeviceContext> context;
+    ComPtr<IDXGISwapChain> swapChain;
+    ComPtr<ID3D11RenderTargetView> renderView;
+    ComPtr<ID3D11DepthStencilView> depthView;
+    ComPtr<ID3D11VertexShader> faceVS, dotVS;
+    ComPtr<ID3D11PixelShader> shadePS, solidPS, dotPS;
+    ComPtr<ID3D11InputLayout> faceLayout[2], dotLayout[2];     // [quantized positions]
+    ComPtr<ID3D11Buffer> constants;
+    ComPtr<ID3D11RasterizerState> fillState[2];                 // [cullBackFaces]
+    ComPtr<ID3D11DepthStencilState> depthLess, depthLessEqual;
+    std::vector<MeshBuffers> levels;                            // Indexed by detail level, uploaded on first use
+};
+
+bool D3D11Renderer::compileShader(const char* entry, const char* target, ComPtr<ID3DBlob>& blob) {
+    ComPtr<ID3DBlob> errors;
+    HRESULT hr = D3DCompile(SHADER_SOURCE, sizeof(SHADER_SOURCE) - 1, "ShaderViewer", nullptr, nullptr, entry, target,
+        D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &blob, &errors);
+    if (FAILED(hr) && errors) OutputDebugStringA(static_cast<const char*>(errors->GetBufferPointer()));
+    return SUCCEEDED(hr);
+}
+
+// Device, swap chain, shaders and fixed pipeline state; any failure leaves the GDI fallback in charge
+bool D3D11Renderer::initialize(HWND window) {
+    hwnd = window;
+    RECT rect;
+    GetClientRect(hwnd, &rect);
+    width = rect.right > 0 ? rect.right : 1;
+    height = rect.bottom > 0 ? rect.bottom : 1;
+
+    DXGI_SWAP_CHAIN_DESC desc = {};
+    desc.BufferCount = 1;
+    desc.BufferDesc.Width = width;
+    desc.BufferDesc.Height = height;
+    desc.BufferDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+    desc.OutputWindow = hwnd;
+    desc.SampleDesc.Count = 1;
+    desc.Windowed = TRUE;
+    desc.SwapEffect = DXGI_SWAP_EFFECT_DISCARD;
+
+    // Hardware first, then the WARP software device so remote sessions still get shaders
+    const D3D_DRIVER_TYPE drivers[] = { D3D_DRIVER_TYPE_HARDWARE, D3D_DRIVER_TYPE_WARP };
+    HRESULT hr = E_FAIL;
+    for (D3D_DRIVER_TYPE driver : drivers) {
+        hr = D3D11CreateDeviceAndSwapChain(nullptr, driver, nullptr, 0, nullptr, 0, D3D11_SDK_VERSION,
+            &desc, &swapChain, &device, nullptr, &context);
+        if (SUCCEEDED(hr)) break;
+    }
+    if (FAILED(hr)) return false;
+
+    ComPtr<ID3DBlob> faceCode, dotCode, shadeCode, solidCode, dotPixelCode;
+    if (!compileShader("FaceVS", "vs_4_0", faceCode) || !compileShader("DotVS", "vs_4_0", dotCode) ||
+        !compileShader("ShadePS", "ps_4_0", shadeCode) || !compileShader("SolidPS", "ps_4_0", solidCode) ||
+        !compileShader("DotPS", "ps_4_0", dotPixelCode)) {
+        return false;
+    }
+    if (FAILED(device->CreateVertexShader(faceCode->GetBufferPointer(), faceCode->GetBufferSize(), nullptr, &faceVS)) ||
+        FAILED(device->CreateVertexShader(dotCode->GetBufferPointer(), dotCode->GetBufferSize(), nullptr, &dotVS)) ||
+        FAILED(device->CreatePixelShader(shadeCode->GetBufferPointer(), shadeCode->GetBufferSize(), nullptr, &shadePS)) ||
+        FAILED(device->CreatePixelShader(solidCode->GetBufferPointer(), solidCode->GetBufferSize(), nullptr, &solidPS)) ||
+        FAILED(device->CreatePixelShader(dotPixelCode->GetBufferPointer(), dotPixelCode->GetBufferSize(), nullptr, &dotPS))) {
+        return false;
+    }
+
+    // Faces read positions per vertex; dots read the same buffer once per instance. Quantized positions
+    // arrive as unorm in [0, 1], which the view rows scale back
+    const DXGI_FORMAT positionFormats[2] = { DXGI_FORMAT_R32G32B32_FLOAT, DXGI_FORMAT_R16G16B16A16_UNORM };
+    for (int quantized = 0; quantized < 2; ++quantized) {
+        const D3D11_INPUT_ELEMENT_DESC faceInput = { "POSITION", 0, positionFormats[quantized], 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 };
+        const D3D11_INPUT_ELEMENT_DESC dotInput = { "POSITION", 0, positionFormats[quantized], 0, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1 };
+        if (FAILED(device->CreateInputLayout(&faceInput, 1, faceCode->GetBufferPointer(), faceCode->GetBufferSize(), &faceLayout[quantized])) ||
+            FAILED(device->CreateInputLayout(&dotInput, 1, dotCode->GetBufferPointer(), dotCode->GetBufferSize(), &dotLayout[quantized]))) {
+            return false;
+        }
+    }
+
+    D3D11_BUFFER_DESC cb = {};
+    cb.ByteWidth = sizeof(ViewConstants);
+    cb.Usage = D3D11_USAGE_DYNAMIC;
+    cb.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    cb.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    if (FAILED(device->CreateBuffer(&cb, nullptr, &constants))) return false;
+
+    // Front faces wind counter-clockwise in view space, and NDC keeps y up, so that carries over
+    for (int cull = 0; cull < 2; ++cull) {
+        D3D11_RASTERIZER_DESC raster = {};
+        raster.CullMode = cull ? D3D11_CULL_BACK : D3D11_CULL_NONE;
+        raster.FrontCounterClockwise = TRUE;
+        raster.DepthClipEnable = TRUE;
+        raster.FillMode = D3D11_FILL_SOLID;
+        if (FAILED(device->CreateRasterizerState(&raster, &fillState[cull]))) return false;
+    }
+
+    D3D11_DEPTH_STENCIL_DESC depth = {};
+    depth.DepthEnable = TRUE;
+    depth.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+    depth.DepthFunc = D3D11_COMPARISON_LESS;
+    if (FAILED(device->CreateDepthStencilState(&depth, &depthLess))) return false;
+
+    // Edges and dots test against the filled surface without disturbing it
+    depth.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+    depth.DepthFunc = D3D11_COMPARISON_LESS_EQUAL;
+    if (FAILED(device->CreateDepthStencilState(&depth, &depthLessEqual))) return false;
+
+    return createTargets();
+}
+
+// Views onto the swap chain's back buffer plus a matching depth buffer
+bool D3D11Renderer::createTargets() {
+    ComPtr<ID3D11Texture2D> backBuffer;
+    if (FAILED(swapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), reinterpret_cast<void**>(backBuffer.GetAddressOf())))) return false;
+    if (FAILED(device->CreateRenderTargetView(backBuffer.Get(), nullptr, &renderView))) return false;
+
+    D3D11_TEXTURE2D_DESC depthDesc = {};
+    depthDesc.Width = width;
+    depthDesc.Height = height;
+    depthDesc.MipLevels = 1;
+    depthDesc.ArraySize = 1;
+    depthDesc.Format = DXGI_FORMAT_D32_FLOAT;
+    depthDesc.SampleDesc.Count = 1;
+    depthDesc.Usage = D3D11_USAGE_DEFAULT;
+    depthDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+    ComPtr<ID3D11Texture2D> depthBuffer;
+    if (FAILED(device->CreateTexture2D(&depthDesc, nullptr, &depthBuffer))) return false;
+    return SUCCEEDED(device->CreateDepthStencilView(depthBuffer.Get(), nullptr, &depthView));
+}
+
+// Views must be released before the swap chain can resize its buffers
+bool D3D11Renderer::resize(int newWidth, int newHeight) {
+    if (newWidth <= 0 || newHeight <= 0) return true;   // Minimized: keep the old buffers
+    if (newWidth == width && newHeight == height && renderView) return true;
+
+    context->OMSetRenderTargets(0, nullptr, nullptr);
+    renderView.Reset();
+    depthView.Reset();
+    width = newWidth;
+    height = newHeight;
+    if (FAILED(swapChain->ResizeBuffers(0, width, height, DXGI_FORMAT_UNKNOWN, 0))) return false;
+    return createTargets();
+}
+
+// Each level is uploaded the first time it is drawn and then reused for the session
+MeshBuffers* D3D11Renderer::meshBuffers() {
+    if (levels.size() < detailLevels.size() || levels.empty()) levels.resize(detailLevels.size() > 0 ? detailLevels.size() : 1);
+    MeshBuffers& mesh = levels[activeDetail];
+    const size_t vertexCount = compactMesh ? quantized.count : normalized.count;
+    if (mesh.vertices || vertexCount == 0) return &mesh;
+
+    // Quantized levels upload their 16-bit positions as they are, padded to four components
+    std::vector<float> positions;
+    std::vector<uint16_t> packedPositions;
+    mesh.quantized = compactMesh;
+    if (mesh.quantized) {
+        packedPositions.assign(vertexCount * 4, 0);
+        for (size_t i = 0; i < vertexCount; ++i) {
+            packedPositions[4 * i] = quantized.x[i];
+            packedPositions[4 * i + 1] = quantized.y[i];
+            packedPositions[4 * i + 2] = quantized.z[i];
+        }
+        for (int axis = 0; axis < 3; ++axis) {
+            mesh.offset[axis] = quantized.offset[axis];
+            mesh.scale[axis] = quantized.scale[axis] * 65535.0f;
+        }
+    }
+    else {
+        positions.resize(vertexCount * 3);
+        for (size_t i = 0; i < vertexCount; ++i) {
+            positions[3 * i] = normalized.x[i];
+            positions[3 * i + 1] = normalized.y[i];
+            positions[3 * i + 2] = normalized.z[i];
+        }
+    }
+    std::vector<uint32_t> indices(faces.size() * 3);
+    for (size_t i = 0; i < faces.size(); ++i) {
+        indices[3 * i] = faces[i].v1 - 1;
+        indices[3 * i + 1] = faces[i].v2 - 1;
+        indices[3 * i + 2] = faces[i].v3 - 1;
+    }
+
+    // Two passes over the edge list put the flagged ones in front, so feature mode draws a prefix
+    std::vector<uint32_t> edgeIndices;
+    edgeIndices.reserve(meshEdges.edges.size() * 2);
+    for (int pass = 0; pass < 2; ++pass) {
+        for (size_t i = 0; i < meshEdges.edges.size(); ++i) {
+            if ((meshEdges.flags[i] != 0) != (pass == 0)) continue;
+            edgeIndices.push_back(meshEdges.edges[i].v[0]);
+            edgeIndices.push_back(meshEdges.edges[i].v[1]);
+        }
+        if (pass == 0) mesh.featureIndexCount = static_cast<UINT>(edgeIndices.size());
+    }
+
+    D3D11_BUFFER_DESC desc = {};
+    desc.Usage = D3D11_USAGE_IMMUTABLE;
+    D3D11_SUBRESOURCE_DATA data = {};
+
+    desc.ByteWidth = static_cast<UINT>(mesh.quantized ? packedPositions.size() * sizeof(uint16_t) : positions.size() * sizeof(float));
+    desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    data.pSysMem = mesh.quantized ? static_cast<const void*>(packedPositions.data()) : positions.data();
+    if (FAILED(device->CreateBuffer(&desc, &data, &mesh.vertices))) return nullptr;
+
+    // 0-based indices fit 16 bits up to 65536 vertices, which halves both index buffers
+    const bool shortIndices = vertexCount <= 65536;
+    mesh.indexFormat = shortIndices ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+    auto createIndexBuffer = [&](const std::vector<uint32_t>& source, ComPtr<ID3D11Buffer>& buffer) {
+        if (source.empty()) return true;
+        std::vector<uint16_t> narrow;
+        if (shortIndices) narrow.assign(source.begin(), source.end());
+        desc.ByteWidth = static_cast<UINT>(source.size() * (shortIndices ? sizeof(uint16_t) : sizeof(uint32_t)));
+        desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+        data.pSysMem = shortIndices ? static_cast<const void*>(narrow.data()) : source.data();
+        return SUCCEEDED(device->CreateBuffer(&desc, &data, &buffer));
+    };
+    if (!createIndexBuffer(indices, mesh.indices) || !createIndexBuffer(edgeIndices, mesh.edgeIndices)) return nullptr;
+    mesh.vertexCount = static_cast<UINT>(vertexCount);
+    mesh.indexCount = static_cast<UINT>(indices.size());
+    mesh.edgeIndexCount = static_cast<UINT>(edgeIndices.size());
+    return &mesh;
+}
+
+// Rotation is one constant-buffer write; faces, edges and dots are three draws from the same buffers
+void D3D11Renderer::draw(HDC) {
+    if (!renderView) return;
+    MeshBuffers* mesh = meshBuffers();
+
+    ViewConstants view = {};
+    {
+        ProfileScope scope(STAGE_TRANSFORM);
+        const Matrix3 r = rotationMatrix(angleX, angleY);
+        const float identityScale[3] = { 1, 1, 1 }, zero[3] = { 0, 0, 0 };
+        const float* unormScale = mesh && mesh->quantized ? mesh->scale : identityScale;
+        const float* unormOffset = mesh && mesh->quantized ? mesh->offset : zero;
+        float* rows[3] = { view.row0, view.row1, view.row2 };
+        for (int row = 0; row < 3; ++row) {
+            for (int c = 0; c < 3; ++c) {
+                rows[row][c] = r.m[row][c] * unormScale[c];
+                rows[row][3] += r.m[row][c] * unormOffset[c];
+            }
+        }
+
+        // Same pixel mapping as applyTransform, then pixels to NDC for the actual back buffer size
+        const float scale = std::min(WIDTH, HEIGHT) * 0.4f;
+        view.viewport[0] = 2 * scale / width;
+        view.viewport[1] = 2 * scale / height;
+        view.viewport[2] = 2.0f * (WIDTH / 2) / width - 1;
+        view.viewport[3] = 1 - 2.0f * (HEIGHT / 2) / height;
+        view.params[0] = 0;
+        view.params[1] = DOT_SIZE_PIXELS / width;
+        view.params[2] = DOT_SIZE_PIXELS / height;
+    }
+
+    auto upload = [&]() {
+        D3D11_MAPPED_SUBRESOURCE mapped;
+        if (SUCCEEDED(context->Map(constants.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) {
+            memcpy(mapped.pData, &view, sizeof(view));
+            context->Unmap(constants.Get(), 0);
+        }
+    };
+    upload();
+
+    COLORREF background = GetSysColor(COLOR_WINDOW);
+    const float clear[4] = { GetRValue(background) / 255.0f, GetGValue(background) / 255.0f, GetBValue(background) / 255.0f, 1 };
+    context->ClearRenderTargetView(renderView.Get(), clear);
+    context->ClearDepthStencilView(depthView.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
+
+    D3D11_VIEWPORT viewport = { 0, 0, static_cast<float>(width), static_cast<float>(height), 0, 1 };
+    context->RSSetViewports(1, &viewport);
+    context->OMSetRenderTargets(1, renderView.GetAddressOf(), depthView.Get());
+    context->VSSetConstantBuffers(0, 1, constants.GetAddressOf());
+    context->PSSetConstantBuffers(0, 1, constants.GetAddressOf());
+
+    if (mesh && mesh->vertices) {
+        const UINT stride = mesh->quantized ? 4 * sizeof(uint16_t) : 3 * sizeof(float), offset = 0;
+        context->IASetVertexBuffers(0, 1, mesh->vertices.GetAddressOf(), &stride, &offset);
+
+        if (mesh->indices) {
+            ProfileScope scope(STAGE_FILL);
+            context->IASetInputLayout(faceLayout[mesh->quantized].Get());
+            context->IASetIndexBuffer(mesh->indices.Get(), mesh->indexFormat, 0);
+            context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+            context->VSSetShader(faceVS.Get(), nullptr, 0);
+            context->PSSetShader(shadePS.Get(), nullptr, 0);
+            context->RSSetState(fillState[cullBackFaces].Get());
+            context->OMSetDepthStencilState(depthLess.Get(), 0);
+            context->DrawIndexed(mesh->indexCount, 0, 0);
+        }
+
+        // Edges and dots are pulled slightly toward the viewer so they sit on their own faces
+        view.params[0] = EDGE_DEPTH_OFFSET;
+        view.color[3] = 1;
+        upload();
+
+        // Each shared edge is one line; hidden ones fail the depth test against the filled faces.
+        // Silhouettes depend on the view and need the CPU's face normals, so feature mode here
+        // draws only the static boundary, crease and non-manifold edges.
+        if (mesh->edgeIndices) {
+            ProfileScope scope(STAGE_WIREFRAME);
+            context->IASetIndexBuffer(mesh->edgeIndices.Get(), mesh->indexFormat, 0);
+            context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
+            context->PSSetShader(solidPS.Get(), nullptr, 0);
+            context->RSSetState(fillState[0].Get());
+            context->OMSetDepthStencilState(depthLessEqual.Get(), 0);
+            context->DrawIndexed(featureEdgesOnly ? mesh->featureIndexCount : mesh->edgeIndexCount, 0, 0);
+        }
+
+        view.color[2] = 1;
+        upload();
+        {
+            ProfileScope scope(STAGE_DOTS);
+            context->IASetInputLayout(dotLayout[mesh->quantized].Get());
+            context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+            context->VSSetShader(dotVS.Get(), nullptr, 0);
+            context->PSSetShader(dotPS.Get(), nullptr, 0);
+            context->RSSetState(fillState[0].Get());
+            context->OMSetDepthStencilState(depthLessEqual.Get(), 0);
+            context->DrawInstanced(6, mesh->vertexCount, 0, 0);
+        }
+    }
+
+    // The message loop already paces frames with DwmFlush, so present without waiting for vblank
+    {
+        ProfileScope scope(STAGE_BLIT);
+        swapChain->Present(0, 0);
+    }
+    endProfileFrame();
+}
+
+} // namespace
+
+std::unique_ptr<Renderer> createD3D11Renderer(HWND hwnd) {
+    std::unique_ptr<D3D11Renderer> renderer(new D3D11Renderer());
+    if (!renderer->initialize(hwnd)) return nullptr;
+    return std::unique_ptr<Renderer>(renderer.release());
+}
@@ -0,0 +1,127 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Depth Sort
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "DepthSort.hpp"
+#include <cfloat>
+#include <utility>
+
+namespace {
+
+const int DIGIT_BITS = DEPTH_KEY_BITS / 2;
+const uint32_t DIGIT_MASK = (1u << DIGIT_BITS) - 1;
+
+// Moves an insertion refresh may spend per item before the radix sort is cheaper
+const size_t INSERTION_BUDGET_PER_ITEM = 4;
+
+// Items sampled to predict what an insertion refresh would cost
+const size_t COST_SAMPLES = 1024;
+
+// Map depths linearly onto [0, 2^DEPTH_KEY_BITS) using this frame's depth range
+void quantize(DepthSorter& sorter, const float* depth, size_t count) {
+    float lo = FLT_MAX, hi = -FLT_MAX;
+    for (size_t i = 0; i < count; ++i) {
+        if (depth[i] < lo) lo = depth[i];
+        if (depth[i] > hi) hi = depth[i];
+    }
+    const float maxKey = static_cast<float>((1u << DEPTH_KEY_BITS) - 1);
+    const float scale = hi > lo ? maxKey / (hi - lo) : 0.0f;
+
+    sorter.keys.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        sorter.keys[i] = static_cast<uint32_t>((depth[i] - lo) * scale);
+    }
+}
+
+// Predict insertion moves per item: an item shifts past roughly as many neighbours as there are
+// items in the key span it moved since last frame, estimated from an evenly spaced sample
+double estimateMovesPerItem(const DepthSorter& sorter) {
+    const size_t count = sorter.order.size();
+    const size_t step = count / COST_SAMPLES + 1;
+    double totalShift = 0;
+    size_t samples = 0;
+    for (size_t i = 0; i < count; i += step) {
+        const uint32_t item = sorter.order[i];
+        const uint32_t now = sorter.keys[item], before = sorter.previousKeys[item];
+        totalShift += now > before ? now - before : before - now;
+        ++samples;
+    }
+    const double itemsPerKey = static_cast<double>(count) / (1u << DEPTH_KEY_BITS);
+    return samples ? 0.5 * totalShift / samples * itemsPerKey : 0.0;
+}
+
+// Re-sort last frame's order in place; gives up (returning false) once the move budget is spent
+bool insertionRefresh(DepthSorter& sorter) {
+    std::vector<uint32_t>& order = sorter.order;
+    const std::vector<uint32_t>& keys = sorter.keys;
+    const size_t budget = order.size() * INSERTION_BUDGET_PER_ITEM;
+    size_t moves = 0;
+
+    for (size_t i = 1; i < order.size(); ++i) {
+        const uint32_t item = order[i];
+        const uint32_t key = keys[item];
+        size_t j = i;
+        while (j > 0 && keys[order[j - 1]] > key) {
+            order[j] = order[j - 1];
+            --j;
+            if (++moves > budget) {
+                order[j] = item;
+                sorter.moves = moves;
+                return false;
+            }
+        }
+        order[j] = item;
+    }
+    sorter.moves = moves;
+    return true;
+}
+
+// Two-pass LSD radix sort; stable, so equal keys stay in the order they arrive in
+void radixSort(DepthSorter& sorter) {
+    std::vector<uint32_t>& order = sorter.order;
+    std::vector<uint32_t>& scratch = sorter.scratch;
+    const std::vector<uint32_t>& keys = sorter.keys;
+    scratch.resize(order.size());
+
+    std::vector<uint32_t>* source = &order;
+    std::vector<uint32_t>* target = &scratch;
+    for (int pass = 0; pass < 2; ++pass) {
+        const int shift = pass * DIGIT_BITS;
+        uint32_t counts[DIGIT_MASK + 1];
+        for (auto& c : counts) c = 0;
+        for (uint32_t item : *source) ++counts[(keys[item] >> shift) & DIGIT_MASK];
+
+        uint32_t offset = 0;
+        for (auto& c : counts) {
+            uint32_t n = c;
+            c = offset;
+            offset += n;
+        }
+        for (uint32_t item : *source) (*target)[counts[(keys[item] >> shift) & DIGIT_MASK]++] = item;
+        std::swap(source, target);
+    }
+    // An even number of passes leaves the result back in order
+}
+
+} // namespace
+
+// Refresh the previous order when the item set is unchanged, otherwise (or if that gets costly) radix sort
+void sortByDepth(DepthSorter& sorter, const float* depth, size_t count) {
+    std::swap(sorter.keys, sorter.previousKeys);
+    quantize(sorter, depth, count);
+
+    if (sorter.order.size() == count && sorter.previousKeys.size() == count) {
+        sorter.moves = 0;
+        sorter.incremental = estimateMovesPerItem(sorter) < INSERTION_BUDGET_PER_ITEM / 2 && insertionRefresh(sorter);
+        if (sorter.incremental) return;
+    }
+    else {
+        sorter.order.resize(count);
+        for (size_t i = 0; i < count; ++i) sorter.order[i] = static_cast<uint32_t>(i);
+        sorter.incremental = false;
+        sorter.moves = 0;
+    }
+    radixSort(sorter);
+}
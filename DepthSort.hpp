@@ -0,0 +1,31 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Depth sort for the painter's-algorithm path: an LSD radix
+//      sort on quantized depth keys over a persistent index array.
+//      Between frames the previous order is refreshed with an
+//      insertion sort when the keys have barely moved relative to
+//      how densely they are packed, and the radix sort takes over
+//      whenever that refresh is predicted (or turns out) to cost more.
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bits of quantized depth, sorted as two radix digits
+const int DEPTH_KEY_BITS = 22;
+
+// Persistent sort state, reused across frames
+struct DepthSorter {
+    std::vector<uint32_t> order;      // Item indices, back to front (ascending depth)
+    std::vector<uint32_t> keys;       // Quantized depth per item for the current frame
+    std::vector<uint32_t> previousKeys;   // Last frame's keys, used to predict the refresh cost
+    std::vector<uint32_t> scratch;    // Radix ping-pong buffer
+    bool incremental = false;         // True if the last sort was an insertion-sort refresh
+    size_t moves = 0;                 // Element moves spent by the last insertion refresh
+};
+
+// Orders items [0, count) by ascending depth into sorter.order; ties keep their previous order
+void sortByDepth(DepthSorter& sorter, const float* depth, size_t count);
@@ -0,0 +1,183 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Frame Arena
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "FrameArena.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+#if defined(_DEBUG) || defined(SHADER_COUNT_ALLOCATIONS)
+#define SHADER_ALLOCATION_COUNTER 1
+#endif
+
+namespace {
+
+// Round up to the arena alignment
+size_t alignedSize(size_t bytes) {
+    return (bytes + FRAME_ARENA_ALIGNMENT - 1) / FRAME_ARENA_ALIGNMENT * FRAME_ARENA_ALIGNMENT;
+}
+
+// Blocks themselves come from the aligned global heap
+void* allocateBlock(size_t bytes) {
+    return ::operator new(bytes, std::align_val_t(FRAME_ARENA_ALIGNMENT));
+}
+
+void freeBlock(void* block) {
+    ::operator delete(block, std::align_val_t(FRAME_ARENA_ALIGNMENT));
+}
+
+} // namespace
+
+FrameArena::~FrameArena() {
+    releaseFrameArena(*this);
+}
+
+// The source is left empty, as if just constructed
+FrameArena::FrameArena(FrameArena&& other) noexcept
+    : block(std::exchange(other.block, nullptr)), capacity(std::exchange(other.capacity, 0)),
+    used(std::exchange(other.used, 0)), demand(std::exchange(other.demand, 0)), peak(std::exchange(other.peak, 0)),
+    overflow(std::move(other.overflow)) {
+    other.overflow.clear();
+}
+
+// Releases this arena's blocks before taking over the source's
+FrameArena& FrameArena::operator=(FrameArena&& other) noexcept {
+    if (this != &other) {
+        releaseFrameArena(*this);
+        block = std::exchange(other.block, nullptr);
+        capacity = std::exchange(other.capacity, 0);
+        used = std::exchange(other.used, 0);
+        demand = std::exchange(other.demand, 0);
+        peak = std::exchange(other.peak, 0);
+        overflow = std::move(other.overflow);
+        other.overflow.clear();
+    }
+    return *this;
+}
+
+// Bump the block if the request fits; otherwise give it an overflow block of its own
+void* frameAllocate(FrameArena& arena, size_t bytes) {
+    bytes = alignedSize(std::max<size_t>(bytes, 1));
+    arena.demand += bytes;
+    if (arena.capacity - arena.used >= bytes) {
+        void* p = arena.block + arena.used;
+        arena.used += bytes;
+        return p;
+    }
+    arena.overflow.push_back(allocateBlock(bytes));
+    return arena.overflow.back();
+}
+
+// A quarter of headroom on regrowth absorbs small frame-to-frame changes in the visible set
+void resetFrameArena(FrameArena& arena) {
+    for (void* block : arena.overflow) freeBlock(block);
+    arena.overflow.clear();
+
+    arena.peak = std::max(arena.peak, arena.demand);
+    if (arena.peak > arena.capacity) {
+        if (arena.block) freeBlock(arena.block);
+        arena.capacity = alignedSize(arena.peak + arena.peak / 4);
+        arena.block = static_cast<char*>(allocateBlock(arena.capacity));
+    }
+    arena.used = 0;
+    arena.demand = 0;
+}
+
+FrameArenaMark markFrameArena(const FrameArena& arena) {
+    return { arena.used, arena.demand, arena.overflow.size() };
+}
+
+// The demand since the mark still counts towards the peak, so the block grows to fit whatever ran in between
+void rewindFrameArena(FrameArena& arena, const FrameArenaMark& mark) {
+    for (size_t i = mark.overflow; i < arena.overflow.size(); ++i) freeBlock(arena.overflow[i]);
+    arena.overflow.resize(mark.overflow);
+    arena.peak = std::max(arena.peak, arena.demand);
+    arena.used = mark.used;
+    arena.demand = mark.demand;
+}
+
+// Back to an empty arena that will size itself again on first use
+void releaseFrameArena(FrameArena& arena) {
+    // Freed directly rather than through a reset, which could grow the block only to free it
+    for (void* block : arena.overflow) freeBlock(block);
+    arena.overflow.clear();
+    if (arena.block) freeBlock(arena.block);
+    arena.block = nullptr;
+    arena.capacity = arena.used = arena.demand = arena.peak = 0;
+    arena.overflow.shrink_to_fit();
+}
+
+#ifdef SHADER_ALLOCATION_COUNTER
+
+namespace {
+
+std::atomic<uint64_t> heapAllocations(0);
+
+void* countedAllocate(size_t bytes) {
+    ++heapAllocations;
+    if (void* p = std::malloc(bytes ? bytes : 1)) return p;
+    throw std::bad_alloc();
+}
+
+// The CRT's aligned heap on Windows; C++17 aligned_alloc wants the size rounded to the alignment
+void* countedAllocateAligned(size_t bytes, std::align_val_t alignment) {
+    ++heapAllocations;
+    const size_t align = static_cast<size_t>(alignment);
+    bytes = (std::max<size_t>(bytes, 1) + align - 1) / align * align;
+#ifdef _MSC_VER
+    void* p = _aligned_malloc(bytes, align);
+#else
+    void* p = std::aligned_alloc(align, bytes);
+#endif
+    if (p) return p;
+    throw std::bad_alloc();
+}
+
+void freeAligned(void* p) {
+#ifdef _MSC_VER
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // namespace
+
+// Replacements for the global allocation functions; the nothrow forms forward to these
+void* operator new(size_t bytes) { return countedAllocate(bytes); }
+void* operator new[](size_t bytes) { return countedAllocate(bytes); }
+void* operator new(size_t bytes, std::align_val_t alignment) { return countedAllocateAligned(bytes, alignment); }
+void* operator new[](size_t bytes, std::align_val_t alignment) { return countedAllocateAligned(bytes, alignment); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { freeAligned(p); }
+
+bool heapAllocationsCounted() {
+    return true;
+}
+
+uint64_t heapAllocationCount() {
+    return heapAllocations.load();
+}
+
+#else
+
+bool heapAllocationsCounted() {
+    return false;
+}
+
+uint64_t heapAllocationCount() {
+    return 0;
+}
+
+#endif // SHADER_ALLOCATION_COUNTER
@@ -0,0 +1,106 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Per-frame linear arena: every buffer that only lives for one
+//      frame is bumped off a single block that is reset at the start
+//      of the next one. A frame that outgrows the block spills into
+//      heap overflow blocks, and the next reset replaces the block
+//      with one that fits the high-water mark, so once the view has
+//      settled a frame makes no heap allocations at all.
+//
+//      Debug builds (or SHADER_COUNT_ALLOCATIONS) also count every
+//      global operator new, so the benchmark can verify that claim.
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Every allocation starts on a cache line, so no two buffers share one across worker threads
+const size_t FRAME_ARENA_ALIGNMENT = 64;
+
+struct FrameArena {
+    char* block = nullptr;
+    size_t capacity = 0;
+    size_t used = 0;                    // Bytes bumped off the block this frame
+    size_t demand = 0;                  // Bytes asked for this frame, block and overflow together
+    size_t peak = 0;                    // Largest demand since the block was last sized
+    std::vector<void*> overflow;        // Heap blocks for this frame's requests that did not fit
+
+    // The arena owns its blocks: destroying it releases them, and only moves hand them on
+    FrameArena() = default;
+    ~FrameArena();
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+    FrameArena(FrameArena&& other) noexcept;
+    FrameArena& operator=(FrameArena&& other) noexcept;
+};
+
+// Point in the frame to unwind to, for scratch that dies before the frame does
+struct FrameArenaMark {
+    size_t used;
+    size_t demand;
+    size_t overflow;
+};
+
+// Returns uninitialized storage that stays valid until the next reset
+void* frameAllocate(FrameArena& arena, size_t bytes);
+
+// Frees last frame's overflow, grows the block to the high-water mark if it spilled, and starts over
+void resetFrameArena(FrameArena& arena);
+
+// Records the current fill level
+FrameArenaMark markFrameArena(const FrameArena& arena);
+
+// Releases everything allocated since mark (overflow blocks included), keeping the high-water mark
+void rewindFrameArena(FrameArena& arena, const FrameArenaMark& mark);
+
+// Returns every block to the heap
+void releaseFrameArena(FrameArena& arena);
+
+// Typed wrapper for trivially copyable elements
+template <typename T>
+T* frameAllocate(FrameArena& arena, size_t count) {
+    return static_cast<T*>(frameAllocate(arena, count * sizeof(T)));
+}
+
+// Zero-filled array, for per-element flags and counters
+template <typename T>
+T* frameAllocateZeroed(FrameArena& arena, size_t count) {
+    T* data = frameAllocate<T>(arena, count);
+    for (size_t i = 0; i < count; ++i) data[i] = T();
+    return data;
+}
+
+// Fixed-capacity list in arena storage; the capacity is an upper bound fixed when it is allocated
+template <typename T>
+struct FrameArray {
+    T* data = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+
+    void push_back(const T& value) { data[size++] = value; }
+    bool empty() const { return size == 0; }
+    T& operator[](size_t i) { return data[i]; }
+    const T& operator[](size_t i) const { return data[i]; }
+    T* begin() { return data; }
+    T* end() { return data + size; }
+    const T* begin() const { return data; }
+    const T* end() const { return data + size; }
+};
+
+// Empty list with room for capacity elements
+template <typename T>
+FrameArray<T> frameArray(FrameArena& arena, size_t capacity) {
+    FrameArray<T> array;
+    array.data = frameAllocate<T>(arena, capacity);
+    array.capacity = capacity;
+    return array;
+}
+
+// True if global operator new is being counted in this build
+bool heapAllocationsCounted();
+
+// Calls to global operator new since startup, on every thread; 0 when not counted
+uint64_t heapAllocationCount();
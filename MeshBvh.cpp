@@ -0,0 +1,370 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Bounding Volume Hierarchy
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "MeshBvh.hpp"
+#include "MeshTypes.hpp"
+#include "VertexTransform.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#undef min
+#undef max
+
+namespace {
+
+// Cone slack for rounding between the build and the per-face normal test
+const float CONE_EPSILON = 1e-4f;
+
+// Pixel slack for rounding between the node bounds and the transform kernel
+const float SCREEN_SLACK = 1.0f;
+
+// Per-face data the build sorts and measures; order is the permutation being built
+struct BuildContext {
+    const std::vector<Vertex>& vertices;
+    const std::vector<Face>& faces;
+    std::vector<float> centroids;       // 3 per face
+    std::vector<float> normals;         // 3 per face, zero for degenerate faces
+    std::vector<uint32_t> order;        // Face numbers, partitioned in place into leaf order
+    std::vector<uint32_t> scratch;      // Second half of each stable partition
+    std::vector<std::pair<float, uint32_t>> keys;   // Median search, ties broken by position
+    MeshBvh& bvh;
+};
+
+// Centroid and unit normal of every face, with the order starting out as the identity
+void measureFaces(BuildContext& context) {
+    const std::vector<Vertex>& vertices = context.vertices;
+    const std::vector<Face>& faces = context.faces;
+    for (size_t i = 0; i < faces.size(); ++i) {
+        context.order[i] = static_cast<uint32_t>(i);
+        const Vertex& a = vertices[faces[i].v1 - 1];
+        const Vertex& b = vertices[faces[i].v2 - 1];
+        const Vertex& c = vertices[faces[i].v3 - 1];
+        context.centroids[3 * i] = (a.x + b.x + c.x) / 3;
+        context.centroids[3 * i + 1] = (a.y + b.y + c.y) / 3;
+        context.centroids[3 * i + 2] = (a.z + b.z + c.z) / 3;
+
+        // Double precision keeps tiny faces in large coordinates from cancelling to zero
+        double ux = b.x - a.x, uy = b.y - a.y, uz = b.z - a.z;
+        double vx = c.x - a.x, vy = c.y - a.y, vz = c.z - a.z;
+        double n[3] = { uy * vz - uz * vy, uz * vx - ux * vz, ux * vy - uy * vx };
+        double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        for (int axis = 0; axis < 3; ++axis) {
+            context.normals[3 * i + axis] = length > 0 ? static_cast<float>(n[axis] / length) : 0.0f;
+        }
+    }
+}
+
+// Tight bounds over the corners of order[first, first + count)
+void faceBounds(const BuildContext& context, uint32_t first, uint32_t count, BvhNode& node) {
+    for (int axis = 0; axis < 3; ++axis) {
+        node.boundsMin[axis] = FLT_MAX;
+        node.boundsMax[axis] = -FLT_MAX;
+    }
+    for (uint32_t i = first; i < first + count; ++i) {
+        const Face& f = context.faces[context.order[i]];
+        const Vertex* corners[3] = { &context.vertices[f.v1 - 1], &context.vertices[f.v2 - 1], &context.vertices[f.v3 - 1] };
+        for (const Vertex* v : corners) {
+            const float p[3] = { v->x, v->y, v->z };
+            for (int axis = 0; axis < 3; ++axis) {
+                node.boundsMin[axis] = std::min(node.boundsMin[axis], p[axis]);
+                node.boundsMax[axis] = std::max(node.boundsMax[axis], p[axis]);
+            }
+        }
+    }
+}
+
+// Mean normal as the axis, widest deviation from it as the half-angle
+BvhCone faceCone(const BuildContext& context, uint32_t first, uint32_t count) {
+    BvhCone cone = { { 0, 0, 0 }, 2.0f };
+    double sum[3] = { 0, 0, 0 };
+    for (uint32_t i = first; i < first + count; ++i) {
+        const float* n = &context.normals[3 * context.order[i]];
+        for (int axis = 0; axis < 3; ++axis) sum[axis] += n[axis];
+    }
+    double length = sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+    if (length < 1e-9) return cone;
+    for (int axis = 0; axis < 3; ++axis) cone.axis[axis] = static_cast<float>(sum[axis] / length);
+
+    float minCos = 1;
+    for (uint32_t i = first; i < first + count; ++i) {
+        const float* n = &context.normals[3 * context.order[i]];
+        if (n[0] == 0 && n[1] == 0 && n[2] == 0) continue;
+        minCos = std::min(minCos, cone.axis[0] * n[0] + cone.axis[1] * n[1] + cone.axis[2] * n[2]);
+    }
+
+    // Half-angles of 90 degrees or more can never be entirely behind the viewer
+    if (minCos > 0) cone.cutoff = sqrtf(std::max(0.0f, 1 - minCos * minCos)) + CONE_EPSILON;
+    return cone;
+}
+
+// Moves the half of order[first, first + count) with the lower centroids to the front, keeping the
+// relative order on both sides; position breaks ties so the halves are always exact
+void stableMedianSplit(BuildContext& context, uint32_t first, uint32_t count, int axis) {
+    auto& keys = context.keys;
+    keys.clear();
+    for (uint32_t i = first; i < first + count; ++i) keys.emplace_back(context.centroids[3 * context.order[i] + axis], i);
+    const uint32_t half = count / 2;
+    std::nth_element(keys.begin(), keys.begin() + half, keys.end());
+    const std::pair<float, uint32_t> median = keys[half];
+
+    uint32_t low = first, high = 0;
+    for (uint32_t i = first; i < first + count; ++i) {
+        const uint32_t face = context.order[i];
+        if (std::make_pair(context.centroids[3 * face + axis], i) < median) context.order[low++] = face;
+        else context.scratch[high++] = face;
+    }
+    std::copy(context.scratch.begin(), context.scratch.begin() + high, context.order.begin() + low);
+}
+
+// Appends the node for order[first, first + count) and then its subtrees, depth first
+void buildNode(BuildContext& context, uint32_t first, uint32_t count) {
+    MeshBvh& bvh = context.bvh;
+    const uint32_t index = static_cast<uint32_t>(bvh.nodes.size());
+    bvh.nodes.emplace_back();
+    bvh.cones.push_back(faceCone(context, first, count));
+    faceBounds(context, first, count, bvh.nodes[index]);
+    bvh.nodes[index].count = count;
+
+    // Split along the longest axis of the centroids; coincident centroids cannot be split
+    float lo[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, hi[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (uint32_t i = first; i < first + count; ++i) {
+        const float* c = &context.centroids[3 * context.order[i]];
+        for (int axis = 0; axis < 3; ++axis) {
+            lo[axis] = std::min(lo[axis], c[axis]);
+            hi[axis] = std::max(hi[axis], c[axis]);
+        }
+    }
+    int axis = 0;
+    for (int a = 1; a < 3; ++a) {
+        if (hi[a] - lo[a] > hi[axis] - lo[axis]) axis = a;
+    }
+    if (count <= BVH_LEAF_FACES || !(hi[axis] > lo[axis])) {
+        bvh.nodes[index].offset = first;
+        bvh.nodes[index].count |= BVH_LEAF;
+        return;
+    }
+
+    const uint32_t half = count / 2;
+    stableMedianSplit(context, first, count, axis);
+    buildNode(context, first, half);
+    bvh.nodes[index].offset = static_cast<uint32_t>(bvh.nodes.size());
+    buildNode(context, first + half, count - half);
+}
+
+// Slab test; returns the entry distance, or FLT_MAX on a miss or a box beyond limit
+float rayBox(const BvhNode& node, const float origin[3], const float inverse[3], float limit) {
+    float near = 0, far = limit;
+    for (int axis = 0; axis < 3; ++axis) {
+        float t0 = (node.boundsMin[axis] - origin[axis]) * inverse[axis];
+        float t1 = (node.boundsMax[axis] - origin[axis]) * inverse[axis];
+        if (t0 > t1) std::swap(t0, t1);
+        near = std::max(near, t0);
+        far = std::min(far, t1);
+        if (near > far) return FLT_MAX;
+    }
+    return near;
+}
+
+} // namespace
+
+// Centroids and unit normals first, then one recursive pass that partitions the face order in place
+void buildMeshBvh(const std::vector<Vertex>& vertices, std::vector<Face>& faces, MeshBvh& bvh) {
+    bvh.nodes.clear();
+    bvh.cones.clear();
+    if (faces.empty()) return;
+
+    BuildContext context = { vertices, faces, std::vector<float>(faces.size() * 3), std::vector<float>(faces.size() * 3),
+        std::vector<uint32_t>(faces.size()), std::vector<uint32_t>(faces.size()), {}, bvh };
+    context.keys.reserve(faces.size());
+    measureFaces(context);
+
+    // A balanced tree over F faces has about F / 8 nodes with 16-face leaves
+    bvh.nodes.reserve(faces.size() / 8 + 1);
+    bvh.cones.reserve(faces.size() / 8 + 1);
+    buildNode(context, 0, static_cast<uint32_t>(faces.size()));
+
+    std::vector<Face> reordered(faces.size());
+    for (size_t i = 0; i < faces.size(); ++i) reordered[i] = faces[context.order[i]];
+    faces.swap(reordered);
+}
+
+// Faces are already in leaf order, so the identity order walks the same ranges the build did. A node's
+// range starts where its first child's does, and that child is the next node, so one backward pass finds them.
+void refitMeshBvh(const std::vector<Vertex>& vertices, const std::vector<Face>& faces, MeshBvh& bvh) {
+    if (bvh.nodes.empty()) return;
+    BuildContext context = { vertices, faces, std::vector<float>(faces.size() * 3), std::vector<float>(faces.size() * 3),
+        std::vector<uint32_t>(faces.size()), {}, {}, bvh };
+    measureFaces(context);
+
+    std::vector<uint32_t> first(bvh.nodes.size());
+    for (size_t i = bvh.nodes.size(); i-- > 0;) {
+        BvhNode& node = bvh.nodes[i];
+        first[i] = (node.count & BVH_LEAF) ? node.offset : first[i + 1];
+        const uint32_t count = node.count & ~BVH_LEAF;
+        faceBounds(context, first[i], count, node);
+        bvh.cones[i] = faceCone(context, first[i], count);
+    }
+}
+
+// Translation and a uniform positive scale keep min below max
+void normalizeBvhBounds(MeshBvh& bvh, const ModelFrame& frame) {
+    const float center[3] = { frame.cx, frame.cy, frame.cz };
+    for (BvhNode& node : bvh.nodes) {
+        for (int axis = 0; axis < 3; ++axis) {
+            node.boundsMin[axis] = (node.boundsMin[axis] - center[axis]) / frame.extent;
+            node.boundsMax[axis] = (node.boundsMax[axis] - center[axis]) / frame.extent;
+        }
+    }
+}
+
+// Children must follow their parent, and leaves must stay inside the face list. A stack traversal
+// holds at most one pending sibling per level above the node it is at, and an interior node pushes
+// two children, so one at level d needs d + 2 entries.
+bool validMeshBvh(const MeshBvh& bvh, size_t faceCount) {
+    if (bvh.cones.size() != bvh.nodes.size()) return false;
+    if (faceCount > 0 && bvh.nodes.empty()) return false;
+    std::vector<uint8_t> level(bvh.nodes.size(), 0);
+    for (size_t i = 0; i < bvh.nodes.size(); ++i) {
+        const BvhNode& node = bvh.nodes[i];
+        if (node.count & BVH_LEAF) {
+            const uint64_t count = node.count & ~BVH_LEAF;
+            if (node.offset + count > faceCount) return false;
+        }
+        else if (node.offset <= i + 1 || node.offset >= bvh.nodes.size() || level[i] + 2 > BVH_STACK_SIZE) {
+            return false;
+        }
+        else {
+            level[i + 1] = level[node.offset] = static_cast<uint8_t>(level[i] + 1);
+        }
+    }
+    return true;
+}
+
+// Copy the rotation rows so the traversal needs nothing else
+BvhView makeBvhView(const Matrix3& r, const Projection& p, int width, int height, bool cullBackFaces) {
+    BvhView view;
+    for (int row = 0; row < 3; ++row) {
+        for (int column = 0; column < 3; ++column) view.rows[row][column] = r.m[row][column];
+    }
+    view.scale = p.scale;
+    view.centerX = p.centerX;
+    view.centerY = p.centerY;
+    view.width = static_cast<float>(width);
+    view.height = static_cast<float>(height);
+    view.cullBackFaces = cullBackFaces;
+    return view;
+}
+
+// A rotated box projects to its rotated center plus the absolute-value extent along each screen axis
+BvhVisibility classifyBvhNode(const MeshBvh& bvh, uint32_t index, const BvhView& view) {
+    const BvhNode& node = bvh.nodes[index];
+    float center[3], half[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        center[axis] = 0.5f * (node.boundsMin[axis] + node.boundsMax[axis]);
+        half[axis] = 0.5f * (node.boundsMax[axis] - node.boundsMin[axis]);
+    }
+
+    float screenCenter[2], screenHalf[2];
+    for (int row = 0; row < 2; ++row) {
+        const float* r = view.rows[row];
+        screenCenter[row] = r[0] * center[0] + r[1] * center[1] + r[2] * center[2];
+        screenHalf[row] = (fabsf(r[0]) * half[0] + fabsf(r[1]) * half[1] + fabsf(r[2]) * half[2]) * view.scale + SCREEN_SLACK;
+    }
+    const float x = view.centerX + screenCenter[0] * view.scale;
+    const float y = view.centerY - screenCenter[1] * view.scale;
+    if (x + screenHalf[0] < 0 || y + screenHalf[1] < 0 || x - screenHalf[0] >= view.width || y - screenHalf[1] >= view.height) {
+        return BVH_OFF_SCREEN;
+    }
+
+    // The view-space z of a normal n is dot(n, third rotation row)
+    if (view.cullBackFaces) {
+        const BvhCone& cone = bvh.cones[index];
+        const float* w = view.rows[2];
+        if (cone.axis[0] * w[0] + cone.axis[1] * w[1] + cone.axis[2] * w[2] < -cone.cutoff) return BVH_BACK_FACING;
+    }
+    return BVH_PARTIAL;
+}
+
+// Orthographic ray from in front of the unit sphere straight into the screen, nearest child first
+BvhHit pickBvh(const MeshBvh& bvh, const VertexStream& positions, const std::vector<Face>& faces, const BvhView& view,
+    float x, float y) {
+    BvhHit result;
+    if (bvh.nodes.empty()) return result;
+
+    // View space (vx, vy, 2) looking down -z, taken back to model space with the transposed rotation
+    const float vx = (x - view.centerX) / view.scale, vy = (view.centerY - y) / view.scale;
+    float origin[3], direction[3], inverse[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        origin[axis] = view.rows[0][axis] * vx + view.rows[1][axis] * vy + view.rows[2][axis] * 2.0f;
+        direction[axis] = -view.rows[2][axis];
+        inverse[axis] = fabsf(direction[axis]) > 1e-12f ? 1.0f / direction[axis] : (direction[axis] < 0 ? -1e30f : 1e30f);
+    }
+
+    float best = FLT_MAX;
+    uint32_t stack[BVH_STACK_SIZE];
+    int depth = 0;
+    stack[depth++] = 0;
+    while (depth > 0) {
+        const uint32_t index = stack[--depth];
+        const BvhNode& node = bvh.nodes[index];
+        if (rayBox(node, origin, inverse, best) == FLT_MAX) continue;
+
+        if (!(node.count & BVH_LEAF)) {
+            // Visit the nearer child first so its hits shrink the search for the other
+            const uint32_t first = index + 1, second = node.offset;
+            const float t0 = rayBox(bvh.nodes[first], origin, inverse, best);
+            const float t1 = rayBox(bvh.nodes[second], origin, inverse, best);
+            if (depth + 2 > BVH_STACK_SIZE) continue;
+            if (t0 <= t1) {
+                if (t1 != FLT_MAX) stack[depth++] = second;
+                if (t0 != FLT_MAX) stack[depth++] = first;
+            }
+            else {
+                if (t0 != FLT_MAX) stack[depth++] = first;
+                stack[depth++] = second;
+            }
+            continue;
+        }
+
+        // Moller-Trumbore against each face of the leaf
+        const uint32_t count = node.count & ~BVH_LEAF;
+        for (uint32_t faceNumber = node.offset; faceNumber < node.offset + count; ++faceNumber) {
+            const Face& f = faces[faceNumber];
+            const uint32_t corners[3] = { static_cast<uint32_t>(f.v1 - 1), static_cast<uint32_t>(f.v2 - 1), static_cast<uint32_t>(f.v3 - 1) };
+            const float p0[3] = { positions.x[corners[0]], positions.y[corners[0]], positions.z[corners[0]] };
+            const float e1[3] = { positions.x[corners[1]] - p0[0], positions.y[corners[1]] - p0[1], positions.z[corners[1]] - p0[2] };
+            const float e2[3] = { positions.x[corners[2]] - p0[0], positions.y[corners[2]] - p0[1], positions.z[corners[2]] - p0[2] };
+
+            // Front faces wind counter-clockwise toward the viewer, so their normal opposes the ray
+            const float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            if (view.cullBackFaces && n[0] * direction[0] + n[1] * direction[1] + n[2] * direction[2] >= 0) continue;
+
+            const float h[3] = { direction[1] * e2[2] - direction[2] * e2[1], direction[2] * e2[0] - direction[0] * e2[2],
+                direction[0] * e2[1] - direction[1] * e2[0] };
+            const float det = e1[0] * h[0] + e1[1] * h[1] + e1[2] * h[2];
+            if (fabsf(det) < 1e-12f) continue;
+            const float inv = 1.0f / det;
+            const float s[3] = { origin[0] - p0[0], origin[1] - p0[1], origin[2] - p0[2] };
+            const float u = (s[0] * h[0] + s[1] * h[1] + s[2] * h[2]) * inv;
+            if (u < 0 || u > 1) continue;
+            const float q[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+            const float v = (direction[0] * q[0] + direction[1] * q[1] + direction[2] * q[2]) * inv;
+            if (v < 0 || u + v > 1) continue;
+            const float t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * inv;
+            if (t < 0 || t >= best) continue;
+
+            // The largest barycentric weight names the nearest corner
+            best = t;
+            const float w0 = 1 - u - v;
+            result.hit = true;
+            result.face = faceNumber;
+            result.vertex = w0 >= u && w0 >= v ? corners[0] : (u >= v ? corners[1] : corners[2]);
+            result.distance = t;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,105 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Bounding volume hierarchy over the faces of one detail
+//      level. Nodes are 32 bytes and stored depth first, so a
+//      node's first child is the next node and traversal walks
+//      memory forwards. The build reorders the faces themselves
+//      into leaf order, so every leaf, and every subtree, is one
+//      contiguous run of the face list. Each node also carries a
+//      normal cone, which lets the cull pass reject a whole
+//      cluster of faces once they all point away from the viewer.
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Vertex;
+struct Face;
+struct VertexStream;
+struct Matrix3;
+struct Projection;
+struct ModelFrame;
+
+// Leaves hold at most this many faces
+const uint32_t BVH_LEAF_FACES = 16;
+
+// Set in BvhNode::count for leaves
+const uint32_t BVH_LEAF = 0x80000000u;
+
+// Entries in the fixed stacks the traversals use; a median-split build over 2^32 faces stays well inside it
+const int BVH_STACK_SIZE = 64;
+
+// One node; the first child of an interior node is the node right after it
+struct BvhNode {
+    float boundsMin[3];
+    float boundsMax[3];
+    uint32_t offset;    // Leaf: first face; interior: index of the second child
+    uint32_t count;     // Faces under the node, plus BVH_LEAF for leaves
+};
+static_assert(sizeof(BvhNode) == 32, "BvhNode must stay one half cache line");
+
+// Normals of a node's faces lie within the cone around axis. The cluster faces entirely away
+// from a view direction w when dot(axis, w) < -cutoff; cutoff > 1 means it never does.
+struct BvhCone {
+    float axis[3];
+    float cutoff;
+};
+
+// Hierarchy for one face list; cones run parallel to nodes
+struct MeshBvh {
+    std::vector<BvhNode> nodes;
+    std::vector<BvhCone> cones;
+};
+
+// Verdict of the per-node cull test
+enum BvhVisibility {
+    BVH_OFF_SCREEN,     // Bounds project entirely outside the frame
+    BVH_BACK_FACING,    // Every face in the cluster faces away from the viewer
+    BVH_PARTIAL         // Faces have to be tested one by one
+};
+
+// Frame-constant inputs for classifyBvhNode
+struct BvhView {
+    float rows[3][3];       // Rotation, as applied to the normalized positions
+    float scale;            // Projection, as in applyTransform
+    float centerX, centerY;
+    float width, height;    // Frame size in pixels
+    bool cullBackFaces;     // False skips the cone test
+};
+
+// Nearest hit of a pick ray
+struct BvhHit {
+    bool hit = false;
+    uint32_t face = 0;      // 0-based face number
+    uint32_t vertex = 0;    // 0-based vertex number of the corner nearest the hit point
+    float distance = 0;     // Along the ray, in normalized model units
+};
+
+// Builds the hierarchy by median splits along the longest centroid axis and reorders faces into leaf order.
+// The splits are stable, so faces keep their relative order within a leaf (and any cache-friendly layout with it).
+void buildMeshBvh(const std::vector<Vertex>& vertices, std::vector<Face>& faces, MeshBvh& bvh);
+
+// Recomputes every node's bounds and cone for moved vertices, keeping the tree, and the face order built for it.
+// The faces must be the leaf-ordered list the hierarchy was built with; bounds come out in model coordinates.
+void refitMeshBvh(const std::vector<Vertex>& vertices, const std::vector<Face>& faces, MeshBvh& bvh);
+
+// Maps node bounds from model coordinates into the normalized frame (centered, unit extent)
+void normalizeBvhBounds(MeshBvh& bvh, const ModelFrame& frame);
+
+// Checks that every child index and leaf range is in range and that no node is too deep for a
+// BVH_STACK_SIZE traversal; used on data read from the cache
+bool validMeshBvh(const MeshBvh& bvh, size_t faceCount);
+
+// Fills a BvhView for a rotation, projection and frame size
+BvhView makeBvhView(const Matrix3& r, const Projection& p, int width, int height, bool cullBackFaces);
+
+// Tests one node's bounds and cone against the view
+BvhVisibility classifyBvhNode(const MeshBvh& bvh, uint32_t node, const BvhView& view);
+
+// Casts the view ray through pixel (x, y) into the normalized mesh and returns the nearest face it hits.
+// Back faces are skipped when the view culls them, since they are never drawn.
+BvhHit pickBvh(const MeshBvh& bvh, const VertexStream& positions, const std::vector<Face>& faces, const BvhView& view,
+    float x, float y);
@@ -0,0 +1,419 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Binary Mesh Cache
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "MeshCache.hpp"
+#include "MeshBvh.hpp"
+#include "MeshLoader.hpp"
+#include "MeshLod.hpp"
+#include "MeshOptimize.hpp"
+#include "MeshTypes.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+static_assert(sizeof(Face) == 3 * sizeof(uint32_t), "Face must match the packed index layout");
+static_assert(sizeof(MeshCacheHeader) == 64, "MeshCacheHeader layout changed; bump MESH_CACHE_VERSION");
+
+namespace {
+
+const char MESH_CACHE_MAGIC[4] = { '3', 'D', 'M', 'C' };
+
+// Section payloads start on 32-byte boundaries so mapped data is SIMD-aligned
+const uint64_t SECTION_ALIGNMENT = 32;
+
+uint64_t alignSection(uint64_t offset) {
+    return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+// Zero padding up to the next section boundary
+bool writePadding(OutputFile& file, uint64_t& position) {
+    static const char zeros[SECTION_ALIGNMENT] = {};
+    uint64_t aligned = alignSection(position);
+    bool ok = writeOutputFile(file, zeros, static_cast<size_t>(aligned - position));
+    position = aligned;
+    return ok;
+}
+
+// Locate a section in the mapped table, validating that it lies inside the file
+const MeshCacheSection* findSection(const MappedFile& mapped, const MeshCacheHeader& header, uint32_t id) {
+    const MeshCacheSection* table = reinterpret_cast<const MeshCacheSection*>(mapped.data + sizeof(MeshCacheHeader));
+    for (uint32_t i = 0; i < header.sectionCount; ++i) {
+        const MeshCacheSection& section = table[i];
+        if (section.id != id) continue;
+        if (section.offset > mapped.size || section.size > mapped.size - section.offset) return nullptr;
+        return &section;
+    }
+    return nullptr;
+}
+
+// Every index of a face list must name one of vertexCount vertices
+bool facesInRange(const std::vector<Face>& faces, uint32_t vertexCount) {
+    const int count = static_cast<int>(vertexCount);
+    for (const auto& f : faces) {
+        if (f.v1 < 1 || f.v2 < 1 || f.v3 < 1 || f.v1 > count || f.v2 > count || f.v3 > count) return false;
+    }
+    return true;
+}
+
+// Bytes per stored index for a level of vertexCount vertices
+uint64_t indexSize(uint32_t flags, uint64_t vertexCount) {
+    return (flags & MESH_CACHE_COMPACT) && vertexCount <= COMPACT_INDEX_LIMIT ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+// Positions without ids, as full-precision floats even in a compact cache: the renderer quantizes each level
+// once, within its own bounds, after deriving normals from these
+void encodePositions(const std::vector<Vertex>& vertices, char* out) {
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        const float p[3] = { vertices[i].x, vertices[i].y, vertices[i].z };
+        memcpy(out + 3 * sizeof(float) * i, p, sizeof(p));
+    }
+}
+
+// Inverse of encodePositions; vertex ids are positional, so they are rebuilt rather than stored
+void decodePositions(const char* data, uint32_t count, std::vector<Vertex>& vertices) {
+    vertices.resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        float p[3];
+        memcpy(p, data + 3 * sizeof(float) * i, sizeof(p));
+        vertices[i] = { static_cast<int>(i + 1), p[0], p[1], p[2] };
+    }
+}
+
+// Faces in 32 bits, or 16 when the level is small enough
+void encodeFaces(const std::vector<Face>& faces, uint64_t width, char* out) {
+    if (width == sizeof(uint32_t)) {
+        if (!faces.empty()) memcpy(out, faces.data(), faces.size() * sizeof(Face));
+        return;
+    }
+    for (size_t i = 0; i < faces.size(); ++i) {
+        const uint16_t v[3] = { static_cast<uint16_t>(faces[i].v1), static_cast<uint16_t>(faces[i].v2), static_cast<uint16_t>(faces[i].v3) };
+        memcpy(out + i * sizeof(v), v, sizeof(v));
+    }
+}
+
+// Inverse of encodeFaces
+void decodeFaces(const char* data, uint32_t count, uint64_t width, std::vector<Face>& faces) {
+    faces.resize(count);
+    if (width == sizeof(uint32_t)) {
+        if (count) memcpy(faces.data(), data, count * sizeof(Face));
+        return;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        uint16_t v[3];
+        memcpy(v, data + i * sizeof(v), sizeof(v));
+        faces[i] = { v[0], v[1], v[2] };
+    }
+}
+
+// Positions plus faces of one level in the section encoding
+void appendLevel(std::vector<char>& payload, const MeshCacheHeader& header, const std::vector<Vertex>& vertices,
+    const std::vector<Face>& faces) {
+    const size_t offset = payload.size();
+    const uint64_t positionBytes = 3 * sizeof(float) * vertices.size();
+    const uint64_t width = indexSize(header.flags, vertices.size());
+    payload.resize(offset + static_cast<size_t>(positionBytes + 3 * width * faces.size()));
+    encodePositions(vertices, payload.data() + offset);
+    encodeFaces(faces, width, payload.data() + offset + positionBytes);
+}
+
+// Serialize the LOD chain into one SECTION_LOD payload
+std::vector<char> packLodChain(const std::vector<LodLevel>& lods, const MeshCacheHeader& header) {
+    std::vector<char> payload(sizeof(uint32_t) + lods.size() * sizeof(MeshCacheLodLevel));
+    uint32_t levelCount = static_cast<uint32_t>(lods.size());
+    memcpy(payload.data(), &levelCount, sizeof(levelCount));
+    for (size_t i = 0; i < lods.size(); ++i) {
+        MeshCacheLodLevel entry = { static_cast<uint32_t>(lods[i].vertices.size()), static_cast<uint32_t>(lods[i].faces.size()) };
+        memcpy(payload.data() + sizeof(uint32_t) + i * sizeof(entry), &entry, sizeof(entry));
+    }
+    for (const auto& level : lods) appendLevel(payload, header, level.vertices, level.faces);
+    return payload;
+}
+
+// Inverse of packLodChain, checking every size and index against the payload
+bool unpackLodChain(const char* data, uint64_t size, const MeshCacheHeader& header, std::vector<LodLevel>& lods) {
+    lods.clear();
+    uint32_t levelCount;
+    if (size < sizeof(levelCount)) return false;
+    memcpy(&levelCount, data, sizeof(levelCount));
+    if (levelCount > (size - sizeof(levelCount)) / sizeof(MeshCacheLodLevel)) return false;
+
+    const char* table = data + sizeof(levelCount);
+    uint64_t offset = sizeof(levelCount) + static_cast<uint64_t>(levelCount) * sizeof(MeshCacheLodLevel);
+    lods.resize(levelCount);
+    for (uint32_t i = 0; i < levelCount; ++i) {
+        MeshCacheLodLevel entry;
+        memcpy(&entry, table + i * sizeof(entry), sizeof(entry));
+        const uint64_t positionBytes = 3 * sizeof(float) * entry.vertexCount;
+        const uint64_t width = indexSize(header.flags, entry.vertexCount);
+        const uint64_t faceBytes = 3 * width * entry.faceCount;
+        if (positionBytes + faceBytes > size - offset) return false;
+
+        LodLevel& level = lods[i];
+        decodePositions(data + offset, entry.vertexCount, level.vertices);
+        decodeFaces(data + offset + positionBytes, entry.faceCount, width, level.faces);
+        if (!facesInRange(level.faces, entry.vertexCount)) return false;
+        offset += positionBytes + faceBytes;
+    }
+    return true;
+}
+
+// Serialize one hierarchy per level into the SECTION_BVH payload; faceCounts records what each one indexes
+std::vector<char> packBvhs(const std::vector<MeshBvh>& bvhs, const std::vector<size_t>& faceCounts) {
+    size_t size = sizeof(uint32_t) + bvhs.size() * sizeof(MeshCacheBvhLevel);
+    for (const auto& bvh : bvhs) {
+        size += bvh.nodes.size() * (sizeof(BvhNode) + sizeof(BvhCone));
+    }
+    std::vector<char> payload(size);
+    char* out = payload.data();
+    auto append = [&](const void* data, size_t bytes) {
+        if (bytes) memcpy(out, data, bytes);
+        out += bytes;
+    };
+
+    uint32_t levelCount = static_cast<uint32_t>(bvhs.size());
+    append(&levelCount, sizeof(levelCount));
+    for (size_t i = 0; i < bvhs.size(); ++i) {
+        MeshCacheBvhLevel entry = { static_cast<uint32_t>(bvhs[i].nodes.size()), static_cast<uint32_t>(faceCounts[i]) };
+        append(&entry, sizeof(entry));
+    }
+    for (const auto& bvh : bvhs) {
+        append(bvh.nodes.data(), bvh.nodes.size() * sizeof(BvhNode));
+        append(bvh.cones.data(), bvh.cones.size() * sizeof(BvhCone));
+    }
+    return payload;
+}
+
+// Inverse of packBvhs; each level must match the face count of the geometry it indexes
+bool unpackBvhs(const char* data, uint64_t size, const std::vector<size_t>& faceCounts, std::vector<MeshBvh>& bvhs) {
+    bvhs.clear();
+    uint32_t levelCount;
+    if (size < sizeof(levelCount)) return false;
+    memcpy(&levelCount, data, sizeof(levelCount));
+    if (levelCount != faceCounts.size() || levelCount > (size - sizeof(levelCount)) / sizeof(MeshCacheBvhLevel)) return false;
+
+    const char* table = data + sizeof(levelCount);
+    uint64_t offset = sizeof(levelCount) + static_cast<uint64_t>(levelCount) * sizeof(MeshCacheBvhLevel);
+    bvhs.resize(levelCount);
+    for (uint32_t i = 0; i < levelCount; ++i) {
+        MeshCacheBvhLevel entry;
+        memcpy(&entry, table + i * sizeof(entry), sizeof(entry));
+        const uint64_t nodeBytes = static_cast<uint64_t>(entry.nodeCount) * sizeof(BvhNode);
+        const uint64_t coneBytes = static_cast<uint64_t>(entry.nodeCount) * sizeof(BvhCone);
+        if (entry.faceCount != faceCounts[i] || nodeBytes + coneBytes > size - offset) return false;
+
+        MeshBvh& bvh = bvhs[i];
+        bvh.nodes.resize(entry.nodeCount);
+        bvh.cones.resize(entry.nodeCount);
+        if (nodeBytes) memcpy(bvh.nodes.data(), data + offset, static_cast<size_t>(nodeBytes));
+        if (coneBytes) memcpy(bvh.cones.data(), data + offset + nodeBytes, static_cast<size_t>(coneBytes));
+        if (!validMeshBvh(bvh, faceCounts[i])) return false;
+        offset += nodeBytes + coneBytes;
+    }
+    return true;
+}
+
+// Hierarchy for each LOD level into bvhs[1] onwards, then the level's vertices renumbered by first use
+void buildLodHierarchies(std::vector<LodLevel>& lods, std::vector<MeshBvh>& bvhs) {
+    for (size_t i = 0; i < lods.size(); ++i) {
+        buildMeshBvh(lods[i].vertices, lods[i].faces, bvhs[i + 1]);
+        reorderVerticesByFirstUse(lods[i].vertices, lods[i].faces);
+    }
+}
+
+} // namespace
+
+// object.txt -> object.txt.mesh
+std::string meshCachePath(const char* sourcePath) {
+    return std::string(sourcePath) + ".mesh";
+}
+
+// Validate the header and copy the geometry sections straight out of the mapping
+bool readMeshCache(const char* cachePath, const FileStamp& source, uint32_t flags, std::vector<Vertex>& vertices,
+    std::vector<Face>& faces, std::vector<LodLevel>& lods, std::vector<MeshBvh>& bvhs) {
+    MappedFile mapped;
+    if (!openMappedFile(cachePath, mapped)) return false;
+
+    bool ok = false;
+    MeshCacheHeader header;
+    if (mapped.size >= sizeof(header)) {
+        memcpy(&header, mapped.data, sizeof(header));
+        ok = memcmp(header.magic, MESH_CACHE_MAGIC, sizeof(header.magic)) == 0
+            && header.version == MESH_CACHE_VERSION
+            && header.source.size == source.size
+            && header.source.writeTime == source.writeTime
+            && header.flags == flags
+            && header.sectionCount <= (mapped.size - sizeof(header)) / sizeof(MeshCacheSection);
+    }
+
+    const MeshCacheSection* vertexSection = ok ? findSection(mapped, header, SECTION_VERTICES) : nullptr;
+    const MeshCacheSection* faceSection = ok ? findSection(mapped, header, SECTION_FACES) : nullptr;
+    const MeshCacheSection* lodSection = ok ? findSection(mapped, header, SECTION_LOD) : nullptr;
+    const MeshCacheSection* bvhSection = ok ? findSection(mapped, header, SECTION_BVH) : nullptr;
+    const uint64_t width = ok ? indexSize(header.flags, header.vertexCount) : 0;
+    ok = vertexSection && faceSection && lodSection && bvhSection
+        && vertexSection->size == 3 * sizeof(float) * header.vertexCount
+        && faceSection->size == 3 * width * header.faceCount;
+
+    if (ok) {
+        decodePositions(mapped.data + vertexSection->offset, header.vertexCount, vertices);
+        decodeFaces(mapped.data + faceSection->offset, header.faceCount, width, faces);
+
+        // A corrupt index would crash the renderer; reject the cache and let the caller reparse
+        ok = facesInRange(faces, header.vertexCount)
+            && unpackLodChain(mapped.data + lodSection->offset, lodSection->size, header, lods);
+    }
+    if (ok) {
+        std::vector<size_t> faceCounts(1, faces.size());
+        for (const auto& level : lods) faceCounts.push_back(level.faces.size());
+        ok = unpackBvhs(mapped.data + bvhSection->offset, bvhSection->size, faceCounts, bvhs);
+    }
+
+    closeMappedFile(mapped);
+    return ok;
+}
+
+// Write header, section table and payloads to a temporary file, then move it over the cache
+bool writeMeshCache(const char* cachePath, const FileStamp& source, uint32_t flags, const std::vector<Vertex>& vertices,
+    const std::vector<Face>& faces, const std::vector<LodLevel>& lods, const std::vector<MeshBvh>& bvhs) {
+    MeshCacheHeader header = {};
+    memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(header.magic));
+    header.version = MESH_CACHE_VERSION;
+    header.source = source;
+    header.vertexCount = static_cast<uint32_t>(vertices.size());
+    header.faceCount = static_cast<uint32_t>(faces.size());
+    header.sectionCount = 4;
+    header.flags = flags;
+
+    // Bounds of the full-detail positions; LOD positions are averages of them, so they fall inside as well
+    for (int axis = 0; axis < 3; ++axis) {
+        header.boundsMin[axis] = vertices.empty() ? 0 : FLT_MAX;
+        header.boundsMax[axis] = vertices.empty() ? 0 : -FLT_MAX;
+    }
+    for (const auto& v : vertices) {
+        const float p[3] = { v.x, v.y, v.z };
+        for (int axis = 0; axis < 3; ++axis) {
+            if (p[axis] < header.boundsMin[axis]) header.boundsMin[axis] = p[axis];
+            if (p[axis] > header.boundsMax[axis]) header.boundsMax[axis] = p[axis];
+        }
+    }
+
+    // Pack positions (without the id field) and faces in the flags' encoding
+    std::vector<char> positions(static_cast<size_t>(3 * sizeof(float) * vertices.size()));
+    encodePositions(vertices, positions.data());
+    std::vector<char> packedFaces(static_cast<size_t>(3 * indexSize(flags, vertices.size()) * faces.size()));
+    encodeFaces(faces, indexSize(flags, vertices.size()), packedFaces.data());
+
+    std::vector<char> lodPayload = packLodChain(lods, header);
+    std::vector<size_t> faceCounts(1, faces.size());
+    for (const auto& level : lods) faceCounts.push_back(level.faces.size());
+    std::vector<char> bvhPayload = packBvhs(bvhs, faceCounts);
+
+    MeshCacheSection sections[4] = {};
+    sections[0].id = SECTION_VERTICES;
+    sections[0].size = positions.size();
+    sections[0].offset = alignSection(sizeof(header) + sizeof(sections));
+    sections[1].id = SECTION_FACES;
+    sections[1].size = packedFaces.size();
+    sections[1].offset = alignSection(sections[0].offset + sections[0].size);
+    sections[2].id = SECTION_LOD;
+    sections[2].size = lodPayload.size();
+    sections[2].offset = alignSection(sections[1].offset + sections[1].size);
+    sections[3].id = SECTION_BVH;
+    sections[3].size = bvhPayload.size();
+    sections[3].offset = alignSection(sections[2].offset + sections[2].size);
+
+    std::string tempPath = std::string(cachePath) + ".tmp";
+    OutputFile file;
+    if (!createOutputFile(tempPath.c_str(), file)) return false;
+
+    uint64_t position = sizeof(header) + sizeof(sections);
+    bool ok = writeOutputFile(file, &header, sizeof(header))
+        && writeOutputFile(file, sections, sizeof(sections))
+        && writePadding(file, position)
+        && writeOutputFile(file, positions.data(), static_cast<size_t>(sections[0].size));
+    position += sections[0].size;
+    ok = ok && writePadding(file, position)
+        && writeOutputFile(file, packedFaces.data(), packedFaces.size());
+    position += sections[1].size;
+    ok = ok && writePadding(file, position)
+        && writeOutputFile(file, lodPayload.data(), lodPayload.size());
+    position += sections[2].size;
+    ok = ok && writePadding(file, position)
+        && writeOutputFile(file, bvhPayload.data(), bvhPayload.size());
+    closeOutputFile(file);
+
+    if (!ok || !replaceFile(tempPath.c_str(), cachePath)) {
+        removeFile(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+// One flag per option that changes what the cache holds
+uint32_t meshCacheFlags(bool optimizeLayout, bool compact) {
+    uint32_t flags = 0;
+    if (optimizeLayout) flags |= MESH_CACHE_OPTIMIZED_LAYOUT;
+    if (compact) flags |= MESH_CACHE_COMPACT;
+    return flags;
+}
+
+// The hierarchies come last because they reorder faces into leaf order. Their splits are stable, so an
+// optimized order survives within each leaf; renumbering afterwards keeps vertex access sequential.
+MeshLayoutStats buildDerivedMeshData(std::vector<Vertex>& vertices, std::vector<Face>& faces, std::vector<LodLevel>& lods,
+    std::vector<MeshBvh>& bvhs, bool optimizeLayout, std::vector<uint32_t>* vertexSource) {
+    if (vertexSource) {
+        vertexSource->resize(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i) (*vertexSource)[i] = static_cast<uint32_t>(i);
+    }
+    MeshLayoutStats stats;
+    if (optimizeLayout) stats = optimizeMeshLayout(vertices, faces, vertexSource);
+    buildLodChain(vertices, faces, lods);
+    if (optimizeLayout) {
+        for (LodLevel& level : lods) optimizeMeshLayout(level.vertices, level.faces);
+    }
+
+    // Full detail first, then the chain in order, matching the SECTION_BVH level order
+    bvhs.resize(lods.size() + 1);
+    buildMeshBvh(vertices, faces, bvhs[0]);
+    reorderVerticesByFirstUse(vertices, faces, vertexSource);
+    buildLodHierarchies(lods, bvhs);
+    if (optimizeLayout) stats.acmrAfter = averageCacheMissRatio(faces, vertices.size());
+    return stats;
+}
+
+// Same steps in the same order as the full build; the chain is simplified from the pre-hierarchy order,
+// and the layout pass depends on topology alone, so it lands where the full build's did
+void buildLodLevels(std::vector<Vertex>& vertices, std::vector<Face>& faces, std::vector<LodLevel>& lods,
+    std::vector<MeshBvh>& bvhs, bool optimizeLayout) {
+    if (optimizeLayout) optimizeMeshLayout(vertices, faces);
+    buildLodChain(vertices, faces, lods);
+    if (optimizeLayout) {
+        for (LodLevel& level : lods) optimizeMeshLayout(level.vertices, level.faces);
+    }
+    bvhs.resize(lods.size() + 1);
+    buildLodHierarchies(lods, bvhs);
+}
+
+// Prefer the binary cache; rebuild it from the text file when missing or stale
+bool loadMeshCached(const char* sourcePath, std::vector<Vertex>& vertices, std::vector<Face>& faces, std::vector<LodLevel>& lods,
+    std::vector<MeshBvh>& bvhs, bool optimizeLayout, bool compact, MeshLayoutStats* layout) {
+    FileStamp stamp;
+    if (!getFileStamp(sourcePath, stamp)) return false;
+
+    // The cache is only reused if it was written with the same layout and encoding; otherwise it is rebuilt
+    const uint32_t flags = meshCacheFlags(optimizeLayout, compact);
+    std::string cachePath = meshCachePath(sourcePath);
+    if (readMeshCache(cachePath.c_str(), stamp, flags, vertices, faces, lods, bvhs)) return true;
+
+    if (!loadMeshFileParallel(sourcePath, vertices, faces)) return false;
+    MeshLayoutStats stats = buildDerivedMeshData(vertices, faces, lods, bvhs, optimizeLayout);
+    if (layout) *layout = stats;
+
+    // Best effort: a read-only directory just means the next launch parses again
+    writeMeshCache(cachePath.c_str(), stamp, flags, vertices, faces, lods, bvhs);
+    return true;
+}
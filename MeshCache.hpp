@@ -0,0 +1,119 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Binary mesh cache: a versioned, memory-mappable snapshot of
+//      a parsed object.txt, written next to the text file and
+//      reused until the text file's size or timestamp changes.
+//
+//      Mapping only replaces parsing: readMeshCache decodes every
+//      section out of the mapped file and copies it into the
+//      std::vector streams the renderer owns, then unmaps. The
+//      mesh is never drawn from the mapped pages themselves.
+//
+//      Layout (little-endian):
+//          MeshCacheHeader
+//          MeshCacheSection[sectionCount]
+//          section payloads, each aligned to 32 bytes
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "MeshLoader.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct Vertex;
+struct Face;
+struct LodLevel;
+struct MeshBvh;
+struct MeshLayoutStats;
+
+// Bump whenever the layout of any section changes
+const uint32_t MESH_CACHE_VERSION = 4;
+
+// A compact cache stores a level's indices in 16 bits when its vertex count is at most this (1-based)
+const uint32_t COMPACT_INDEX_LIMIT = 65535;
+
+// Section identifiers. A compact cache (MESH_CACHE_COMPACT) stores the faces of every level with at most
+// COMPACT_INDEX_LIMIT vertices as uint16_t. Positions stay float in every cache, so the renderer quantizes
+// each level exactly once, within that level's own bounds.
+enum MeshCacheSectionId : uint32_t {
+    SECTION_VERTICES = 1,   // float[3 * vertexCount], packed x, y, z
+    SECTION_FACES = 2,      // uint32_t[3 * faceCount], 1-based vertex indices
+    SECTION_LOD = 3,        // MeshCacheLodLevel[levelCount] table, then each level's positions and faces
+    SECTION_BVH = 4         // MeshCacheBvhLevel[levelCount] table, then each level's nodes, cones and face order
+};
+
+// Header flags recording how the cached geometry was prepared
+enum MeshCacheFlags : uint32_t {
+    MESH_CACHE_OPTIMIZED_LAYOUT = 1,  // Faces and vertices were reordered by optimizeMeshLayout
+    MESH_CACHE_COMPACT = 2            // 16-bit indices where they fit
+};
+
+// Fixed-size file header
+struct MeshCacheHeader {
+    char magic[4];            // "3DMC"
+    uint32_t version;         // MESH_CACHE_VERSION
+    FileStamp source;         // Stamp of the text file this cache mirrors
+    uint32_t vertexCount;
+    uint32_t faceCount;
+    float boundsMin[3];       // Axis-aligned bounds of the vertex positions
+    float boundsMax[3];
+    uint32_t sectionCount;    // Entries in the section table that follows
+    uint32_t flags;           // MeshCacheFlags
+};
+
+// Section table entry
+struct MeshCacheSection {
+    uint32_t id;              // MeshCacheSectionId
+    uint32_t reserved;
+    uint64_t offset;          // Byte offset from the start of the file
+    uint64_t size;            // Payload size in bytes
+};
+
+// Head of the SECTION_LOD payload: a uint32_t level count, then one entry per level, finest first.
+// Level data follows the table in order, each level as float[3 * vertexCount] then uint32_t[3 * faceCount],
+// or uint16_t indices in the compact encoding.
+struct MeshCacheLodLevel {
+    uint32_t vertexCount;
+    uint32_t faceCount;
+};
+
+// Head of the SECTION_BVH payload: a uint32_t level count (full detail, then each LOD level), then one entry
+// per level. Level data follows in order as BvhNode[nodeCount] then BvhCone[nodeCount].
+struct MeshCacheBvhLevel {
+    uint32_t nodeCount;
+    uint32_t faceCount;     // Faces of the level the hierarchy was built for
+};
+
+// Returns the cache path that sits next to a source text file
+std::string meshCachePath(const char* sourcePath);
+
+// Maps a cache file and copies its geometry, LOD chain and hierarchies out; fails if it is missing, corrupt,
+// built from another source or prepared with other flags
+bool readMeshCache(const char* cachePath, const FileStamp& source, uint32_t flags, std::vector<Vertex>& vertices,
+    std::vector<Face>& faces, std::vector<LodLevel>& lods, std::vector<MeshBvh>& bvhs);
+
+// Writes a cache file atomically (temporary file, then rename)
+bool writeMeshCache(const char* cachePath, const FileStamp& source, uint32_t flags, const std::vector<Vertex>& vertices,
+    const std::vector<Face>& faces, const std::vector<LodLevel>& lods, const std::vector<MeshBvh>& bvhs);
+
+// Header flags for a cache prepared with these options
+uint32_t meshCacheFlags(bool optimizeLayout, bool compact);
+
+// Builds everything the cache stores beyond the parsed text: the optional layout pass, the LOD chain and one
+// hierarchy per level (full detail first). Faces end up in leaf order and vertices in first-use order;
+// vertexSource, if given, receives the parsed index of every vertex in that order.
+MeshLayoutStats buildDerivedMeshData(std::vector<Vertex>& vertices, std::vector<Face>& faces, std::vector<LodLevel>& lods,
+    std::vector<MeshBvh>& bvhs, bool optimizeLayout, std::vector<uint32_t>* vertexSource = nullptr);
+
+// The LOD part of buildDerivedMeshData on its own, from the parsed mesh: each level in bvhs[1] onwards comes out
+// as that would build it, laid out and with its hierarchy. The mesh is consumed; bvhs[0] is left to the caller.
+void buildLodLevels(std::vector<Vertex>& vertices, std::vector<Face>& faces, std::vector<LodLevel>& lods,
+    std::vector<MeshBvh>& bvhs, bool optimizeLayout);
+
+// Loads a mesh, its LOD chain and a BVH per level from the binary cache when fresh; otherwise parses the text,
+// optionally optimizes the layout of the mesh and every level, builds the chain and hierarchies and refreshes
+// the cache, compact if asked. layout, if given, receives the miss ratios of a pass run during this call.
+bool loadMeshCached(const char* sourcePath, std::vector<Vertex>& vertices, std::vector<Face>& faces, std::vector<LodLevel>& lods,
+    std::vector<MeshBvh>& bvhs, bool optimizeLayout = false, bool compact = false, MeshLayoutStats* layout = nullptr);
@@ -0,0 +1,712 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Out-of-Core Chunks
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "MeshChunks.hpp"
+#include "MeshLod.hpp"
+#include "MeshOptimize.hpp"
+#include "Profiler.hpp"
+#include "RenderCore.hpp"
+#include "3DShaderViewer.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <queue>
+
+#undef min
+#undef max
+
+static_assert(sizeof(MeshChunkHeader) == 64, "MeshChunkHeader layout changed; bump MESH_CHUNK_VERSION");
+static_assert(sizeof(MeshChunkInfo) == 144, "MeshChunkInfo layout changed; bump MESH_CHUNK_VERSION");
+
+namespace {
+
+const char MESH_CHUNK_MAGIC[4] = { '3', 'D', 'M', 'K' };
+
+// Appended to a source path by meshChunkPath
+const char CHUNK_EXTENSION[] = ".chunks";
+
+// Level payloads start on 32-byte boundaries so mapped positions are SIMD-aligned
+const uint64_t LEVEL_ALIGNMENT = 32;
+
+// Faces buffered per chunk before they are written to the chunk's run of the temporary file
+const size_t BUCKET_FLUSH_FACES = 1024;
+
+// Clustered levels stop once they fall below this many faces
+const size_t CHUNK_FLOOR_FACES = 64;
+
+// Each clustered level aims for this fraction of the previous level's faces, within the tolerance factor
+const double LEVEL_REDUCTION = 0.25;
+const double TARGET_TOLERANCE = 1.4;
+const int MAX_RESOLUTION_ATTEMPTS = 3;
+
+uint64_t alignLevel(uint64_t offset) {
+    return (offset + LEVEL_ALIGNMENT - 1) / LEVEL_ALIGNMENT * LEVEL_ALIGNMENT;
+}
+
+// WriteFile and ReadFile take DWORD lengths, so large buffers go in pieces
+bool writeAll(HANDLE file, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        DWORD chunk = size > 0x40000000 ? 0x40000000 : static_cast<DWORD>(size);
+        DWORD written = 0;
+        if (!WriteFile(file, p, chunk, &written, nullptr) || written == 0) return false;
+        p += written;
+        size -= written;
+    }
+    return true;
+}
+
+bool readAll(HANDLE file, void* data, size_t size) {
+    char* p = static_cast<char*>(data);
+    while (size > 0) {
+        DWORD chunk = size > 0x40000000 ? 0x40000000 : static_cast<DWORD>(size);
+        DWORD read = 0;
+        if (!ReadFile(file, p, chunk, &read, nullptr) || read == 0) return false;
+        p += read;
+        size -= read;
+    }
+    return true;
+}
+
+bool seekTo(HANDLE file, uint64_t position) {
+    LARGE_INTEGER distance;
+    distance.QuadPart = static_cast<LONGLONG>(position);
+    return SetFilePointerEx(file, distance, nullptr, FILE_BEGIN) != 0;
+}
+
+// Source text mapped for the build, with the parsed positions and where the face lines start
+struct SourceMesh {
+    MappedFile mapped;
+    TextCursor faceLines;
+    int vertexCount = 0;
+    int faceCount = 0;
+    std::vector<float> positions;   // 3 per vertex
+    float boundsMin[3], boundsMax[3];
+};
+
+// Header and vertex lines, keeping only the positions
+bool parseSourcePositions(SourceMesh& source) {
+    TextCursor cursor = { source.mapped.data, source.mapped.data + source.mapped.size };
+    if (!parseHeader(cursor, source.vertexCount, source.faceCount)) return false;
+
+    source.positions.resize(3 * static_cast<size_t>(source.vertexCount));
+    for (int axis = 0; axis < 3; ++axis) {
+        source.boundsMin[axis] = FLT_MAX;
+        source.boundsMax[axis] = -FLT_MAX;
+    }
+    for (int i = 0; i < source.vertexCount; ++i) {
+        skipBlankLines(cursor);
+        int id;
+        float* p = &source.positions[3 * static_cast<size_t>(i)];
+        if (!parseInt(cursor, id) || !parseFloat(cursor, p[0]) || !parseFloat(cursor, p[1]) || !parseFloat(cursor, p[2])) {
+            return false;
+        }
+        for (int axis = 0; axis < 3; ++axis) {
+            source.boundsMin[axis] = std::min(source.boundsMin[axis], p[axis]);
+            source.boundsMax[axis] = std::max(source.boundsMax[axis], p[axis]);
+        }
+        skipLine(cursor);
+    }
+    source.faceLines = cursor;
+    return true;
+}
+
+// Parses the face lines from the start, handing each validated face to visit
+template <typename Visit>
+bool forEachSourceFace(const SourceMesh& source, Visit visit) {
+    TextCursor cursor = source.faceLines;
+    for (int i = 0; i < source.faceCount; ++i) {
+        skipBlankLines(cursor);
+        Face f;
+        if (!parseInt(cursor, f.v1) || !parseInt(cursor, f.v2) || !parseInt(cursor, f.v3)) return false;
+        if (f.v1 < 1 || f.v2 < 1 || f.v3 < 1 || f.v1 > source.vertexCount || f.v2 > source.vertexCount ||
+            f.v3 > source.vertexCount) {
+            return false;
+        }
+        visit(f);
+        skipLine(cursor);
+    }
+    return true;
+}
+
+// Cubic cells over the longest side of the bounds, indexed by face centroid
+struct ChunkGrid {
+    float origin[3];
+    float cellsPerUnit;
+
+    uint32_t cellOf(const SourceMesh& source, const Face& f) const {
+        const float* a = &source.positions[3 * static_cast<size_t>(f.v1 - 1)];
+        const float* b = &source.positions[3 * static_cast<size_t>(f.v2 - 1)];
+        const float* c = &source.positions[3 * static_cast<size_t>(f.v3 - 1)];
+        uint32_t cell[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            const float centroid = (a[axis] + b[axis] + c[axis]) / 3;
+            const int index = static_cast<int>((centroid - origin[axis]) * cellsPerUnit);
+            cell[axis] = static_cast<uint32_t>(std::min(std::max(index, 0), CHUNK_GRID_RESOLUTION - 1));
+        }
+        return (cell[2] * CHUNK_GRID_RESOLUTION + cell[1]) * CHUNK_GRID_RESOLUTION + cell[0];
+    }
+};
+
+// Octree split of the fine grid: a cube becomes one chunk once it holds few enough faces, or is a single cell
+void splitCells(const std::vector<uint32_t>& counts, int x0, int y0, int z0, int size, std::vector<uint32_t>& cellChunk,
+    uint32_t& chunkCount) {
+    const int R = CHUNK_GRID_RESOLUTION;
+    uint64_t total = 0;
+    for (int z = z0; z < z0 + size; ++z) {
+        for (int y = y0; y < y0 + size; ++y) {
+            for (int x = x0; x < x0 + size; ++x) total += counts[(z * R + y) * R + x];
+        }
+    }
+    if (total == 0) return;
+
+    if (total <= CHUNK_TARGET_FACES || size == 1) {
+        for (int z = z0; z < z0 + size; ++z) {
+            for (int y = y0; y < y0 + size; ++y) {
+                for (int x = x0; x < x0 + size; ++x) cellChunk[(z * R + y) * R + x] = chunkCount;
+            }
+        }
+        ++chunkCount;
+        return;
+    }
+
+    const int half = size / 2;
+    for (int octant = 0; octant < 8; ++octant) {
+        splitCells(counts, x0 + (octant & 1) * half, y0 + ((octant >> 1) & 1) * half, z0 + ((octant >> 2) & 1) * half, half,
+            cellChunk, chunkCount);
+    }
+}
+
+// Copies the vertices one chunk's faces use, in source order, and renumbers the faces to match
+void localizeChunk(const SourceMesh& source, const std::vector<Face>& globalFaces, std::vector<Vertex>& vertices,
+    std::vector<Face>& faces) {
+    std::vector<uint32_t> ids;
+    ids.reserve(globalFaces.size() * 3);
+    for (const Face& f : globalFaces) {
+        ids.push_back(f.v1);
+        ids.push_back(f.v2);
+        ids.push_back(f.v3);
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    vertices.resize(ids.size());
+    for (size_t i = 0; i < ids.size(); ++i) {
+        const float* p = &source.positions[3 * static_cast<size_t>(ids[i] - 1)];
+        vertices[i] = { static_cast<int>(i + 1), p[0], p[1], p[2] };
+    }
+    auto local = [&](int id) {
+        return static_cast<int>(std::lower_bound(ids.begin(), ids.end(), static_cast<uint32_t>(id)) - ids.begin()) + 1;
+    };
+    faces.resize(globalFaces.size());
+    for (size_t i = 0; i < globalFaces.size(); ++i) {
+        faces[i] = { local(globalFaces[i].v1), local(globalFaces[i].v2), local(globalFaces[i].v3) };
+    }
+}
+
+// Positions without ids, then faces, at the next aligned offset
+bool writeChunkLevel(HANDLE file, uint64_t& position, const std::vector<Vertex>& vertices, const std::vector<Face>& faces,
+    MeshChunkLevel& level) {
+    static const char zeros[LEVEL_ALIGNMENT] = {};
+    const uint64_t aligned = alignLevel(position);
+    if (!writeAll(file, zeros, static_cast<size_t>(aligned - position))) return false;
+
+    std::vector<float> positions(3 * vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        positions[3 * i] = vertices[i].x;
+        positions[3 * i + 1] = vertices[i].y;
+        positions[3 * i + 2] = vertices[i].z;
+    }
+    level.offset = aligned;
+    level.vertexCount = static_cast<uint32_t>(vertices.size());
+    level.faceCount = static_cast<uint32_t>(faces.size());
+    position = aligned + positions.size() * sizeof(float) + faces.size() * sizeof(Face);
+    return writeAll(file, positions.data(), positions.size() * sizeof(float)) && writeAll(file, faces.data(), faces.size() * sizeof(Face));
+}
+
+// Full detail in leaf order, then clustered levels of about a quarter of the faces each. Chunks are clustered
+// on their own grids, so coarse levels of neighbouring chunks can leave hairline cracks along the seams.
+bool writeChunk(HANDLE file, uint64_t& position, std::vector<Vertex>& vertices, std::vector<Face>& faces, MeshChunkInfo& info) {
+    MeshBvh bvh;
+    buildMeshBvh(vertices, faces, bvh);
+    reorderVerticesByFirstUse(vertices, faces);
+    for (int axis = 0; axis < 3; ++axis) {
+        info.boundsMin[axis] = bvh.nodes[0].boundsMin[axis];
+        info.boundsMax[axis] = bvh.nodes[0].boundsMax[axis];
+    }
+    info.cone = bvh.cones[0];
+
+    info.levelCount = 1;
+    info.levels[0].error = 0;
+    if (!writeChunkLevel(file, position, vertices, faces, info.levels[0])) return false;
+
+    // A chunk is a patch rather than a closed surface, so the first guess assumes about two faces per cell
+    // and each attempt corrects it by the square root of the miss, as buildLodChain does
+    float extent = 0;
+    for (int axis = 0; axis < 3; ++axis) extent = std::max(extent, info.boundsMax[axis] - info.boundsMin[axis]);
+    size_t previousFaces = faces.size();
+    double resolution = std::sqrt(previousFaces * LEVEL_REDUCTION / 2);
+    while (info.levelCount < CHUNK_MAX_LEVELS && previousFaces > CHUNK_FLOOR_FACES) {
+        const double target = previousFaces * LEVEL_REDUCTION;
+        LodLevel level;
+        int cells = 2;
+        for (int attempt = 0; attempt < MAX_RESOLUTION_ATTEMPTS; ++attempt) {
+            cells = static_cast<int>(resolution < 2 ? 2 : resolution);
+            clusterVertices(vertices, faces, cells, level);
+            const double produced = level.faces.empty() ? 1.0 : static_cast<double>(level.faces.size());
+            if (produced < target * TARGET_TOLERANCE && produced > target / TARGET_TOLERANCE) break;
+            resolution *= std::sqrt(target / produced);
+        }
+        if (level.faces.empty() || level.faces.size() > previousFaces * 0.9) break;
+
+        MeshChunkLevel& entry = info.levels[info.levelCount++];
+        entry.error = extent / cells;
+        if (!writeChunkLevel(file, position, level.vertices, level.faces, entry)) return false;
+        previousFaces = level.faces.size();
+        resolution = cells * std::sqrt(LEVEL_REDUCTION);
+    }
+    return true;
+}
+
+// Bytes a decoded level occupies; the edge count is estimated from the closed-mesh ratio of 1.5 per face
+uint64_t estimateLevelBytes(const MeshChunkLevel& level) {
+    const uint64_t paddedVertices = (level.vertexCount + VERTEX_LANES - 1) / VERTEX_LANES * VERTEX_LANES;
+    const uint64_t paddedFaces = (level.faceCount + VERTEX_LANES - 1) / VERTEX_LANES * VERTEX_LANES;
+    const uint64_t edges = level.faceCount * 3ull / 2;
+    return paddedVertices * 3 * sizeof(float) + paddedFaces * 3 * sizeof(float)
+        + level.faceCount * (sizeof(Face) + 1 + 3 * sizeof(uint32_t)) + edges * (sizeof(MeshEdge) + 1);
+}
+
+// Bytes a resident chunk actually holds
+uint64_t residentBytes(const ResidentChunk& chunk) {
+    return (chunk.normalized.x.size() + chunk.faceNormals.x.size()) * 3 * sizeof(float)
+        + chunk.faces.size() * sizeof(Face) + chunk.degenerateFaces.size()
+        + chunk.edges.edges.size() * (sizeof(MeshEdge) + 1) + chunk.edges.faceEdges.size() * sizeof(uint32_t);
+}
+
+// Free a chunk's level, keeping only when it was last seen
+void releaseChunk(ChunkStream& stream, uint32_t index) {
+    ResidentChunk& chunk = stream.resident[index];
+    stream.stats.residentBytes -= chunk.bytes;
+    ResidentChunk empty;
+    empty.lastVisible = chunk.lastVisible;
+    chunk = std::move(empty);
+}
+
+// Map just the level's byte range, then normalize and derive normals and edges as a detail level would
+bool pageInChunk(ChunkStream& stream, uint32_t index, int level) {
+    LONGLONG start = profileNow();
+    const MeshChunkLevel& entry = stream.chunks[index].levels[level];
+    const size_t positionBytes = 3 * sizeof(float) * static_cast<size_t>(entry.vertexCount);
+    const size_t faceBytes = sizeof(Face) * static_cast<size_t>(entry.faceCount);
+    MappedRange range;
+    if (!mapFileRange(stream.file, entry.offset, positionBytes + faceBytes, range)) return false;
+
+    ResidentChunk& chunk = stream.resident[index];
+    const float* positions = reinterpret_cast<const float*>(range.data);
+    const float* center = stream.header.center;
+    const float extent = stream.header.extent;
+    resizeVertexStream(chunk.normalized, entry.vertexCount);
+    for (uint32_t i = 0; i < entry.vertexCount; ++i) {
+        chunk.normalized.x[i] = (positions[3 * i] - center[0]) / extent;
+        chunk.normalized.y[i] = (positions[3 * i + 1] - center[1]) / extent;
+        chunk.normalized.z[i] = (positions[3 * i + 2] - center[2]) / extent;
+    }
+    chunk.faces.resize(entry.faceCount);
+    if (faceBytes) memcpy(chunk.faces.data(), range.data + positionBytes, faceBytes);
+    unmapFileRange(range);
+
+    // A corrupt index would crash the renderer; drop the level instead
+    const int count = static_cast<int>(entry.vertexCount);
+    for (const Face& f : chunk.faces) {
+        if (f.v1 < 1 || f.v2 < 1 || f.v3 < 1 || f.v1 > count || f.v2 > count || f.v3 > count) {
+            releaseChunk(stream, index);
+            return false;
+        }
+    }
+
+    computeFaceNormals(chunk.normalized, chunk.faces, chunk.faceNormals, chunk.degenerateFaces);
+    buildMeshEdges(chunk.faces, chunk.faceNormals, chunk.degenerateFaces, chunk.edges);
+    chunk.level = level;
+    chunk.bytes = residentBytes(chunk);
+    stream.stats.residentBytes += chunk.bytes;
+    ++stream.stats.pageIns;
+    stream.stats.pageInMs += (profileNow() - start) * 1000.0 / profiler.frequency;
+    return true;
+}
+
+// Least recently visible resident chunk outside this update's plan, or -1
+int64_t evictionCandidate(const ChunkStream& stream, const std::vector<int>& target) {
+    int64_t best = -1;
+    for (size_t i = 0; i < stream.resident.size(); ++i) {
+        const ResidentChunk& chunk = stream.resident[i];
+        if (chunk.level < 0 || target[i] >= 0) continue;
+        if (best < 0 || chunk.lastVisible < stream.resident[best].lastVisible) best = static_cast<int64_t>(i);
+    }
+    return best;
+}
+
+} // namespace
+
+// object.txt -> object.txt.chunks
+std::string meshChunkPath(const char* sourcePath) {
+    return std::string(sourcePath) + CHUNK_EXTENSION;
+}
+
+// Count faces per fine cell, split the grid into chunks, bucket the faces through a temporary file, then
+// finish each chunk in turn and write the table last
+bool buildChunkFile(const char* sourcePath, const char* chunkPath, ChunkBuildStats* stats) {
+    FileStamp stamp;
+    SourceMesh source;
+    if (!getFileStamp(sourcePath, stamp) || !openMappedFile(sourcePath, source.mapped)) return false;
+    if (!parseSourcePositions(source) || source.vertexCount == 0 || source.faceCount == 0) {
+        closeMappedFile(source.mapped);
+        return false;
+    }
+
+    // The same frame normalizeVertices would compute for the whole mesh
+    MeshChunkHeader header = {};
+    memcpy(header.magic, MESH_CHUNK_MAGIC, sizeof(header.magic));
+    header.version = MESH_CHUNK_VERSION;
+    header.source = stamp;
+    header.vertexCount = static_cast<uint64_t>(source.vertexCount);
+    header.faceCount = static_cast<uint64_t>(source.faceCount);
+    double sum[3] = { 0, 0, 0 };
+    for (size_t i = 0; i < source.positions.size(); i += 3) {
+        for (int axis = 0; axis < 3; ++axis) sum[axis] += source.positions[i + axis];
+    }
+    for (int axis = 0; axis < 3; ++axis) header.center[axis] = static_cast<float>(sum[axis] / source.vertexCount);
+    float maxExtent = 0;
+    for (size_t i = 0; i < source.positions.size(); i += 3) {
+        const float dx = source.positions[i] - header.center[0];
+        const float dy = source.positions[i + 1] - header.center[1];
+        const float dz = source.positions[i + 2] - header.center[2];
+        maxExtent = std::max(maxExtent, sqrtf(dx * dx + dy * dy + dz * dz));
+    }
+    header.extent = maxExtent > 0 ? maxExtent : 1;
+
+    ChunkGrid grid;
+    float side = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+        grid.origin[axis] = source.boundsMin[axis];
+        side = std::max(side, source.boundsMax[axis] - source.boundsMin[axis]);
+    }
+    grid.cellsPerUnit = side > 0 ? CHUNK_GRID_RESOLUTION / side : 0;
+
+    const size_t cellCount = static_cast<size_t>(CHUNK_GRID_RESOLUTION) * CHUNK_GRID_RESOLUTION * CHUNK_GRID_RESOLUTION;
+    std::vector<uint32_t> counts(cellCount, 0);
+    bool ok = forEachSourceFace(source, [&](const Face& f) { ++counts[grid.cellOf(source, f)]; });
+
+    std::vector<uint32_t> cellChunk(cellCount, 0);
+    uint32_t chunkCount = 0;
+    if (ok) splitCells(counts, 0, 0, 0, CHUNK_GRID_RESOLUTION, cellChunk, chunkCount);
+    header.chunkCount = chunkCount;
+
+    // Each chunk owns one contiguous run of the bucket file, sized by the counting pass
+    std::vector<uint64_t> chunkStart(chunkCount + 1, 0);
+    for (size_t cell = 0; cell < cellCount; ++cell) {
+        if (counts[cell]) chunkStart[cellChunk[cell] + 1] += counts[cell];
+    }
+    for (uint32_t i = 0; i < chunkCount; ++i) chunkStart[i + 1] += chunkStart[i];
+
+    std::string bucketPath = std::string(chunkPath) + ".faces.tmp";
+    HANDLE buckets = CreateFileA(bucketPath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+        FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if (buckets == INVALID_HANDLE_VALUE) {
+        closeMappedFile(source.mapped);
+        return false;
+    }
+
+    std::vector<std::vector<Face>> pending(chunkCount);
+    std::vector<uint64_t> written(chunkCount, 0);
+    auto flush = [&](uint32_t chunk) {
+        std::vector<Face>& buffer = pending[chunk];
+        bool flushed = seekTo(buckets, (chunkStart[chunk] + written[chunk]) * sizeof(Face))
+            && writeAll(buckets, buffer.data(), buffer.size() * sizeof(Face));
+        written[chunk] += buffer.size();
+        buffer.clear();
+        return flushed;
+    };
+    bool bucketed = true;
+    ok = ok && forEachSourceFace(source, [&](const Face& f) {
+        const uint32_t chunk = cellChunk[grid.cellOf(source, f)];
+        pending[chunk].push_back(f);
+        if (pending[chunk].size() >= BUCKET_FLUSH_FACES && !flush(chunk)) bucketed = false;
+        }) && bucketed;
+    for (uint32_t i = 0; ok && i < chunkCount; ++i) {
+        if (!pending[i].empty()) ok = flush(i);
+    }
+    pending.clear();
+    pending.shrink_to_fit();
+
+    std::string tempPath = std::string(chunkPath) + ".tmp";
+    HANDLE file = ok ? CreateFileA(tempPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr)
+        : INVALID_HANDLE_VALUE;
+    ok = file != INVALID_HANDLE_VALUE;
+
+    // Zeros hold the place of the header and table until every level's offset is known
+    std::vector<MeshChunkInfo> table(chunkCount);
+    memset(table.data(), 0, table.size() * sizeof(MeshChunkInfo));
+    MeshChunkHeader placeholder = {};
+    uint64_t position = sizeof(header) + table.size() * sizeof(MeshChunkInfo);
+    ok = ok && writeAll(file, &placeholder, sizeof(placeholder)) && writeAll(file, table.data(), table.size() * sizeof(MeshChunkInfo));
+
+    std::vector<Face> globalFaces;
+    std::vector<Vertex> localVertices;
+    std::vector<Face> localFaces;
+    size_t levelTotal = 0;
+    for (uint32_t i = 0; ok && i < chunkCount; ++i) {
+        globalFaces.resize(static_cast<size_t>(chunkStart[i + 1] - chunkStart[i]));
+        ok = seekTo(buckets, chunkStart[i] * sizeof(Face)) && readAll(buckets, globalFaces.data(), globalFaces.size() * sizeof(Face));
+        if (!ok) break;
+        localizeChunk(source, globalFaces, localVertices, localFaces);
+        ok = writeChunk(file, position, localVertices, localFaces, table[i]);
+        levelTotal += table[i].levelCount;
+    }
+    CloseHandle(buckets);
+    closeMappedFile(source.mapped);
+
+    ok = ok && seekTo(file, 0) && writeAll(file, &header, sizeof(header))
+        && writeAll(file, table.data(), table.size() * sizeof(MeshChunkInfo));
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+
+    if (!ok || !MoveFileExA(tempPath.c_str(), chunkPath, MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFileA(tempPath.c_str());
+        return false;
+    }
+    if (stats) {
+        stats->chunkCount = chunkCount;
+        stats->levelCount = levelTotal;
+        stats->fileBytes = position;
+    }
+    return true;
+}
+
+// Header and table come through one short-lived view; level ranges are checked against the file size up front
+bool openChunkStream(const char* chunkPath, const FileStamp* source, uint64_t budgetBytes, ChunkStream& stream) {
+    closeChunkStream(stream);
+    if (!openFileMapping(chunkPath, stream.file)) return false;
+
+    MappedRange range;
+    bool ok = mapFileRange(stream.file, 0, sizeof(MeshChunkHeader), range);
+    if (ok) {
+        memcpy(&stream.header, range.data, sizeof(MeshChunkHeader));
+        unmapFileRange(range);
+        const MeshChunkHeader& header = stream.header;
+        ok = memcmp(header.magic, MESH_CHUNK_MAGIC, sizeof(header.magic)) == 0
+            && header.version == MESH_CHUNK_VERSION
+            && header.extent > 0
+            && header.chunkCount <= (stream.file.size - sizeof(header)) / sizeof(MeshChunkInfo)
+            && (!source || (header.source.size == source->size && header.source.writeTime == source->writeTime));
+    }
+    ok = ok && (stream.header.chunkCount == 0 ||
+        mapFileRange(stream.file, sizeof(MeshChunkHeader), stream.header.chunkCount * sizeof(MeshChunkInfo), range));
+    if (ok) {
+        stream.chunks.resize(stream.header.chunkCount);
+        if (range.data) memcpy(stream.chunks.data(), range.data, stream.chunks.size() * sizeof(MeshChunkInfo));
+        unmapFileRange(range);
+    }
+    for (size_t i = 0; ok && i < stream.chunks.size(); ++i) {
+        const MeshChunkInfo& info = stream.chunks[i];
+        ok = info.levelCount >= 1 && info.levelCount <= CHUNK_MAX_LEVELS;
+        for (uint32_t level = 0; ok && level < info.levelCount; ++level) {
+            const MeshChunkLevel& entry = info.levels[level];
+            const uint64_t bytes = 3ull * sizeof(float) * entry.vertexCount + sizeof(Face) * static_cast<uint64_t>(entry.faceCount);
+            ok = entry.offset <= stream.file.size && bytes <= stream.file.size - entry.offset && entry.faceCount > 0;
+        }
+    }
+    if (!ok) {
+        closeChunkStream(stream);
+        return false;
+    }
+
+    // Chunk bounds and cones as a flat node array, so the BVH node test classifies them
+    const ModelFrame frame = { stream.header.center[0], stream.header.center[1], stream.header.center[2], stream.header.extent };
+    stream.bounds.nodes.resize(stream.chunks.size());
+    stream.bounds.cones.resize(stream.chunks.size());
+    for (size_t i = 0; i < stream.chunks.size(); ++i) {
+        BvhNode& node = stream.bounds.nodes[i];
+        for (int axis = 0; axis < 3; ++axis) {
+            node.boundsMin[axis] = stream.chunks[i].boundsMin[axis];
+            node.boundsMax[axis] = stream.chunks[i].boundsMax[axis];
+        }
+        node.offset = 0;
+        node.count = stream.chunks[i].levels[0].faceCount | BVH_LEAF;
+        stream.bounds.cones[i] = stream.chunks[i].cone;
+    }
+    normalizeBvhBounds(stream.bounds, frame);
+
+    // Page-in times use the profiler's counter frequency even while its timers are off
+    if (!profiler.frequency) {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        profiler.frequency = frequency.QuadPart;
+    }
+    stream.resident.resize(stream.chunks.size());
+    stream.budgetBytes = budgetBytes;
+    return true;
+}
+
+// A stale or missing chunk file is rebuilt from its source, the way loadMeshCached refreshes the cache
+bool openMeshChunks(const char* path, uint64_t budgetBytes, ChunkStream& stream) {
+    const std::string name(path);
+    const size_t extension = sizeof(CHUNK_EXTENSION) - 1;
+    const bool chunkFile = name.size() > extension && name.compare(name.size() - extension, extension, CHUNK_EXTENSION) == 0;
+    const std::string sourcePath = chunkFile ? name.substr(0, name.size() - extension) : name;
+    const std::string chunkPath = chunkFile ? name : meshChunkPath(path);
+
+    FileStamp source;
+    if (!getFileStamp(sourcePath.c_str(), source)) return chunkFile && openChunkStream(chunkPath.c_str(), nullptr, budgetBytes, stream);
+    if (openChunkStream(chunkPath.c_str(), &source, budgetBytes, stream)) return true;
+    return buildChunkFile(sourcePath.c_str(), chunkPath.c_str()) && openChunkStream(chunkPath.c_str(), &source, budgetBytes, stream);
+}
+
+void closeChunkStream(ChunkStream& stream) {
+    closeMappedFile(stream.file);
+    stream = ChunkStream();
+}
+
+// Plan first: every visible chunk at its coarsest level, then refine the worst projected error while the
+// budget lasts. Then page towards the plan, filling holes before refining, within the per-update quota.
+bool updateChunkStream(ChunkStream& stream, const BvhView& view) {
+    ++stream.update;
+    const size_t chunkCount = stream.chunks.size();
+    const float pixelsPerUnit = view.scale / stream.header.extent;
+    auto errorPixels = [&](size_t i, int level) { return stream.chunks[i].levels[level].error * pixelsPerUnit; };
+
+    std::vector<int> target(chunkCount, -1);
+    uint64_t planned = 0;
+    size_t visible = 0;
+    for (size_t i = 0; i < chunkCount; ++i) {
+        if (stream.chunks[i].levelCount == 0) continue;
+        if (classifyBvhNode(stream.bounds, static_cast<uint32_t>(i), view) != BVH_PARTIAL) continue;
+        ++visible;
+        stream.resident[i].lastVisible = stream.update;
+        const int coarsest = static_cast<int>(stream.chunks[i].levelCount) - 1;
+        const uint64_t cost = estimateLevelBytes(stream.chunks[i].levels[coarsest]);
+        if (planned + cost > stream.budgetBytes) continue;
+        target[i] = coarsest;
+        planned += cost;
+    }
+
+    std::priority_queue<std::pair<float, uint32_t>> refine;
+    for (size_t i = 0; i < chunkCount; ++i) {
+        if (target[i] > 0 && errorPixels(i, target[i]) > CHUNK_PIXEL_ERROR) refine.emplace(errorPixels(i, target[i]), static_cast<uint32_t>(i));
+    }
+    while (!refine.empty()) {
+        const uint32_t i = refine.top().second;
+        refine.pop();
+        const MeshChunkLevel* levels = stream.chunks[i].levels;
+        const uint64_t delta = estimateLevelBytes(levels[target[i] - 1]) - estimateLevelBytes(levels[target[i]]);
+        if (planned + delta > stream.budgetBytes) continue;
+        planned += delta;
+        --target[i];
+        if (target[i] > 0 && errorPixels(i, target[i]) > CHUNK_PIXEL_ERROR) refine.emplace(errorPixels(i, target[i]), i);
+    }
+
+    // Chunks with nothing resident leave holes in the frame, so they go before level changes
+    std::vector<uint32_t> work;
+    for (size_t i = 0; i < chunkCount; ++i) {
+        if (target[i] >= 0 && stream.resident[i].level != target[i]) work.push_back(static_cast<uint32_t>(i));
+    }
+    std::stable_partition(work.begin(), work.end(), [&](uint32_t i) { return stream.resident[i].level < 0; });
+
+    bool changed = false;
+    size_t pageIns = 0;
+    for (uint32_t i : work) {
+        if (pageIns == CHUNK_PAGE_INS_PER_UPDATE) break;
+        ResidentChunk& chunk = stream.resident[i];
+        const uint64_t need = estimateLevelBytes(stream.chunks[i].levels[target[i]]);
+        while (stream.stats.residentBytes - chunk.bytes + need > stream.budgetBytes) {
+            const int64_t victim = evictionCandidate(stream, target);
+            if (victim < 0) break;
+            releaseChunk(stream, static_cast<uint32_t>(victim));
+            ++stream.stats.evictions;
+            changed = true;
+        }
+        if (stream.stats.residentBytes - chunk.bytes + need > stream.budgetBytes) continue;
+
+        if (chunk.level >= 0) releaseChunk(stream, i);
+        changed = true;
+        ++pageIns;
+        // An unreadable chunk is never planned again
+        if (!pageInChunk(stream, i, target[i])) stream.chunks[i].levelCount = 0;
+    }
+
+    ChunkResidencyStats& stats = stream.stats;
+    stats.visibleChunks = visible;
+    stats.residentChunks = 0;
+    stats.residentFaces = 0;
+    stats.pending = 0;
+    for (size_t i = 0; i < chunkCount; ++i) {
+        const ResidentChunk& chunk = stream.resident[i];
+        if (chunk.level >= 0) {
+            ++stats.residentChunks;
+            stats.residentFaces += chunk.faces.size();
+        }
+        if (target[i] >= 0 && chunk.level != target[i] && stream.chunks[i].levelCount > 0) ++stats.pending;
+    }
+    return changed;
+}
+
+// Sized for every resident chunk first, then filled chunk by chunk in table order
+void assembleResidentChunks(const ChunkStream& stream, DetailLevel& level) {
+    size_t vertexTotal = 0, faceTotal = 0, edgeTotal = 0;
+    for (const ResidentChunk& chunk : stream.resident) {
+        if (chunk.level < 0) continue;
+        vertexTotal += chunk.normalized.count;
+        faceTotal += chunk.faces.size();
+        edgeTotal += chunk.edges.edges.size();
+    }
+
+    EdgeList& edges = level.edges;
+    resizeVertexStream(level.normalized, vertexTotal);
+    resizeVertexStream(level.faceNormals, faceTotal);
+    level.faces.resize(faceTotal);
+    level.degenerateFaces.resize(faceTotal);
+    edges.edges.resize(edgeTotal);
+    edges.faceEdges.resize(3 * faceTotal);
+    edges.flags.resize(edgeTotal);
+
+    uint32_t vertexOffset = 0, faceOffset = 0, edgeOffset = 0;
+    for (const ResidentChunk& chunk : stream.resident) {
+        if (chunk.level < 0) continue;
+        const size_t vertexCount = chunk.normalized.count, faceCount = chunk.faces.size(), edgeCount = chunk.edges.edges.size();
+        std::copy_n(chunk.normalized.x.begin(), vertexCount, level.normalized.x.begin() + vertexOffset);
+        std::copy_n(chunk.normalized.y.begin(), vertexCount, level.normalized.y.begin() + vertexOffset);
+        std::copy_n(chunk.normalized.z.begin(), vertexCount, level.normalized.z.begin() + vertexOffset);
+        std::copy_n(chunk.faceNormals.x.begin(), faceCount, level.faceNormals.x.begin() + faceOffset);
+        std::copy_n(chunk.faceNormals.y.begin(), faceCount, level.faceNormals.y.begin() + faceOffset);
+        std::copy_n(chunk.faceNormals.z.begin(), faceCount, level.faceNormals.z.begin() + faceOffset);
+        std::copy_n(chunk.degenerateFaces.begin(), faceCount, level.degenerateFaces.begin() + faceOffset);
+        for (size_t i = 0; i < faceCount; ++i) {
+            const Face& f = chunk.faces[i];
+            const int base = static_cast<int>(vertexOffset);
+            level.faces[faceOffset + i] = { f.v1 + base, f.v2 + base, f.v3 + base };
+        }
+        for (size_t i = 0; i < edgeCount; ++i) {
+            const MeshEdge& e = chunk.edges.edges[i];
+            MeshEdge& out = edges.edges[edgeOffset + i];
+            out.v[0] = e.v[0] + vertexOffset;
+            out.v[1] = e.v[1] + vertexOffset;
+            out.face[0] = e.face[0] + faceOffset;
+            out.face[1] = e.face[1] == NO_FACE ? NO_FACE : e.face[1] + faceOffset;
+        }
+        std::copy_n(chunk.edges.flags.begin(), edgeCount, edges.flags.begin() + edgeOffset);
+        for (size_t i = 0; i < 3 * faceCount; ++i) {
+            const uint32_t link = chunk.edges.faceEdges[i];
+            edges.faceEdges[3 * faceOffset + i] = link == NO_FACE ? NO_FACE : link + edgeOffset;
+        }
+        vertexOffset += static_cast<uint32_t>(vertexCount);
+        faceOffset += static_cast<uint32_t>(faceCount);
+        edgeOffset += static_cast<uint32_t>(edgeCount);
+    }
+
+    level.bvh = MeshBvh();
+    level.faceCount = faceTotal;
+    level.vertexCount = vertexTotal;
+}
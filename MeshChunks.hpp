@@ -0,0 +1,159 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Out-of-core chunked meshes, for models too large to load
+//      whole. An offline pass splits the mesh into spatial chunks,
+//      each with its own bounds, normal cone and short LOD chain,
+//      and writes them to a ".chunks" file. The viewer keeps only
+//      the chunk table in memory and pages chunk levels in through
+//      views of their byte ranges: visible chunks get the finest
+//      level whose screen-space error is under a pixel, as far as
+//      the memory budget allows, and the least recently visible
+//      chunks are evicted to stay within it.
+//
+//      Layout (little-endian):
+//          MeshChunkHeader
+//          MeshChunkInfo[chunkCount]
+//          level payloads, each float[3 * vertexCount] then
+//          uint32_t[3 * faceCount] (1-based, chunk-local), aligned
+//          to 32 bytes
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MeshBvh.hpp"
+#include "MeshCache.hpp"
+#include "MeshEdges.hpp"
+#include "MeshLoader.hpp"
+#include "VertexTransform.hpp"
+
+struct Face;
+struct DetailLevel;
+
+// Bump whenever the layout of the header, the table or a level changes
+const uint32_t MESH_CHUNK_VERSION = 1;
+
+// Full detail plus up to three clustered levels per chunk
+const uint32_t CHUNK_MAX_LEVELS = 4;
+
+// The spatial split stops once a cell holds at most this many faces
+const size_t CHUNK_TARGET_FACES = 32768;
+
+// Cells along the longest axis of the fine grid the split starts from; a power of two
+const int CHUNK_GRID_RESOLUTION = 64;
+
+// A chunk's level is fine enough once its clustering error projects to at most this many pixels
+const float CHUNK_PIXEL_ERROR = 1.0f;
+
+// Page-ins per update; the rest wait for later frames so input never stalls for long
+const size_t CHUNK_PAGE_INS_PER_UPDATE = 8;
+
+// Default residency budget ("-budget MB" overrides it)
+const uint64_t CHUNK_DEFAULT_BUDGET_MB = 512;
+
+// Fixed-size file header
+struct MeshChunkHeader {
+    char magic[4];              // "3DMK"
+    uint32_t version;           // MESH_CHUNK_VERSION
+    FileStamp source;           // Stamp of the text file the chunks were built from
+    uint64_t vertexCount;       // Of the source mesh
+    uint64_t faceCount;
+    float center[3];            // Centroid and extent of the source, as normalizeVertices computes them
+    float extent;
+    uint32_t chunkCount;        // Entries in the chunk table that follows
+    uint32_t reserved;
+};
+
+// One level of a chunk
+struct MeshChunkLevel {
+    uint64_t offset;            // Byte offset of the positions from the start of the file
+    uint32_t vertexCount;
+    uint32_t faceCount;
+    float error;                // Clustering cell size in source units; 0 at full detail
+    uint32_t reserved;
+};
+
+// Chunk table entry; levels run from full detail to coarsest
+struct MeshChunkInfo {
+    float boundsMin[3];         // Of the full-detail level, in source units
+    float boundsMax[3];
+    BvhCone cone;               // Normal cone over the full-detail faces
+    uint32_t levelCount;
+    uint32_t reserved;
+    MeshChunkLevel levels[CHUNK_MAX_LEVELS];
+};
+
+// What the builder produced
+struct ChunkBuildStats {
+    size_t chunkCount = 0;
+    size_t levelCount = 0;      // Summed over all chunks
+    uint64_t fileBytes = 0;
+};
+
+// One chunk's resident level, decoded into the same form as a detail level
+struct ResidentChunk {
+    int level = -1;                     // Level held, -1 if none
+    uint64_t bytes = 0;                 // Memory charged against the budget
+    uint64_t lastVisible = 0;           // Update number the chunk was last visible in
+    VertexStream normalized;
+    std::vector<Face> faces;            // 1-based, chunk-local
+    VertexStream faceNormals;
+    std::vector<uint8_t> degenerateFaces;
+    EdgeList edges;
+};
+
+// Counters reported in the caption and by the benchmark
+struct ChunkResidencyStats {
+    size_t visibleChunks = 0;           // In the frame and not entirely back-facing, at the last update
+    size_t residentChunks = 0;
+    size_t residentFaces = 0;
+    uint64_t residentBytes = 0;
+    size_t pending = 0;                 // Visible chunks not yet at their chosen level
+    size_t pageIns = 0;                 // Since the stream was opened
+    size_t evictions = 0;
+    double pageInMs = 0;                // Time spent mapping and decoding levels
+};
+
+// An open chunk file and its residency state
+struct ChunkStream {
+    MappedFile file;                    // Mapping only; each page-in maps a view of one level
+    MeshChunkHeader header = {};
+    std::vector<MeshChunkInfo> chunks;
+    MeshBvh bounds;                     // One leaf per chunk in normalized coordinates, for classifyBvhNode
+    std::vector<ResidentChunk> resident;// Parallel to chunks
+    uint64_t budgetBytes = CHUNK_DEFAULT_BUDGET_MB << 20;
+    uint64_t update = 0;                // Number of updateChunkStream calls
+    ChunkResidencyStats stats;
+};
+
+// Returns the chunk file path that sits next to a source text file
+std::string meshChunkPath(const char* sourcePath);
+
+// Splits a text mesh into chunks and writes the chunk file. Only the vertex positions are held in memory:
+// faces are parsed twice, once to count them per grid cell and once to stream them into per-chunk runs
+// of a temporary file, and each chunk is then finished and written on its own.
+bool buildChunkFile(const char* sourcePath, const char* chunkPath, ChunkBuildStats* stats = nullptr);
+
+// Opens a chunk file and reads its table; no geometry is paged in yet. If source is given, a file built
+// from a text file with another size or timestamp is rejected.
+bool openChunkStream(const char* chunkPath, const FileStamp* source, uint64_t budgetBytes, ChunkStream& stream);
+
+// Opens "-stream path": either a source text, streamed from meshChunkPath(path), or a ".chunks" file whose
+// source is the same path without the extension. While that source exists the chunk file must match its
+// stamp, and is rebuilt from it when missing or stale; without it the chunk file is streamed as it is.
+bool openMeshChunks(const char* path, uint64_t budgetBytes, ChunkStream& stream);
+
+// Releases every resident chunk and the mapping
+void closeChunkStream(ChunkStream& stream);
+
+// Picks a level per visible chunk for the view, pages in up to CHUNK_PAGE_INS_PER_UPDATE of them and evicts
+// the least recently visible chunks to stay within the budget. Returns true if the resident set changed.
+bool updateChunkStream(ChunkStream& stream, const BvhView& view);
+
+// Concatenates every resident chunk into level as one mesh, offsetting each chunk's numbering into the joined
+// streams and setting the level's counts. Chunks have no hierarchy between them, so the level gets none: it culls
+// face by face and cannot be picked.
+void assembleResidentChunks(const ChunkStream& stream, DetailLevel& level);
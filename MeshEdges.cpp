@@ -0,0 +1,94 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Edge List
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "MeshEdges.hpp"
+#include "MeshTypes.hpp"
+#include "VertexTransform.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+#undef min
+#undef max
+
+namespace {
+
+// Sorted vertex pair packed into one key
+uint64_t edgeKey(uint32_t a, uint32_t b) {
+    if (a > b) std::swap(a, b);
+    return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+// Keys from neighbouring vertices differ only in a few low bits; mix them so the buckets spread
+struct EdgeKeyHash {
+    size_t operator()(uint64_t key) const {
+        key ^= key >> 33;
+        key *= 0xFF51AFD7ED558CCDull;
+        key ^= key >> 33;
+        return static_cast<size_t>(key);
+    }
+};
+
+} // namespace
+
+// One pass over the corners; a closed mesh has about 1.5 edges per face, so reserve for that
+void buildEdgeList(const std::vector<Face>& faces, EdgeList& list) {
+    list.edges.clear();
+    list.edges.reserve(faces.size() * 3 / 2 + 3);
+    list.faceEdges.resize(faces.size() * 3);
+    list.flags.clear();
+
+    std::unordered_map<uint64_t, uint32_t, EdgeKeyHash> lookup;
+    lookup.reserve(faces.size() * 3 / 2 + 3);
+
+    for (size_t i = 0; i < faces.size(); ++i) {
+        const uint32_t corners[3] = { static_cast<uint32_t>(faces[i].v1 - 1), static_cast<uint32_t>(faces[i].v2 - 1),
+            static_cast<uint32_t>(faces[i].v3 - 1) };
+        for (int k = 0; k < 3; ++k) {
+            uint32_t a = corners[k], b = corners[(k + 1) % 3];
+            uint32_t& link = list.faceEdges[i * 3 + k];
+            if (a == b) {
+                link = NO_FACE;
+                continue;
+            }
+
+            auto found = lookup.emplace(edgeKey(a, b), static_cast<uint32_t>(list.edges.size()));
+            link = found.first->second;
+            if (found.second) {
+                MeshEdge edge = { { std::min(a, b), std::max(a, b) }, { static_cast<uint32_t>(i), NO_FACE } };
+                list.edges.push_back(edge);
+                list.flags.push_back(EDGE_BOUNDARY);
+                continue;
+            }
+
+            // A face that names the same edge twice adds no new neighbour
+            MeshEdge& edge = list.edges[link];
+            uint8_t& flags = list.flags[link];
+            if (edge.face[0] == i || edge.face[1] == i) continue;
+            if (edge.face[1] == NO_FACE) {
+                edge.face[1] = static_cast<uint32_t>(i);
+                flags &= ~EDGE_BOUNDARY;
+            }
+            else {
+                flags |= EDGE_NON_MANIFOLD;
+            }
+        }
+    }
+}
+
+// Dihedral test between the two recorded faces of each interior edge
+void markCreaseEdges(const VertexStream& faceNormals, const std::vector<uint8_t>& degenerate, float creaseCos, EdgeList& list) {
+    for (size_t e = 0; e < list.edges.size(); ++e) {
+        const MeshEdge& edge = list.edges[e];
+        list.flags[e] &= ~EDGE_CREASE;
+        if (edge.face[1] == NO_FACE) continue;
+
+        const uint32_t f0 = edge.face[0], f1 = edge.face[1];
+        if (degenerate[f0] || degenerate[f1]) continue;
+        float dot = faceNormals.x[f0] * faceNormals.x[f1] + faceNormals.y[f0] * faceNormals.y[f1] +
+            faceNormals.z[f0] * faceNormals.z[f1];
+        if (dot < creaseCos) list.flags[e] |= EDGE_CREASE;
+    }
+}
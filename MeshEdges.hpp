@@ -0,0 +1,51 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Unique edge list: every undirected edge of the mesh once,
+//      with the faces on either side. Built at load time so the
+//      wireframe draws each shared edge a single time instead of
+//      once per adjacent triangle, and so silhouette and feature
+//      edges can be picked out per frame.
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Face;
+struct VertexStream;
+
+// Marks the missing second face of a boundary edge
+const uint32_t NO_FACE = 0xFFFFFFFFu;
+
+// One undirected edge, 0-based vertex indices with v[0] < v[1]
+struct MeshEdge {
+    uint32_t v[2];
+    uint32_t face[2];   // First two faces found using the edge; face[1] is NO_FACE on a boundary
+};
+
+// Feature flags, one byte per edge
+enum MeshEdgeFlags : uint8_t {
+    EDGE_BOUNDARY = 1,      // Only one face uses the edge
+    EDGE_NON_MANIFOLD = 2,  // Three or more faces use the edge
+    EDGE_CREASE = 4,        // The two faces meet at more than the crease angle
+};
+
+// Edges dihedral-bent by more than this (about 30 degrees) count as creases
+const float EDGE_CREASE_COS = 0.866f;
+
+// Edge list plus the face-to-edge links that let a face find its three edges
+struct EdgeList {
+    std::vector<MeshEdge> edges;
+    std::vector<uint32_t> faceEdges;    // 3 per face: edges v1-v2, v2-v3, v3-v1
+    std::vector<uint8_t> flags;         // MeshEdgeFlags per edge
+};
+
+// Deduplicates the edges of faces by a hash of their sorted vertex pair and records boundary and
+// non-manifold edges. Repeated corners (zero-length edges) are skipped and link to no edge.
+void buildEdgeList(const std::vector<Face>& faces, EdgeList& list);
+
+// Adds EDGE_CREASE to edges whose two faces' unit normals have a dot product below creaseCos.
+// Degenerate faces have no normal and never produce creases.
+void markCreaseEdges(const VertexStream& faceNormals, const std::vector<uint8_t>& degenerate, float creaseCos, EdgeList& list);
@@ -0,0 +1,585 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Memory-Mapped Loader
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "MeshLoader.hpp"
+#include "MeshTypes.hpp"
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#undef min
+#undef max
+
+namespace {
+
+// Exact powers of ten representable in a double
+const double POWERS_OF_TEN[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Shortest possible record: a face of three one-digit indices and two separators ("1,2,3")
+const size_t MIN_RECORD_BYTES = 5;
+
+inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+inline bool isLineEnd(char c) {
+    return c == '\n' || c == '\r';
+}
+
+// Returns true if [begin, end) holds anything but separators, i.e. it is a record rather than a blank line
+bool hasContent(const char* begin, const char* end) {
+    for (const char* p = begin; p < end; ++p) {
+        if (*p != ' ' && *p != '\t' && *p != ',' && *p != '\r') return true;
+    }
+    return false;
+}
+
+// Newline-aligned slice of the body, plus the index of the first record it holds
+struct ParseChunk {
+    const char* begin;
+    const char* end;
+    size_t firstRecord;     // Filled in by the prefix sum over recordCount
+    size_t recordCount;     // Non-blank lines in the chunk
+};
+
+// Count the records in one chunk
+size_t countRecords(const char* begin, const char* end) {
+    size_t count = 0;
+    while (begin < end) {
+        const char* newline = static_cast<const char*>(memchr(begin, '\n', end - begin));
+        const char* lineEnd = newline ? newline : end;
+        if (hasContent(begin, lineEnd)) ++count;
+        begin = newline ? newline + 1 : end;
+    }
+    return count;
+}
+
+// Parse one chunk straight into its final slots; records past the face section are ignored
+bool parseChunk(const ParseChunk& chunk, int vertexCount, int faceCount, Vertex* vertices, Face* faces) {
+    const size_t totalRecords = static_cast<size_t>(vertexCount) + faceCount;
+    size_t record = chunk.firstRecord;
+    TextCursor cursor = { chunk.begin, chunk.end };
+
+    while (cursor.pos < cursor.end && record < totalRecords) {
+        const char* newline = static_cast<const char*>(memchr(cursor.pos, '\n', cursor.end - cursor.pos));
+        const char* lineEnd = newline ? newline : cursor.end;
+        if (hasContent(cursor.pos, lineEnd)) {
+            TextCursor line = { cursor.pos, lineEnd };
+            if (record < static_cast<size_t>(vertexCount)) {
+                Vertex& v = vertices[record];
+                if (!parseInt(line, v.id) || !parseFloat(line, v.x) || !parseFloat(line, v.y) || !parseFloat(line, v.z)) return false;
+            }
+            else {
+                Face& f = faces[record - vertexCount];
+                if (!parseInt(line, f.v1) || !parseInt(line, f.v2) || !parseInt(line, f.v3)) return false;
+                if (f.v1 < 1 || f.v2 < 1 || f.v3 < 1 || f.v1 > vertexCount || f.v2 > vertexCount || f.v3 > vertexCount) return false;
+            }
+            ++record;
+        }
+        cursor.pos = newline ? newline + 1 : cursor.end;
+    }
+    return true;
+}
+
+// Run work(chunkIndex) for every chunk on threadCount threads pulling from a shared counter
+template <typename Work>
+void forEachChunk(size_t chunkCount, unsigned threadCount, Work work) {
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < chunkCount; i = next++) work(i);
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < threadCount; ++t) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+}
+
+} // namespace
+
+#ifdef _WIN32
+
+// Map the whole file read-only
+bool openMappedFile(const char* path, MappedFile& mapped) {
+    mapped = MappedFile();
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    mapped.file = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(mapped.file, &size) || size.QuadPart <= 0) {
+        closeMappedFile(mapped);
+        return false;
+    }
+    mapped.size = static_cast<size_t>(size.QuadPart);
+
+    mapped.mapping = CreateFileMappingA(mapped.file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapped.mapping) {
+        closeMappedFile(mapped);
+        return false;
+    }
+
+    mapped.data = static_cast<const char*>(MapViewOfFile(mapped.mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!mapped.data) {
+        closeMappedFile(mapped);
+        return false;
+    }
+    return true;
+}
+
+// Release the view and handles
+void closeMappedFile(MappedFile& mapped) {
+    if (mapped.data) UnmapViewOfFile(mapped.data);
+    if (mapped.mapping) CloseHandle(mapped.mapping);
+    if (mapped.file) CloseHandle(mapped.file);
+    mapped = MappedFile();
+}
+
+// The mapping half of openMappedFile; views are taken range by range afterwards
+bool openFileMapping(const char* path, MappedFile& mapped) {
+    mapped = MappedFile();
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    mapped.file = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(mapped.file, &size) || size.QuadPart <= 0) {
+        closeMappedFile(mapped);
+        return false;
+    }
+    mapped.size = static_cast<size_t>(size.QuadPart);
+
+    mapped.mapping = CreateFileMappingA(mapped.file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapped.mapping) {
+        closeMappedFile(mapped);
+        return false;
+    }
+    return true;
+}
+
+// MapViewOfFile offsets must be multiples of the allocation granularity, so the view starts a little early
+bool mapFileRange(const MappedFile& mapped, uint64_t offset, size_t size, MappedRange& range) {
+    range = MappedRange();
+    if (!mapped.mapping || offset > mapped.size || size > mapped.size - offset || size == 0) return false;
+
+    static const uint64_t granularity = []() {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return static_cast<uint64_t>(info.dwAllocationGranularity);
+    }();
+    const uint64_t start = offset / granularity * granularity;
+    const size_t viewSize = static_cast<size_t>(offset - start) + size;
+    const void* view = MapViewOfFile(mapped.mapping, FILE_MAP_READ, static_cast<DWORD>(start >> 32),
+        static_cast<DWORD>(start & 0xFFFFFFFFu), viewSize);
+    if (!view) return false;
+
+    range.view = static_cast<const char*>(view);
+    range.data = range.view + (offset - start);
+    range.viewSize = viewSize;
+    return true;
+}
+
+// Drop the view; the pages stay in the system cache until memory is needed
+void unmapFileRange(MappedRange& range) {
+    if (range.view) UnmapViewOfFile(range.view);
+    range = MappedRange();
+}
+
+// Query size and last-write time without opening the file
+bool getFileStamp(const char* path, FileStamp& stamp) {
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data)) return false;
+    stamp.size = (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    stamp.writeTime = (static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+    return true;
+}
+
+bool createOutputFile(const char* path, OutputFile& output) {
+    output = OutputFile();
+    HANDLE file = CreateFileA(path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    output.file = file;
+    return true;
+}
+
+// WriteFile takes a DWORD length, so large buffers go out in pieces
+bool writeOutputFile(OutputFile& output, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        DWORD chunk = size > 0x40000000 ? 0x40000000 : static_cast<DWORD>(size);
+        DWORD written = 0;
+        if (!WriteFile(output.file, p, chunk, &written, nullptr) || written == 0) return false;
+        p += written;
+        size -= written;
+    }
+    return true;
+}
+
+void closeOutputFile(OutputFile& output) {
+    if (output.file) CloseHandle(output.file);
+    output = OutputFile();
+}
+
+bool replaceFile(const char* path, const char* target) {
+    return MoveFileExA(path, target, MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
+void removeFile(const char* path) {
+    DeleteFileA(path);
+}
+
+#else
+
+// Map the whole file read-only
+bool openMappedFile(const char* path, MappedFile& mapped) {
+    if (!openFileMapping(path, mapped)) return false;
+    void* view = mmap(nullptr, mapped.size, PROT_READ, MAP_PRIVATE, mapped.descriptor, 0);
+    if (view == MAP_FAILED) {
+        closeMappedFile(mapped);
+        return false;
+    }
+    mapped.data = static_cast<const char*>(view);
+    return true;
+}
+
+// Release the view and the descriptor
+void closeMappedFile(MappedFile& mapped) {
+    if (mapped.data) munmap(const_cast<char*>(mapped.data), mapped.size);
+    if (mapped.descriptor >= 0) close(mapped.descriptor);
+    mapped = MappedFile();
+}
+
+// Nothing is mapped until a range is asked for; the descriptor stands in for the mapping object
+bool openFileMapping(const char* path, MappedFile& mapped) {
+    mapped = MappedFile();
+    mapped.descriptor = open(path, O_RDONLY);
+    if (mapped.descriptor < 0) return false;
+
+    struct stat status;
+    if (fstat(mapped.descriptor, &status) != 0 || status.st_size <= 0) {
+        closeMappedFile(mapped);
+        return false;
+    }
+    mapped.size = static_cast<size_t>(status.st_size);
+    return true;
+}
+
+// mmap offsets must be multiples of the page size, so the view starts a little early
+bool mapFileRange(const MappedFile& mapped, uint64_t offset, size_t size, MappedRange& range) {
+    range = MappedRange();
+    if (mapped.descriptor < 0 || offset > mapped.size || size > mapped.size - offset || size == 0) return false;
+
+    static const uint64_t granularity = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    const uint64_t start = offset / granularity * granularity;
+    const size_t viewSize = static_cast<size_t>(offset - start) + size;
+    void* view = mmap(nullptr, viewSize, PROT_READ, MAP_PRIVATE, mapped.descriptor, static_cast<off_t>(start));
+    if (view == MAP_FAILED) return false;
+
+    range.view = static_cast<const char*>(view);
+    range.data = range.view + (offset - start);
+    range.viewSize = viewSize;
+    return true;
+}
+
+// Drop the view; the pages stay in the page cache until memory is needed
+void unmapFileRange(MappedRange& range) {
+    if (range.view) munmap(const_cast<char*>(range.view), range.viewSize);
+    range = MappedRange();
+}
+
+// stat reads the inode without opening the file; st_mtim keeps the nanoseconds st_mtime drops
+bool getFileStamp(const char* path, FileStamp& stamp) {
+    struct stat status;
+    if (stat(path, &status) != 0) return false;
+    stamp.size = static_cast<uint64_t>(status.st_size);
+    stamp.writeTime = static_cast<uint64_t>(status.st_mtim.tv_sec) * 1000000000u + static_cast<uint64_t>(status.st_mtim.tv_nsec);
+    return true;
+}
+
+bool createOutputFile(const char* path, OutputFile& output) {
+    output = OutputFile();
+    output.descriptor = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    return output.descriptor >= 0;
+}
+
+// write may stop short of the request, and retries after a signal
+bool writeOutputFile(OutputFile& output, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = write(output.descriptor, p, size > 0x40000000 ? 0x40000000 : size);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        p += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+void closeOutputFile(OutputFile& output) {
+    if (output.descriptor >= 0) close(output.descriptor);
+    output = OutputFile();
+}
+
+// rename replaces the target atomically within one file system
+bool replaceFile(const char* path, const char* target) {
+    return rename(path, target) == 0;
+}
+
+void removeFile(const char* path) {
+    unlink(path);
+}
+
+#endif
+
+// Skip separators and line breaks alike
+void skipBlankLines(TextCursor& cursor) {
+    while (cursor.pos < cursor.end) {
+        char c = *cursor.pos;
+        if (c != ' ' && c != '\t' && c != ',' && !isLineEnd(c)) break;
+        ++cursor.pos;
+    }
+}
+
+// Skip field separators: spaces, tabs and commas
+void skipSeparators(TextCursor& cursor) {
+    while (cursor.pos < cursor.end && (*cursor.pos == ' ' || *cursor.pos == '\t' || *cursor.pos == ',')) {
+        ++cursor.pos;
+    }
+}
+
+// Move to the first character of the next line
+void skipLine(TextCursor& cursor) {
+    while (cursor.pos < cursor.end && !isLineEnd(*cursor.pos)) ++cursor.pos;
+    while (cursor.pos < cursor.end && isLineEnd(*cursor.pos)) ++cursor.pos;
+}
+
+// Parse an optionally signed integer
+bool parseInt(TextCursor& cursor, int& value) {
+    skipSeparators(cursor);
+    const char* p = cursor.pos;
+    bool negative = false;
+    if (p < cursor.end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    if (p >= cursor.end || !isDigit(*p)) return false;
+
+    int64_t result = 0;
+    while (p < cursor.end && isDigit(*p)) {
+        result = result * 10 + (*p - '0');
+        if (result > INT32_MAX) return false;
+        ++p;
+    }
+    value = static_cast<int>(negative ? -result : result);
+    cursor.pos = p;
+    return true;
+}
+
+// Parse a float as mantissa * 10^exponent, accumulating up to 19 significant digits exactly
+bool parseFloat(TextCursor& cursor, float& value) {
+    skipSeparators(cursor);
+    const char* p = cursor.pos;
+    bool negative = false;
+    if (p < cursor.end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+
+    // Integer part; digits beyond the 19th only shift the exponent
+    while (p < cursor.end && isDigit(*p)) {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa) ++digits;
+        }
+        else {
+            ++exponent;
+        }
+        any = true;
+        ++p;
+    }
+
+    // Fractional part
+    if (p < cursor.end && *p == '.') {
+        ++p;
+        while (p < cursor.end && isDigit(*p)) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                if (mantissa) ++digits;
+                --exponent;
+            }
+            any = true;
+            ++p;
+        }
+    }
+    if (!any) return false;
+
+    // Optional exponent
+    if (p < cursor.end && (*p == 'e' || *p == 'E')) {
+        const char* e = p + 1;
+        bool expNegative = false;
+        if (e < cursor.end && (*e == '-' || *e == '+')) {
+            expNegative = *e == '-';
+            ++e;
+        }
+        if (e < cursor.end && isDigit(*e)) {
+            int expValue = 0;
+            while (e < cursor.end && isDigit(*e)) {
+                if (expValue < 10000) expValue = expValue * 10 + (*e - '0');
+                ++e;
+            }
+            exponent += expNegative ? -expValue : expValue;
+            p = e;
+        }
+    }
+
+    double result = static_cast<double>(mantissa);
+    if (exponent != 0 && mantissa != 0) {
+        if (exponent > 0 && exponent <= 22) result *= POWERS_OF_TEN[exponent];
+        else if (exponent < 0 && exponent >= -22) result /= POWERS_OF_TEN[-exponent];
+        else result *= pow(10.0, exponent);
+    }
+    value = static_cast<float>(negative ? -result : result);
+    cursor.pos = p;
+    return true;
+}
+
+// Header: "vertexCount, faceCount"
+bool parseHeader(TextCursor& cursor, int& vertexCount, int& faceCount) {
+    skipBlankLines(cursor);
+    if (!parseInt(cursor, vertexCount) || !parseInt(cursor, faceCount)) return false;
+    skipLine(cursor);
+    return vertexCount >= 0 && faceCount >= 0;
+}
+
+// Vertex lines: "id, x, y, z"; anything after the fourth field is ignored
+bool parseVertices(TextCursor& cursor, int vertexCount, std::vector<Vertex>& vertices) {
+    for (int i = 0; i < vertexCount; ++i) {
+        skipBlankLines(cursor);
+        Vertex v;
+        if (!parseInt(cursor, v.id) || !parseFloat(cursor, v.x) || !parseFloat(cursor, v.y) || !parseFloat(cursor, v.z)) {
+            return false;
+        }
+        vertices.push_back(v);
+        skipLine(cursor);
+    }
+    return true;
+}
+
+// Face lines: "v1, v2, v3" using 1-based vertex indices
+bool parseFaces(TextCursor& cursor, int faceCount, int vertexCount, std::vector<Face>& faces) {
+    for (int i = 0; i < faceCount; ++i) {
+        skipBlankLines(cursor);
+        Face f;
+        if (!parseInt(cursor, f.v1) || !parseInt(cursor, f.v2) || !parseInt(cursor, f.v3)) return false;
+        if (f.v1 < 1 || f.v2 < 1 || f.v3 < 1 || f.v1 > vertexCount || f.v2 > vertexCount || f.v3 > vertexCount) return false;
+        faces.push_back(f);
+        skipLine(cursor);
+    }
+    return true;
+}
+
+// Map object.txt, reserve from the header counts, then parse both sections in place
+bool loadMeshFile(const char* path, std::vector<Vertex>& vertices, std::vector<Face>& faces) {
+    MappedFile mapped;
+    if (!openMappedFile(path, mapped)) return false;
+
+    TextCursor cursor = { mapped.data, mapped.data + mapped.size };
+    int vertexCount = 0, faceCount = 0;
+    bool ok = parseHeader(cursor, vertexCount, faceCount);
+
+    // Every record takes at least MIN_RECORD_BYTES, so counts the rest of the file cannot hold come from a
+    // corrupt header; reserving for them would throw instead of failing the load
+    ok = ok && static_cast<size_t>(vertexCount) + faceCount <= static_cast<size_t>(cursor.end - cursor.pos) / MIN_RECORD_BYTES;
+    if (ok) {
+        vertices.clear();
+        faces.clear();
+        vertices.reserve(vertexCount);
+        faces.reserve(faceCount);
+        ok = parseVertices(cursor, vertexCount, vertices) && parseFaces(cursor, faceCount, vertexCount, faces);
+    }
+
+    closeMappedFile(mapped);
+    return ok;
+}
+
+// Parallel load: count records per chunk, prefix-sum the counts, then parse every chunk into place
+bool loadMeshFileParallel(const char* path, std::vector<Vertex>& vertices, std::vector<Face>& faces, unsigned threadCount) {
+    if (threadCount == 0) threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0) threadCount = 1;
+
+    MappedFile mapped;
+    if (!openMappedFile(path, mapped)) return false;
+    if (threadCount == 1 || mapped.size < PARALLEL_PARSE_MIN_BYTES) {
+        closeMappedFile(mapped);
+        return loadMeshFile(path, vertices, faces);
+    }
+
+    TextCursor cursor = { mapped.data, mapped.data + mapped.size };
+    int vertexCount = 0, faceCount = 0;
+    if (!parseHeader(cursor, vertexCount, faceCount)) {
+        closeMappedFile(mapped);
+        return false;
+    }
+
+    // Several chunks per thread so uneven line lengths still balance out
+    const size_t bodySize = cursor.end - cursor.pos;
+    const size_t chunkCount = threadCount * 8;
+    std::vector<ParseChunk> chunks;
+    const char* chunkBegin = cursor.pos;
+    for (size_t i = 1; i <= chunkCount && chunkBegin < cursor.end; ++i) {
+        const char* chunkEnd = i == chunkCount ? cursor.end : cursor.pos + bodySize * i / chunkCount;
+        if (chunkEnd < chunkBegin) chunkEnd = chunkBegin;
+        const char* newline = static_cast<const char*>(memchr(chunkEnd, '\n', cursor.end - chunkEnd));
+        chunkEnd = newline ? newline + 1 : cursor.end;
+        chunks.push_back({ chunkBegin, chunkEnd, 0, 0 });
+        chunkBegin = chunkEnd;
+    }
+
+    forEachChunk(chunks.size(), threadCount, [&](size_t i) {
+        chunks[i].recordCount = countRecords(chunks[i].begin, chunks[i].end);
+        });
+
+    // The prefix sum places each chunk, which also finds the vertex/face boundary
+    size_t records = 0;
+    for (auto& chunk : chunks) {
+        chunk.firstRecord = records;
+        records += chunk.recordCount;
+    }
+
+    bool ok = records >= static_cast<size_t>(vertexCount) + faceCount;
+    if (ok) {
+        vertices.resize(vertexCount);
+        faces.resize(faceCount);
+        std::atomic<bool> failed(false);
+        forEachChunk(chunks.size(), threadCount, [&](size_t i) {
+            if (!parseChunk(chunks[i], vertexCount, faceCount, vertices.data(), faces.data())) failed = true;
+            });
+        ok = !failed;
+    }
+
+    closeMappedFile(mapped);
+    return ok;
+}
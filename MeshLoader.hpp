@@ -0,0 +1,130 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Fast object.txt loader: memory-maps the file and parses the
+//      header, vertex and face lines in place, without iostreams or
+//      per-line string allocations. Mapping uses the Win32 file
+//      mapping API on Windows and mmap everywhere else; the header
+//      itself includes no platform headers.
+//
+//      The caches' other file calls (stamp, write, replace) sit
+//      behind the same split, so nothing above this layer needs
+//      windows.h to read or write a file.
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Vertex;
+struct Face;
+
+// Read-only view of an entire file mapped into memory
+struct MappedFile {
+    const char* data = nullptr;          // First byte of the file
+    size_t size = 0;                     // File size in bytes
+#ifdef _WIN32
+    void* file = nullptr;                // Underlying file HANDLE, null rather than INVALID_HANDLE_VALUE when closed
+    void* mapping = nullptr;             // File mapping object HANDLE
+#else
+    int descriptor = -1;                 // Underlying file descriptor, which views are mapped from
+#endif
+};
+
+// Window onto part of a file opened with openFileMapping; views start on allocation-granularity (page) boundaries,
+// so data points into the view rather than at its start
+struct MappedRange {
+    const char* view = nullptr;         // Start of the mapped view
+    const char* data = nullptr;         // First requested byte
+    size_t viewSize = 0;                // Bytes mapped, at least the requested size
+};
+
+// File opened for writing from scratch
+struct OutputFile {
+#ifdef _WIN32
+    void* file = nullptr;                // File HANDLE, null rather than INVALID_HANDLE_VALUE when closed
+#else
+    int descriptor = -1;                 // File descriptor
+#endif
+};
+
+// Size and last-write time of a file, compared to tell whether derived files are stale
+struct FileStamp {
+    uint64_t size = 0;
+    uint64_t writeTime = 0;   // FILETIME ticks (100 ns since 1601) on Windows, nanoseconds since 1970 elsewhere
+};
+
+// Position within mapped text
+struct TextCursor {
+    const char* pos;    // Next unread character
+    const char* end;    // One past the last character
+};
+
+// Maps a file read-only; returns false if it cannot be opened or is empty
+bool openMappedFile(const char* path, MappedFile& mapped);
+
+// Unmaps the view and closes the file
+void closeMappedFile(MappedFile& mapped);
+
+// Opens a file and creates a read-only mapping without viewing any of it; data stays null until ranges are mapped
+bool openFileMapping(const char* path, MappedFile& mapped);
+
+// Maps bytes [offset, offset + size) of a file opened with openFileMapping; returns false if they are out of range
+bool mapFileRange(const MappedFile& mapped, uint64_t offset, size_t size, MappedRange& range);
+
+// Releases a view from mapFileRange
+void unmapFileRange(MappedRange& range);
+
+// Reads a file's size and last-write time without opening it; returns false if the file does not exist
+bool getFileStamp(const char* path, FileStamp& stamp);
+
+// Creates a file for writing, truncating any existing one
+bool createOutputFile(const char* path, OutputFile& output);
+
+// Writes all size bytes at the current position; returns false on a short write
+bool writeOutputFile(OutputFile& output, const void* data, size_t size);
+
+// Closes a file from createOutputFile; does nothing if it is not open
+void closeOutputFile(OutputFile& output);
+
+// Moves a finished file over target, replacing it, so readers see the old file or the new one but never a partial write
+bool replaceFile(const char* path, const char* target);
+
+// Deletes a file, such as a temporary one left by a failed write
+void removeFile(const char* path);
+
+// Skips spaces, tabs and commas on the current line
+void skipSeparators(TextCursor& cursor);
+
+// Skips whitespace including line breaks, so blank lines between records are ignored
+void skipBlankLines(TextCursor& cursor);
+
+// Advances past the end of the current line
+void skipLine(TextCursor& cursor);
+
+// Parses a signed decimal integer at the cursor (after separators); returns false if none is present
+bool parseInt(TextCursor& cursor, int& value);
+
+// Parses a decimal float with optional fraction and exponent; returns false if none is present
+bool parseFloat(TextCursor& cursor, float& value);
+
+// Parses the "vertexCount, faceCount" header line
+bool parseHeader(TextCursor& cursor, int& vertexCount, int& faceCount);
+
+// Parses vertexCount "id, x, y, z" lines, skipping blank ones, appending to vertices
+bool parseVertices(TextCursor& cursor, int vertexCount, std::vector<Vertex>& vertices);
+
+// Parses faceCount "v1, v2, v3" lines, skipping blank ones; indices must lie in [1, vertexCount]
+bool parseFaces(TextCursor& cursor, int faceCount, int vertexCount, std::vector<Face>& faces);
+
+// Loads a whole object.txt file through a memory mapping, reserving storage from the header counts.
+// Returns false if the header claims more records than the file has room for.
+bool loadMeshFile(const char* path, std::vector<Vertex>& vertices, std::vector<Face>& faces);
+
+// Files smaller than this are parsed on the calling thread; thread start-up would dominate
+const size_t PARALLEL_PARSE_MIN_BYTES = 4 << 20;
+
+// Like loadMeshFile, but splits the body into newline-aligned chunks parsed on worker threads.
+// threadCount 0 uses every hardware thread.
+bool loadMeshFileParallel(const char* path, std::vector<Vertex>& vertices, std::vector<Face>& faces, unsigned threadCount = 0);
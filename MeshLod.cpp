@@ -0,0 +1,117 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Level of Detail
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "MeshLod.hpp"
+#include "MeshTypes.hpp"
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+#undef min
+#undef max
+
+namespace {
+
+// Each level aims for this fraction of the previous level's faces
+const double LEVEL_REDUCTION = 0.25;
+
+// Resolution guesses are refined until the result lands within this factor of the target
+const double TARGET_TOLERANCE = 1.4;
+const int MAX_RESOLUTION_ATTEMPTS = 3;
+
+// Running sum of the positions collapsing into one cell
+struct Cluster {
+    double x, y, z;
+    uint32_t count;
+};
+
+} // namespace
+
+// Grid cells are cubes, so clusters stay isotropic on elongated models
+void clusterVertices(const std::vector<Vertex>& vertices, const std::vector<Face>& faces, int resolution, LodLevel& level) {
+    level.vertices.clear();
+    level.faces.clear();
+    if (vertices.empty() || resolution < 1) return;
+
+    float boundsMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float boundsMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (const auto& v : vertices) {
+        const float p[3] = { v.x, v.y, v.z };
+        for (int axis = 0; axis < 3; ++axis) {
+            if (p[axis] < boundsMin[axis]) boundsMin[axis] = p[axis];
+            if (p[axis] > boundsMax[axis]) boundsMax[axis] = p[axis];
+        }
+    }
+    float extent = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (boundsMax[axis] - boundsMin[axis] > extent) extent = boundsMax[axis] - boundsMin[axis];
+    }
+    const double cellsPerUnit = extent > 0 ? resolution / static_cast<double>(extent) : 0;
+
+    // Assign every source vertex a cluster, numbering clusters in order of first appearance
+    std::unordered_map<uint64_t, uint32_t> cellToCluster;
+    cellToCluster.reserve(vertices.size() / 4 + 16);
+    std::vector<Cluster> clusters;
+    std::vector<uint32_t> remap(vertices.size());
+    const uint64_t cells = static_cast<uint64_t>(resolution) + 1;
+
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        const Vertex& v = vertices[i];
+        uint64_t ix = static_cast<uint64_t>((v.x - boundsMin[0]) * cellsPerUnit);
+        uint64_t iy = static_cast<uint64_t>((v.y - boundsMin[1]) * cellsPerUnit);
+        uint64_t iz = static_cast<uint64_t>((v.z - boundsMin[2]) * cellsPerUnit);
+        uint64_t key = (iz * cells + iy) * cells + ix;
+
+        auto inserted = cellToCluster.emplace(key, static_cast<uint32_t>(clusters.size()));
+        if (inserted.second) clusters.push_back({ 0, 0, 0, 0 });
+        Cluster& cluster = clusters[inserted.first->second];
+        cluster.x += v.x;
+        cluster.y += v.y;
+        cluster.z += v.z;
+        ++cluster.count;
+        remap[i] = inserted.first->second;
+    }
+
+    level.vertices.reserve(clusters.size());
+    for (size_t i = 0; i < clusters.size(); ++i) {
+        const Cluster& c = clusters[i];
+        level.vertices.push_back({ static_cast<int>(i + 1),
+            static_cast<float>(c.x / c.count), static_cast<float>(c.y / c.count), static_cast<float>(c.z / c.count) });
+    }
+
+    // Triangles with two corners in one cell have collapsed to a line or a point
+    for (const auto& f : faces) {
+        uint32_t a = remap[f.v1 - 1], b = remap[f.v2 - 1], c = remap[f.v3 - 1];
+        if (a == b || b == c || c == a) continue;
+        level.faces.push_back({ static_cast<int>(a + 1), static_cast<int>(b + 1), static_cast<int>(c + 1) });
+    }
+}
+
+// Surface meshes keep roughly resolution^2 faces, which gives the first guess and each correction
+void buildLodChain(const std::vector<Vertex>& vertices, const std::vector<Face>& faces, std::vector<LodLevel>& chain) {
+    chain.clear();
+    if (faces.size() < LOD_MIN_SOURCE_FACES) return;
+
+    size_t previousFaces = faces.size();
+    while (chain.size() < LOD_MAX_LEVELS && previousFaces > LOD_FLOOR_FACES) {
+        const double target = previousFaces * LEVEL_REDUCTION;
+        double resolution = std::sqrt(target / 6);
+
+        LodLevel level;
+        for (int attempt = 0; attempt < MAX_RESOLUTION_ATTEMPTS; ++attempt) {
+            clusterVertices(vertices, faces, static_cast<int>(resolution < 2 ? 2 : resolution), level);
+            const double produced = level.faces.empty() ? 1.0 : static_cast<double>(level.faces.size());
+            if (produced < target * TARGET_TOLERANCE && produced > target / TARGET_TOLERANCE) break;
+            resolution *= std::sqrt(target / produced);
+        }
+
+        // A level that barely shrinks only costs memory
+        if (level.faces.empty() || level.faces.size() > previousFaces * 0.9) break;
+        previousFaces = level.faces.size();
+        chain.push_back(std::move(level));
+    }
+}
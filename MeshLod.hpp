@@ -0,0 +1,38 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Level-of-detail chain by vertex clustering: vertices are
+//      snapped to a uniform grid, each occupied cell collapses to the
+//      mean of its members and triangles that lose a corner are
+//      dropped. Each level holds about a quarter of the previous
+//      level's faces.
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstddef>
+#include <vector>
+
+struct Vertex;
+struct Face;
+
+// One simplified copy of the mesh, in the same coordinates and format as the source
+struct LodLevel {
+    std::vector<Vertex> vertices;   // 1-based ids like the loaded mesh
+    std::vector<Face> faces;
+};
+
+// Meshes with fewer faces than this are cheap enough to rotate at full detail
+const size_t LOD_MIN_SOURCE_FACES = 100000;
+
+// The chain stops once a level falls below this many faces, or after LOD_MAX_LEVELS levels
+const size_t LOD_FLOOR_FACES = 20000;
+const size_t LOD_MAX_LEVELS = 4;
+
+// While dragging, the viewer draws the finest level with at most this many faces
+const size_t LOD_DRAG_FACE_BUDGET = 250000;
+
+// Clusters vertices on a grid with `resolution` cells along the longest axis of the bounds
+void clusterVertices(const std::vector<Vertex>& vertices, const std::vector<Face>& faces, int resolution, LodLevel& level);
+
+// Builds successively coarser levels (finest first); leaves the chain empty for small meshes
+void buildLodChain(const std::vector<Vertex>& vertices, const std::vector<Face>& faces, std::vector<LodLevel>& chain);
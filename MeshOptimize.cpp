@@ -0,0 +1,164 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Mesh Layout
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "MeshOptimize.hpp"
+#include "MeshTypes.hpp"
+#include <cstdint>
+
+namespace {
+
+// Corner c (0..2) of a face as a 0-based vertex index
+uint32_t corner(const Face& f, int c) {
+    return static_cast<uint32_t>((c == 0 ? f.v1 : c == 1 ? f.v2 : f.v3) - 1);
+}
+
+// Vertex-to-face adjacency in compressed rows: the faces of vertex v are faceList[offsets[v]..offsets[v + 1])
+struct VertexFaces {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> faceList;
+};
+
+void buildVertexFaces(const std::vector<Face>& faces, size_t vertexCount, VertexFaces& adjacency) {
+    adjacency.offsets.assign(vertexCount + 1, 0);
+    for (const Face& f : faces) {
+        for (int c = 0; c < 3; ++c) ++adjacency.offsets[corner(f, c) + 1];
+    }
+    for (size_t v = 0; v < vertexCount; ++v) adjacency.offsets[v + 1] += adjacency.offsets[v];
+
+    std::vector<uint32_t> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+    adjacency.faceList.resize(faces.size() * 3);
+    for (size_t i = 0; i < faces.size(); ++i) {
+        for (int c = 0; c < 3; ++c) adjacency.faceList[fill[corner(faces[i], c)]++] = static_cast<uint32_t>(i);
+    }
+}
+
+} // namespace
+
+// Simulate the FIFO: a vertex is a hit while it was loaded fewer than cacheSize misses ago
+float averageCacheMissRatio(const std::vector<Face>& faces, size_t vertexCount, size_t cacheSize) {
+    if (faces.empty()) return 0;
+    std::vector<uint64_t> loadedAt(vertexCount, 0);
+    uint64_t misses = 0;
+    for (const Face& f : faces) {
+        for (int c = 0; c < 3; ++c) {
+            uint64_t& stamp = loadedAt[corner(f, c)];
+            if (stamp != 0 && misses + 1 - stamp <= cacheSize) continue;
+            stamp = ++misses;
+        }
+    }
+    return static_cast<float>(misses) / faces.size();
+}
+
+// Tipsify: fan out from a focus vertex, emitting all its remaining faces, then move the focus to the
+// cached neighbour that will stay cached longest, or back along the dead-end stack when none will
+void reorderFacesForCache(std::vector<Face>& faces, size_t vertexCount, size_t cacheSize) {
+    if (faces.empty() || vertexCount == 0) return;
+
+    VertexFaces adjacency;
+    buildVertexFaces(faces, vertexCount, adjacency);
+
+    std::vector<uint32_t> live(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+
+    // A vertex is cached while the timestamp has advanced by at most cacheSize since it was loaded
+    std::vector<uint64_t> cacheTime(vertexCount, 0);
+    uint64_t timestamp = cacheSize + 1;
+
+    std::vector<uint8_t> emitted(faces.size(), 0);
+    std::vector<Face> order;
+    order.reserve(faces.size());
+    std::vector<uint32_t> deadEnd;
+    std::vector<uint32_t> candidates;
+
+    size_t cursor = 0;          // Scan position for restarting once the stack runs dry
+    int64_t focus = 0;
+    while (focus >= 0) {
+        candidates.clear();
+        const uint32_t f = static_cast<uint32_t>(focus);
+        for (uint32_t k = adjacency.offsets[f]; k < adjacency.offsets[f + 1]; ++k) {
+            const uint32_t t = adjacency.faceList[k];
+            if (emitted[t]) continue;
+            emitted[t] = 1;
+            order.push_back(faces[t]);
+            for (int c = 0; c < 3; ++c) {
+                const uint32_t v = corner(faces[t], c);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+                if (timestamp - cacheTime[v] > cacheSize) cacheTime[v] = timestamp++;
+            }
+        }
+
+        // Prefer the candidate that entered the cache earliest but will survive emitting its remaining faces
+        focus = -1;
+        int64_t bestPriority = -1;
+        for (uint32_t v : candidates) {
+            if (live[v] == 0) continue;
+            int64_t priority = 0;
+            if (timestamp - cacheTime[v] + 2 * live[v] <= cacheSize) priority = static_cast<int64_t>(timestamp - cacheTime[v]);
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                focus = v;
+            }
+        }
+        if (focus >= 0) continue;
+
+        // Dead end: the most recently used vertex with faces left, else the next one in index order
+        while (!deadEnd.empty() && focus < 0) {
+            const uint32_t v = deadEnd.back();
+            deadEnd.pop_back();
+            if (live[v] > 0) focus = v;
+        }
+        while (focus < 0 && cursor < vertexCount) {
+            if (live[cursor] > 0) focus = static_cast<int64_t>(cursor);
+            ++cursor;
+        }
+    }
+    faces.swap(order);
+}
+
+// New index per old vertex, assigned as the faces are walked
+void reorderVerticesByFirstUse(std::vector<Vertex>& vertices, std::vector<Face>& faces, std::vector<uint32_t>* source) {
+    const uint32_t UNASSIGNED = 0xFFFFFFFFu;
+    std::vector<uint32_t> remap(vertices.size(), UNASSIGNED);
+    uint32_t next = 0;
+    for (Face& f : faces) {
+        int* corners[3] = { &f.v1, &f.v2, &f.v3 };
+        for (int* index : corners) {
+            uint32_t& slot = remap[*index - 1];
+            if (slot == UNASSIGNED) slot = next++;
+            *index = static_cast<int>(slot + 1);
+        }
+    }
+    for (uint32_t& slot : remap) {
+        if (slot == UNASSIGNED) slot = next++;
+    }
+
+    std::vector<Vertex> reordered(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        Vertex v = vertices[i];
+        v.id = static_cast<int>(remap[i] + 1);
+        reordered[remap[i]] = v;
+    }
+    vertices.swap(reordered);
+
+    if (source) {
+        std::vector<uint32_t> tags(source->size());
+        for (size_t i = 0; i < source->size(); ++i) tags[remap[i]] = (*source)[i];
+        source->swap(tags);
+    }
+}
+
+// Renumbering only relabels vertices, so it leaves the miss ratio of the new face order unchanged
+MeshLayoutStats optimizeMeshLayout(std::vector<Vertex>& vertices, std::vector<Face>& faces, std::vector<uint32_t>* source) {
+    MeshLayoutStats stats;
+    stats.acmrBefore = averageCacheMissRatio(faces, vertices.size());
+    reorderFacesForCache(faces, vertices.size());
+    reorderVerticesByFirstUse(vertices, faces, source);
+    stats.acmrAfter = averageCacheMissRatio(faces, vertices.size());
+    stats.optimized = true;
+    return stats;
+}
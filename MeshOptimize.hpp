@@ -0,0 +1,40 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Load-time mesh layout optimization: triangles are reordered
+//      for vertex reuse (Tipsify, Sander et al. 2007) and vertices
+//      are renumbered in the order the new face list first uses
+//      them, so the per-face loops walk memory almost sequentially.
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Vertex;
+struct Face;
+
+// FIFO size the reorder targets and the miss ratio is measured with; about what fits in L1
+// for the three position arrays, and the usual post-transform cache size on GPUs
+const size_t VERTEX_CACHE_SIZE = 32;
+
+// Average cache miss ratio before and after one optimization pass
+struct MeshLayoutStats {
+    bool optimized = false;     // False if the pass did not run (for example, the layout came from the cache)
+    float acmrBefore = 0;
+    float acmrAfter = 0;
+};
+
+// Vertex misses per triangle for a FIFO cache of cacheSize entries: 3 is no reuse, 0.5 is the ideal for large grids
+float averageCacheMissRatio(const std::vector<Face>& faces, size_t vertexCount, size_t cacheSize = VERTEX_CACHE_SIZE);
+
+// Reorders faces in place for a FIFO vertex cache (Tipsify); linear in the face count
+void reorderFacesForCache(std::vector<Face>& faces, size_t vertexCount, size_t cacheSize = VERTEX_CACHE_SIZE);
+
+// Renumbers vertices by first use in faces, unreferenced ones last, rewriting ids and face indices.
+// source, if given, is a per-vertex tag that is permuted along with the vertices.
+void reorderVerticesByFirstUse(std::vector<Vertex>& vertices, std::vector<Face>& faces, std::vector<uint32_t>* source = nullptr);
+
+// Both passes, measuring the miss ratio on either side; source as for reorderVerticesByFirstUse
+MeshLayoutStats optimizeMeshLayout(std::vector<Vertex>& vertices, std::vector<Face>& faces, std::vector<uint32_t>* source = nullptr);
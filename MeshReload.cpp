@@ -0,0 +1,196 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Mesh Hot Reload
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "MeshReload.hpp"
+#include "3DShaderViewer.hpp"
+#include "MeshCache.hpp"
+#include "MeshLoader.hpp"
+#include "MeshLod.hpp"
+#include "MeshOptimize.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+
+namespace {
+
+// Notification buffer; ReadDirectoryChangesW wants it DWORD-aligned
+const DWORD NOTIFY_BUFFER_BYTES = 16384;
+
+// True if the parsed faces are exactly the ones the basis was built from
+bool sameTopology(const MeshBasis& basis, size_t vertexCount, const std::vector<Face>& parsedFaces) {
+    if (basis.faces.empty() || vertexCount != basis.sourceVertexCount || parsedFaces.size() != basis.sourceFaces.size()) {
+        return false;
+    }
+    return std::equal(parsedFaces.begin(), parsedFaces.end(), basis.sourceFaces.begin(), [](const Face& a, const Face& b) {
+        return a.v1 == b.v1 && a.v2 == b.v2 && a.v3 == b.v3;
+    });
+}
+
+// True if any record in a filled notification buffer names the watched file
+bool mentionsFile(const BYTE* buffer, const std::wstring& fileName) {
+    for (;;) {
+        const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buffer);
+        const int length = static_cast<int>(info->FileNameLength / sizeof(WCHAR));
+        if (CompareStringOrdinal(info->FileName, length, fileName.c_str(), -1, TRUE) == CSTR_EQUAL) return true;
+        if (info->NextEntryOffset == 0) return false;
+        buffer += info->NextEntryOffset;
+    }
+}
+
+// Arms the next asynchronous read of the directory's change records
+bool queueDirectoryRead(HANDLE directory, BYTE* buffer, OVERLAPPED& overlapped) {
+    ResetEvent(overlapped.hEvent);
+    return ReadDirectoryChangesW(directory, buffer, NOTIFY_BUFFER_BYTES, FALSE,
+        FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_FILE_NAME, nullptr, &overlapped, nullptr) != 0;
+}
+
+// Builds a snapshot and hands it over; one that was never taken is simply replaced, and freed here
+void reloadMesh(MeshWatcher& watcher) {
+    std::shared_ptr<MeshSnapshot> snapshot = std::make_shared<MeshSnapshot>();
+    if (!buildMeshSnapshot(watcher.path.c_str(), watcher.optimizeLayout, watcher.compact, watcher.basis, *snapshot)) return;
+    snapshot->generation = ++watcher.reloads;
+    std::atomic_store(&watcher.pending, snapshot);
+    PostMessage(watcher.window, WM_MESH_RELOADED, 0, 0);
+}
+
+// Every notification restarts the settle timer; the file is read once it has been quiet for
+// MESH_RELOAD_SETTLE_MS. A read that returns no records means the buffer overflowed, so assume the file changed.
+void watchLoop(MeshWatcher& watcher, std::wstring fileName) {
+    alignas(DWORD) BYTE buffer[NOTIFY_BUFFER_BYTES];
+    OVERLAPPED overlapped = {};
+    overlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+    if (!overlapped.hEvent) return;
+
+    const HANDLE events[2] = { watcher.stopEvent, overlapped.hEvent };
+    bool changed = false;
+    bool reading = queueDirectoryRead(watcher.directory, buffer, overlapped);
+    while (reading) {
+        const DWORD wait = WaitForMultipleObjects(2, events, FALSE, changed ? MESH_RELOAD_SETTLE_MS : INFINITE);
+        if (wait == WAIT_OBJECT_0 + 1) {
+            DWORD bytes = 0;
+            if (!GetOverlappedResult(watcher.directory, &overlapped, &bytes, FALSE)) break;
+            if (bytes == 0 || mentionsFile(buffer, fileName)) changed = true;
+            reading = queueDirectoryRead(watcher.directory, buffer, overlapped);
+        }
+        else if (wait == WAIT_TIMEOUT) {
+            changed = false;
+            reloadMesh(watcher);
+        }
+        else {
+            break;
+        }
+    }
+
+    // The kernel may still write into buffer until the cancelled read completes
+    if (reading) {
+        DWORD bytes = 0;
+        CancelIoEx(watcher.directory, &overlapped);
+        GetOverlappedResult(watcher.directory, &overlapped, &bytes, TRUE);
+    }
+    CloseHandle(overlapped.hEvent);
+}
+
+} // namespace
+
+// A full reload runs the same pipeline as a cache miss in loadMeshCached; a positions-only one maps the new positions
+// into the previous render order and rebuilds only what depends on them. The LOD chain is rebuilt from the parsed
+// order either way, so both paths produce the same levels.
+bool buildMeshSnapshot(const char* path, bool optimizeLayout, bool compact, MeshBasis& basis, MeshSnapshot& snapshot) {
+    const LONGLONG start = profileNow();
+    FileStamp stamp;
+    std::vector<Vertex> parsed;
+    std::vector<Face> parsedFaces;
+    if (!getFileStamp(path, stamp) || !loadMeshFileParallel(path, parsed, parsedFaces)) return false;
+
+    std::vector<Vertex> positions;
+    std::vector<Face> faceList;
+    std::vector<LodLevel> lods;
+    std::vector<MeshBvh> bvhs;
+    snapshot.positionsOnly = sameTopology(basis, parsed.size(), parsedFaces);
+    if (snapshot.positionsOnly) {
+        positions.resize(parsed.size());
+        for (size_t i = 0; i < positions.size(); ++i) {
+            positions[i] = parsed[basis.vertexSource[i]];
+            positions[i].id = static_cast<int>(i + 1);
+        }
+        faceList = basis.faces;
+        buildLodLevels(parsed, parsedFaces, lods, bvhs, optimizeLayout);
+        bvhs[0] = basis.bvh;
+        refitMeshBvh(positions, faceList, bvhs[0]);
+    }
+    else {
+        basis.sourceVertexCount = parsed.size();
+        basis.sourceFaces = parsedFaces;
+        positions = std::move(parsed);
+        faceList = std::move(parsedFaces);
+        buildDerivedMeshData(positions, faceList, lods, bvhs, optimizeLayout, &basis.vertexSource);
+        basis.faces = faceList;
+        basis.bvh = bvhs[0];
+    }
+
+    // Best effort, as in loadMeshCached; the next launch then skips the parse
+    writeMeshCache(meshCachePath(path).c_str(), stamp, meshCacheFlags(optimizeLayout, compact), positions, faceList, lods, bvhs);
+
+    snapshot.frame = computeModelFrame(positions);
+    snapshot.levels.resize(lods.size() + 1);
+    buildDetailLevel(positions, faceList, bvhs[0], snapshot.frame, compact, snapshot.levels[0],
+        snapshot.positionsOnly ? &basis.edges : nullptr);
+    if (!snapshot.positionsOnly) basis.edges = snapshot.levels[0].edges;
+    for (size_t i = 0; i < lods.size(); ++i) {
+        buildDetailLevel(lods[i].vertices, lods[i].faces, bvhs[i + 1], snapshot.frame, compact, snapshot.levels[i + 1]);
+    }
+    snapshot.dragDetail = dragDetailLevel(snapshot.levels);
+    if (!compact) snapshot.vertices = std::move(positions);
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    snapshot.buildMs = (profileNow() - start) * 1000.0 / frequency.QuadPart;
+    return true;
+}
+
+// The directory is opened for overlapped reads, so the thread can wait on a change and the stop event together
+bool startMeshWatcher(MeshWatcher& watcher, const char* path, bool optimizeLayout, bool compact, HWND window) {
+    char fullPath[MAX_PATH];
+    char* fileName = nullptr;
+    const DWORD length = GetFullPathNameA(path, MAX_PATH, fullPath, &fileName);
+    if (length == 0 || length >= MAX_PATH || !fileName) return false;
+
+    WCHAR wideName[MAX_PATH];
+    if (!MultiByteToWideChar(CP_ACP, 0, fileName, -1, wideName, MAX_PATH)) return false;
+    const std::string directory(fullPath, fileName);
+
+    watcher.directory = CreateFileA(directory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (watcher.directory == INVALID_HANDLE_VALUE) return false;
+    watcher.stopEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+    if (!watcher.stopEvent) {
+        CloseHandle(watcher.directory);
+        watcher.directory = INVALID_HANDLE_VALUE;
+        return false;
+    }
+
+    watcher.path = fullPath;
+    watcher.optimizeLayout = optimizeLayout;
+    watcher.compact = compact;
+    watcher.window = window;
+    watcher.thread = std::thread(watchLoop, std::ref(watcher), std::wstring(wideName));
+    return true;
+}
+
+// Safe to call on a watcher that never started
+void stopMeshWatcher(MeshWatcher& watcher) {
+    if (watcher.thread.joinable()) {
+        SetEvent(watcher.stopEvent);
+        watcher.thread.join();
+    }
+    if (watcher.stopEvent) CloseHandle(watcher.stopEvent);
+    if (watcher.directory != INVALID_HANDLE_VALUE) CloseHandle(watcher.directory);
+    watcher.stopEvent = nullptr;
+    watcher.directory = INVALID_HANDLE_VALUE;
+    std::atomic_store(&watcher.pending, std::shared_ptr<MeshSnapshot>());
+}
+
+std::shared_ptr<MeshSnapshot> takeMeshSnapshot(MeshWatcher& watcher) {
+    return std::atomic_exchange(&watcher.pending, std::shared_ptr<MeshSnapshot>());
+}
@@ -0,0 +1,74 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Hot reload of the mesh text file. A watcher thread waits on
+//      ReadDirectoryChangesW for the file's directory, lets a burst
+//      of writes settle, then reparses the file and builds every
+//      render-ready detail level on that same thread. The finished
+//      MeshSnapshot is published through an atomic shared_ptr and
+//      the window is sent a message; the UI thread only swaps the
+//      snapshot into the render globals.
+//
+//      When the new file has the same vertex count and the same
+//      faces as the last reload, only positions moved: the face
+//      order, edge list and hierarchy of that reload are kept, the
+//      hierarchy is refitted and only normals, creases and the LOD
+//      chain are rebuilt.
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <windows.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MeshBvh.hpp"
+#include "MeshEdges.hpp"
+
+struct Face;
+struct MeshSnapshot;
+
+// Quiet time after the last change notification before the file is read; exports arrive in several writes
+const DWORD MESH_RELOAD_SETTLE_MS = 250;
+
+// Posted to the window when a snapshot is waiting in MeshWatcher::pending
+const UINT WM_MESH_RELOADED = WM_APP + 1;
+
+// What the watcher thread remembers of its last reload, to recognise a positions-only change
+struct MeshBasis {
+    size_t sourceVertexCount = 0;
+    std::vector<Face> sourceFaces;      // As parsed, before any reordering
+    std::vector<uint32_t> vertexSource; // Parsed index of each vertex in render order
+    std::vector<Face> faces;            // Render order: the leaf order of bvh
+    EdgeList edges;                     // Full-detail edge list; only its crease flags depend on positions
+    MeshBvh bvh;                        // Full-detail hierarchy; only its bounds and cones depend on positions
+};
+
+// One watched file and the thread that reloads it
+struct MeshWatcher {
+    std::string path;
+    bool optimizeLayout = false;        // Options the mesh was first loaded with, applied to every reload
+    bool compact = false;
+    HWND window = nullptr;              // Receives WM_MESH_RELOADED
+    HANDLE directory = INVALID_HANDLE_VALUE;
+    HANDLE stopEvent = nullptr;
+    std::thread thread;
+    MeshBasis basis;                    // Watcher thread only
+    uint64_t reloads = 0;               // Watcher thread only
+    std::shared_ptr<MeshSnapshot> pending;  // Latest finished reload; only accessed through std::atomic_load/store/exchange
+};
+
+// Reparses a mesh text file and builds a complete snapshot from it, reusing basis when only positions changed
+// and updating it. Refreshes the binary cache as loadMeshCached would. Returns false, leaving basis alone,
+// if the file cannot be read or parsed, which is expected while it is still being written.
+bool buildMeshSnapshot(const char* path, bool optimizeLayout, bool compact, MeshBasis& basis, MeshSnapshot& snapshot);
+
+// Starts watching path. Every reload uses the given layout and encoding options.
+bool startMeshWatcher(MeshWatcher& watcher, const char* path, bool optimizeLayout, bool compact, HWND window);
+
+// Stops the thread, after any reload in progress has finished, and closes the directory
+void stopMeshWatcher(MeshWatcher& watcher);
+
+// Takes the waiting snapshot, if any; called on the UI thread when WM_MESH_RELOADED arrives
+std::shared_ptr<MeshSnapshot> takeMeshSnapshot(MeshWatcher& watcher);
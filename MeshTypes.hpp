@@ -0,0 +1,29 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Mesh records shared by the loaders, the geometry passes and
+//      the renderers. Nothing here depends on the platform.
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// Structure representing a vertex in 3D space
+struct Vertex {
+    int id;     // Vertex identifier
+    float x;    // X coordinate
+    float y;    // Y coordinate
+    float z;    // Z coordinate
+};
+
+// Structure representing a triangular face using 1-based vertex indices
+struct Face {
+    int v1;     // Index of first vertex
+    int v2;     // Index of second vertex
+    int v3;     // Index of third vertex
+};
+
+// Centroid and radius of the full-detail mesh; every detail level is normalized with it so the levels line up
+struct ModelFrame {
+    float cx, cy, cz;   // Centroid
+    float extent;       // Largest distance from the centroid
+};
@@ -0,0 +1,420 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Kernel Microbenchmarks
+//
+//       The load, normal, transform, sort and fill kernels timed one at
+//       a time with Google Benchmark on synthetic tori of several sizes,
+//       each original version next to the optimized ones that replaced
+//       it (mmap and parallel parsers, SoA normals, SSE and AVX2
+//       projection, radix and incremental depth sort, tiled fill). Only
+//       the portable core is used, so the microbench target builds
+//       wherever Google Benchmark does; its usual flags apply, e.g.
+//       --benchmark_filter=project and --benchmark_format=json.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "DepthSort.hpp"
+#include "MeshLoader.hpp"
+#include "MeshTypes.hpp"
+#include "RenderCore.hpp"
+#include "SyntheticMesh.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+
+// Triangle counts of the test meshes, each registered as one Arg
+const int64_t MESH_SIZES[] = { 10000, 100000, 1000000 };
+
+// The viewer's window size, for the fills
+const int FRAME_WIDTH = 800;
+const int FRAME_HEIGHT = 600;
+
+// A generated torus in every form the kernels start from, built once per size and kept for the whole run
+struct TestMesh {
+    std::string path;               // Text form, in the temp directory
+    std::vector<Vertex> vertices;   // As parsed, for the AoS baselines
+    std::vector<Face> faces;
+    RenderMesh mesh;                // Normalized, with normals and a hierarchy, as the renderer holds it
+
+    ~TestMesh() { std::remove(path.c_str()); }
+};
+
+// The test mesh of a size, generated, written out and prepared on first use
+const TestMesh& testMesh(int64_t triangles) {
+    static std::map<int64_t, std::unique_ptr<TestMesh>> meshes;
+    std::unique_ptr<TestMesh>& entry = meshes[triangles];
+    if (!entry) {
+        entry.reset(new TestMesh);
+        generateSyntheticMesh(SyntheticShape::Torus, static_cast<size_t>(triangles), entry->vertices, entry->faces);
+        entry->path = (std::filesystem::temp_directory_path() / ("micro_" + std::to_string(triangles) + ".txt")).string();
+        writeMeshFile(entry->path.c_str(), entry->vertices, entry->faces);
+        std::vector<Vertex> positions = entry->vertices;
+        std::vector<Face> faceList = entry->faces;
+        buildRenderMesh(positions, faceList, entry->mesh);
+    }
+    return *entry;
+}
+
+// Registers a benchmark once per test mesh size
+void meshSizes(benchmark::internal::Benchmark* b) {
+    for (int64_t size : MESH_SIZES) b->Arg(size);
+}
+
+// Items per second in the report: vertices, faces or triangles processed, per iteration
+void setItems(benchmark::State& state, size_t items) {
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * items));
+}
+
+// The original line reader: getline, commas to spaces, then a stringstream per line
+std::vector<Vertex> loadVerticesIostream(std::ifstream& file, int vertexCount) {
+    std::vector<Vertex> vertices;
+    std::string line;
+    for (int i = 0; i < vertexCount; ++i) {
+        std::getline(file, line);
+        if (line.empty()) { --i; continue; }
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream iss(line);
+        Vertex v;
+        iss >> v.id >> v.x >> v.y >> v.z;
+        vertices.push_back(v);
+    }
+    return vertices;
+}
+
+// The same for faces
+std::vector<Face> loadFacesIostream(std::ifstream& file, int faceCount) {
+    std::vector<Face> faces;
+    std::string line;
+    for (int i = 0; i < faceCount; ++i) {
+        std::getline(file, line);
+        if (line.empty()) { --i; continue; }
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream iss(line);
+        Face f;
+        iss >> f.v1 >> f.v2 >> f.v3;
+        faces.push_back(f);
+    }
+    return faces;
+}
+
+// Where the vertex and face blocks of a text mesh start, so each reader can begin at its own block
+struct TextBlocks {
+    MappedFile mapped;
+    TextCursor vertices;
+    TextCursor faces;
+    int vertexCount = 0;
+    int faceCount = 0;
+
+    ~TextBlocks() { closeMappedFile(mapped); }
+};
+
+bool findTextBlocks(const char* path, TextBlocks& blocks) {
+    if (!openMappedFile(path, blocks.mapped)) return false;
+    TextCursor cursor = { blocks.mapped.data, blocks.mapped.data + blocks.mapped.size };
+    std::vector<Vertex> parsed;
+    if (!parseHeader(cursor, blocks.vertexCount, blocks.faceCount)) return false;
+    blocks.vertices = cursor;
+    if (!parseVertices(cursor, blocks.vertexCount, parsed)) return false;
+    blocks.faces = cursor;
+    return true;
+}
+
+void loadVerticesIostreamBenchmark(benchmark::State& state) {
+    const TestMesh& test = testMesh(state.range(0));
+    TextBlocks blocks;
+    if (!findTextBlocks(test.path.c_str(), blocks)) return state.SkipWithError("could not parse the test mesh");
+    std::ifstream file(test.path);
+    for (auto _ : state) {
+        file.clear();
+        file.seekg(blocks.vertices.pos - blocks.mapped.data);
+        benchmark::DoNotOptimize(loadVerticesIostream(file, blocks.vertexCount));
+    }
+    setItems(state, blocks.vertexCount);
+}
+
+void loadVerticesMmapBenchmark(benchmark::State& state) {
+    const TestMesh& test = testMesh(state.range(0));
+    TextBlocks blocks;
+    if (!findTextBlocks(test.path.c_str(), blocks)) return state.SkipWithError("could not parse the test mesh");
+    std::vector<Vertex> parsed;
+    for (auto _ : state) {
+        TextCursor block = blocks.vertices;
+        parsed.clear();
+        parseVertices(block, blocks.vertexCount, parsed);
+    }
+    setItems(state, blocks.vertexCount);
+}
+
+void loadFacesIostreamBenchmark(benchmark::State& state) {
+    const TestMesh& test = testMesh(state.range(0));
+    TextBlocks blocks;
+    if (!findTextBlocks(test.path.c_str(), blocks)) return state.SkipWithError("could not parse the test mesh");
+    std::ifstream file(test.path);
+    for (auto _ : state) {
+        file.clear();
+        file.seekg(blocks.faces.pos - blocks.mapped.data);
+        benchmark::DoNotOptimize(loadFacesIostream(file, blocks.faceCount));
+    }
+    setItems(state, blocks.faceCount);
+}
+
+void loadFacesMmapBenchmark(benchmark::State& state) {
+    const TestMesh& test = testMesh(state.range(0));
+    TextBlocks blocks;
+    if (!findTextBlocks(test.path.c_str(), blocks)) return state.SkipWithError("could not parse the test mesh");
+    std::vector<Face> parsed;
+    for (auto _ : state) {
+        TextCursor block = blocks.faces;
+        parsed.clear();
+        parseFaces(block, blocks.faceCount, blocks.vertexCount, parsed);
+    }
+    setItems(state, blocks.faceCount);
+}
+
+// Whole files, mapping and header included
+void loadMeshMmapBenchmark(benchmark::State& state) {
+    const TestMesh& test = testMesh(state.range(0));
+    std::vector<Vertex> vertices;
+    std::vector<Face> faces;
+    for (auto _ : state) loadMeshFile(test.path.c_str(), vertices, faces);
+    setItems(state, test.faces.size());
+}
+
+void loadMeshParallelBenchmark(benchmark::State& state) {
+    const TestMesh& test = testMesh(state.range(0));
+    std::vector<Vertex> vertices;
+    std::vector<Face> faces;
+    for (auto _ : state) loadMeshFileParallel(test.path.c_str(), vertices, faces);
+    setItems(state, test.faces.size());
+}
+
+// The per-face cross product read from the parsed Vertex structs, as before the positions moved into a VertexStream
+void computeFaceNormalsAos(const std::vector<Vertex>& positions, const std::vector<Face>& faceList, std::vector<Vertex>& normals) {
+    normals.resize(faceList.size());
+    for (size_t i = 0; i < faceList.size(); ++i) {
+        const Vertex& a = positions[faceList[i].v1 - 1];
+        const Vertex& b = positions[faceList[i].v2 - 1];
+        const Vertex& c = positions[faceList[i].v3 - 1];
+        const float ux = b.x - a.x, uy = b.y - a.y, uz = b.z - a.z;
+        const float vx = c.x - a.x, vy = c.y - a.y, vz = c.z - a.z;
+        const float nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+        const float length = sqrtf(nx * nx + ny * ny + nz * nz);
+        const float scale = length < 1e-6f ? 0 : 1 / length;
+        normals[i].x = nx * scale;
+        normals[i].y = ny * scale;
+        normals[i].z = nz * scale;
+    }
+}
+
+void normalsAosBenchmark(benchmark::State& state) {
+    const TestMesh& test = testMesh(state.range(0));
+    std::vector<Vertex> normals;
+    for (auto _ : state) computeFaceNormalsAos(test.vertices, test.faces, normals);
+    setItems(state, test.faces.size());
+}
+
+void normalsSoaBenchmark(benchmark::State& state) {
+    const DetailLevel& level = testMesh(state.range(0)).mesh.level;
+    VertexStream normals;
+    std::vector<uint8_t> degenerate;
+    for (auto _ : state) computeFaceNormals(level.normalized, level.faces, normals, degenerate);
+    setItems(state, level.faceCount);
+}
+
+// Projection alone with one kernel; a CPU without the kernel skips it
+void projectBenchmark(benchmark::State& state, TransformKernel kernel) {
+    if (supportedTransformKernel(kernel) != kernel) return state.SkipWithError("kernel not supported on this CPU");
+    const DetailLevel& level = testMesh(state.range(0)).mesh.level;
+    const ViewState view = makeViewState(30, 45, fitProjection(FRAME_WIDTH, FRAME_HEIGHT));
+    ScreenStream out;
+    resizeScreenStream(out, level.normalized.count);
+    for (auto _ : state) transformVertices(level.normalized, view.screen, kernel, out);
+    setItems(state, level.normalized.count);
+}
+
+// The same from 16-bit positions, dequantizing on the fly
+void projectCompactBenchmark(benchmark::State& state, TransformKernel kernel) {
+    if (supportedTransformKernel(kernel) != kernel) return state.SkipWithError("kernel not supported on this CPU");
+    const DetailLevel& level = testMesh(state.range(0)).mesh.level;
+    const ViewState view = makeViewState(30, 45, fitProjection(FRAME_WIDTH, FRAME_HEIGHT));
+    QuantizedStream packed;
+    quantizeVertexStream(level.normalized, packed);
+    ScreenStream out;
+    resizeScreenStream(out, packed.count);
+    for (auto _ : state) transformQuantizedVertices(packed, view.screen, kernel, out);
+    setItems(state, packed.count);
+}
+
+// The whole per-frame transform: vertices projected and face normals rotated, the view turning half a degree a frame
+void projectLevelBenchmark(benchmark::State& state, TransformKernel kernel) {
+    if (supportedTransformKernel(kernel) != kernel) return state.SkipWithError("kernel not supported on this CPU");
+    const DetailLevel& level = testMesh(state.range(0)).mesh.level;
+    const Projection projection = fitProjection(FRAME_WIDTH, FRAME_HEIGHT);
+    RenderContext context;
+    context.kernel = kernel;
+    float angleY = 45;
+    for (auto _ : state) {
+        angleY += 0.5f;
+        projectLevel(level, makeViewState(30, angleY, projection), context);
+    }
+    setItems(state, level.vertexCount);
+}
+
+// Face depths as the painter's path keys them, from a projected screen stream
+void faceDepths(const DetailLevel& level, const ScreenStream& screen, std::vector<float>& depth) {
+    depth.resize(level.faces.size());
+    for (size_t i = 0; i < level.faces.size(); ++i) {
+        const Face& f = level.faces[i];
+        depth[i] = screen.z[f.v1 - 1] + screen.z[f.v2 - 1] + screen.z[f.v3 - 1];
+    }
+}
+
+// Depth keys of two views half a degree apart, for the sorts
+void sortKeys(const DetailLevel& level, std::vector<float> (&depth)[2]) {
+    const Projection projection = fitProjection(FRAME_WIDTH, FRAME_HEIGHT);
+    RenderContext context;
+    projectLevel(level, makeViewState(30, 45, projection), context);
+    faceDepths(level, context.screen, depth[0]);
+    projectLevel(level, makeViewState(30, 45.5f, projection), context);
+    faceDepths(level, context.screen, depth[1]);
+}
+
+void sortStdBenchmark(benchmark::State& state) {
+    const DetailLevel& level = testMesh(state.range(0)).mesh.level;
+    std::vector<float> depth[2];
+    sortKeys(level, depth);
+    std::vector<uint32_t> order(level.faceCount);
+    const float* keys = depth[0].data();
+    for (auto _ : state) {
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+    }
+    setItems(state, level.faceCount);
+}
+
+// A full radix sort from scratch every time
+void sortRadixBenchmark(benchmark::State& state) {
+    const DetailLevel& level = testMesh(state.range(0)).mesh.level;
+    std::vector<float> depth[2];
+    sortKeys(level, depth);
+    DepthSorter sorter;
+    for (auto _ : state) {
+        sorter.order.clear();
+        sortByDepth(sorter, depth[0].data(), level.faceCount);
+    }
+    setItems(state, level.faceCount);
+}
+
+// The radix sorter's refresh as the view turns back and forth by half a degree
+void sortIncrementalBenchmark(benchmark::State& state) {
+    const DetailLevel& level = testMesh(state.range(0)).mesh.level;
+    std::vector<float> depth[2];
+    sortKeys(level, depth);
+    DepthSorter sorter;
+    size_t frame = 0;
+    for (auto _ : state) sortByDepth(sorter, depth[++frame & 1].data(), level.faceCount);
+    setItems(state, level.faceCount);
+}
+
+// The front faces of one view, shaded, over a projected context
+struct FillScene {
+    RenderContext context;
+    std::vector<ScreenTriangle> triangles;
+    std::vector<uint32_t> pixels = std::vector<uint32_t>(static_cast<size_t>(FRAME_WIDTH) * FRAME_HEIGHT);
+    FrameBuffer frame;
+};
+
+void prepareFillScene(const DetailLevel& level, FillScene& scene) {
+    projectLevel(level, makeViewState(30, 45, fitProjection(FRAME_WIDTH, FRAME_HEIGHT)), scene.context);
+    for (size_t i = 0; i < level.faces.size(); ++i) {
+        const float nz = scene.context.normalDepth[i];
+        if (level.degenerateFaces[i] || nz <= 0) continue;
+        const Face& f = level.faces[i];
+        scene.triangles.push_back({ { static_cast<uint32_t>(f.v1 - 1), static_cast<uint32_t>(f.v2 - 1), static_cast<uint32_t>(f.v3 - 1) },
+            packPixel(0, 0, shadeBlue(nz)) });
+    }
+    attachFrameBuffer(scene.frame, scene.pixels.data(), FRAME_WIDTH, FRAME_HEIGHT);
+}
+
+// One triangle at a time on the calling thread
+void fillSerialBenchmark(benchmark::State& state) {
+    FillScene scene;
+    prepareFillScene(testMesh(state.range(0)).mesh.level, scene);
+    const ScreenVertexArrays arrays = screenArrays(scene.context);
+    const uint32_t background = packPixel(255, 255, 255);
+    for (auto _ : state) {
+        clearFrameBuffer(scene.frame, background);
+        for (const ScreenTriangle& t : scene.triangles) {
+            const ScreenVertex a = { arrays.x[t.v[0]], arrays.y[t.v[0]], arrays.z[t.v[0]] };
+            const ScreenVertex b = { arrays.x[t.v[1]], arrays.y[t.v[1]], arrays.z[t.v[1]] };
+            const ScreenVertex c = { arrays.x[t.v[2]], arrays.y[t.v[2]], arrays.z[t.v[2]] };
+            fillTriangle(scene.frame, a, b, c, t.color);
+        }
+    }
+    setItems(state, scene.triangles.size());
+}
+
+// Binned and filled on the tile renderer, with a worker per hardware thread
+void fillTiledBenchmark(benchmark::State& state) {
+    FillScene scene;
+    prepareFillScene(testMesh(state.range(0)).mesh.level, scene);
+    TileRendererConfig config;
+    config.threadCount = 0;
+    configureTileRenderer(scene.context.tiles, config);
+    const ScreenVertexArrays arrays = screenArrays(scene.context);
+    const uint32_t background = packPixel(255, 255, 255);
+    for (auto _ : state) {
+        resetFrameArena(scene.context.arena);
+        if (binTiles(scene.context.tiles, scene.context.arena, scene.frame, arrays, scene.triangles.data(), scene.triangles.size())) {
+            fillTiles(scene.context.tiles, scene.frame, arrays, scene.triangles.data(), background);
+        }
+    }
+    setItems(state, scene.triangles.size());
+}
+
+} // namespace
+
+BENCHMARK(loadVerticesIostreamBenchmark)->Name("loadVertices/iostream")->Apply(meshSizes);
+BENCHMARK(loadVerticesMmapBenchmark)->Name("loadVertices/mmap")->Apply(meshSizes);
+BENCHMARK(loadFacesIostreamBenchmark)->Name("loadFaces/iostream")->Apply(meshSizes);
+BENCHMARK(loadFacesMmapBenchmark)->Name("loadFaces/mmap")->Apply(meshSizes);
+BENCHMARK(loadMeshMmapBenchmark)->Name("loadMesh/mmap")->Apply(meshSizes);
+BENCHMARK(loadMeshParallelBenchmark)->Name("loadMesh/parallel")->Apply(meshSizes)->UseRealTime();
+BENCHMARK(normalsAosBenchmark)->Name("normals/aos")->Apply(meshSizes);
+BENCHMARK(normalsSoaBenchmark)->Name("normals/soa")->Apply(meshSizes);
+BENCHMARK_CAPTURE(projectBenchmark, scalar, TransformKernel::Scalar)->Name("project/scalar")->Apply(meshSizes);
+BENCHMARK_CAPTURE(projectBenchmark, sse, TransformKernel::SSE)->Name("project/sse")->Apply(meshSizes);
+BENCHMARK_CAPTURE(projectBenchmark, avx2, TransformKernel::AVX2)->Name("project/avx2")->Apply(meshSizes);
+BENCHMARK_CAPTURE(projectCompactBenchmark, scalar, TransformKernel::Scalar)->Name("projectCompact/scalar")->Apply(meshSizes);
+BENCHMARK_CAPTURE(projectCompactBenchmark, sse, TransformKernel::SSE)->Name("projectCompact/sse")->Apply(meshSizes);
+BENCHMARK_CAPTURE(projectCompactBenchmark, avx2, TransformKernel::AVX2)->Name("projectCompact/avx2")->Apply(meshSizes);
+BENCHMARK_CAPTURE(projectLevelBenchmark, scalar, TransformKernel::Scalar)->Name("projectLevel/scalar")->Apply(meshSizes);
+BENCHMARK_CAPTURE(projectLevelBenchmark, sse, TransformKernel::SSE)->Name("projectLevel/sse")->Apply(meshSizes);
+BENCHMARK_CAPTURE(projectLevelBenchmark, avx2, TransformKernel::AVX2)->Name("projectLevel/avx2")->Apply(meshSizes);
+BENCHMARK(sortStdBenchmark)->Name("sort/std")->Apply(meshSizes);
+BENCHMARK(sortRadixBenchmark)->Name("sort/radix")->Apply(meshSizes);
+BENCHMARK(sortIncrementalBenchmark)->Name("sort/incremental")->Apply(meshSizes);
+BENCHMARK(fillSerialBenchmark)->Name("fill/serial")->Apply(meshSizes);
+BENCHMARK(fillTiledBenchmark)->Name("fill/tiled")->Apply(meshSizes)->UseRealTime();
+
+// The context block records what the results depend on beyond the CPU Google Benchmark already lists
+int main(int argc, char** argv) {
+    benchmark::AddCustomContext("transform_kernel", transformKernelName(detectTransformKernel()));
+    benchmark::AddCustomContext("hardware_threads", std::to_string(std::thread::hardware_concurrency()));
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
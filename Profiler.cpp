@@ -0,0 +1,144 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Frame Profiler
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cstdio>
+
+#undef min
+#undef max
+
+Profiler profiler;
+
+namespace {
+
+const char* STAGE_NAMES[STAGE_COUNT] = {
+    "Transform", "Cull", "Sort/Bin", "Fill", "Wireframe", "Dots", "Blit"
+};
+
+// Number of valid frames in the ring
+size_t windowSize() {
+    return profiler.window.size() < PROFILE_WINDOW ? profiler.window.size() : PROFILE_WINDOW;
+}
+
+// A stage's time in one frame, or the whole render for stage == STAGE_COUNT
+double stageValue(const FrameProfile& frame, int stage) {
+    return stage == STAGE_COUNT ? frame.renderMs : frame.stageMs[stage];
+}
+
+} // namespace
+
+// Switch on with fresh statistics so the overlay only reflects the current configuration
+void setProfilerEnabled(bool enabled) {
+    if (enabled && !profiler.enabled) {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        profiler.frequency = frequency.QuadPart;
+        profiler.lastFrameEnd = profileNow();
+        std::fill(profiler.current, profiler.current + STAGE_COUNT, 0.0);
+        profiler.window.clear();
+        profiler.windowNext = 0;
+    }
+    profiler.enabled = enabled;
+}
+
+// Move the accumulated stage times into the ring (and the log)
+void endProfileFrame() {
+    if (!profiler.enabled) return;
+
+    LONGLONG now = profileNow();
+    FrameProfile frame;
+    frame.renderMs = 0;
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        frame.stageMs[s] = profiler.current[s];
+        frame.renderMs += profiler.current[s];
+        profiler.current[s] = 0;
+    }
+    frame.intervalMs = (now - profiler.lastFrameEnd) * 1000.0 / profiler.frequency;
+    profiler.lastFrameEnd = now;
+
+    if (profiler.window.size() < PROFILE_WINDOW) {
+        profiler.window.push_back(frame);
+    }
+    else {
+        profiler.window[profiler.windowNext] = frame;
+    }
+    profiler.windowNext = (profiler.windowNext + 1) % PROFILE_WINDOW;
+
+    if (profiler.logFrames) profiler.log.push_back(frame);
+}
+
+// Average and 99th percentile over the window
+StageSummary summarizeStage(int stage) {
+    StageSummary summary = { 0, 0 };
+    const size_t n = windowSize();
+    if (n == 0) return summary;
+
+    double values[PROFILE_WINDOW];
+    for (size_t i = 0; i < n; ++i) {
+        values[i] = stageValue(profiler.window[i], stage);
+        summary.averageMs += values[i];
+    }
+    summary.averageMs /= n;
+
+    size_t rank = (n * 99 + 99) / 100 - 1;
+    std::nth_element(values, values + rank, values + n);
+    summary.p99Ms = values[rank];
+    return summary;
+}
+
+// Frames completed per second of wall time across the window
+double profiledFps() {
+    const size_t n = windowSize();
+    double total = 0;
+    for (size_t i = 0; i < n; ++i) total += profiler.window[i].intervalMs;
+    return total > 0 ? n * 1000.0 / total : 0.0;
+}
+
+const char* profileStageName(int stage) {
+    return stage < STAGE_COUNT ? STAGE_NAMES[stage] : "Render";
+}
+
+// One line of text per stage in a fixed-width font on an opaque background
+void drawProfilerOverlay(HDC hdc, const char* heading) {
+    HGDIOBJ oldFont = SelectObject(hdc, GetStockObject(ANSI_FIXED_FONT));
+    SetBkMode(hdc, OPAQUE);
+    SetTextColor(hdc, RGB(0, 0, 0));
+
+    const int lineHeight = 14;
+    int y = 4;
+    char line[128];
+    int length = snprintf(line, sizeof(line), "%s  %.1f fps", heading, profiledFps());
+    TextOutA(hdc, 4, y, line, length);
+    y += lineHeight;
+
+    for (int stage = 0; stage <= STAGE_COUNT; ++stage) {
+        StageSummary summary = summarizeStage(stage);
+        length = snprintf(line, sizeof(line), "%-10s avg %7.2f  p99 %7.2f ms", profileStageName(stage), summary.averageMs, summary.p99Ms);
+        TextOutA(hdc, 4, y, line, length);
+        y += lineHeight;
+    }
+
+    SelectObject(hdc, oldFont);
+}
+
+// frame, one column per stage, render total, interval
+bool writeProfileCsv(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+
+    fprintf(file, "frame");
+    for (int stage = 0; stage < STAGE_COUNT; ++stage) fprintf(file, ",%s_ms", profileStageName(stage));
+    fprintf(file, ",render_ms,interval_ms\n");
+
+    for (size_t i = 0; i < profiler.log.size(); ++i) {
+        const FrameProfile& frame = profiler.log[i];
+        fprintf(file, "%zu", i);
+        for (int stage = 0; stage < STAGE_COUNT; ++stage) fprintf(file, ",%.4f", frame.stageMs[stage]);
+        fprintf(file, ",%.4f,%.4f\n", frame.renderMs, frame.intervalMs);
+    }
+    return fclose(file) == 0;
+}
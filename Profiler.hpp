@@ -0,0 +1,102 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Frame profiler: QueryPerformanceCounter timers per render
+//      stage, rolling averages / p99 / fps for the overlay, and an
+//      optional per-frame CSV log. When disabled each scope costs a
+//      single branch, so timings can be compared within one build.
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <windows.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Timed stages of a frame
+enum ProfileStage {
+    STAGE_TRANSFORM,    // applyTransform
+    STAGE_CULL,         // cullFaces
+    STAGE_SORT,         // Painter's depth sort, or triangle binning on the tile path
+    STAGE_FILL,         // Face shading and fill
+    STAGE_WIREFRAME,    // Edge overlay
+    STAGE_DOTS,         // Vertex dots
+    STAGE_BLIT,         // BitBlt to the window
+    STAGE_COUNT
+};
+
+// Timings of one completed frame, in milliseconds
+struct FrameProfile {
+    double stageMs[STAGE_COUNT];
+    double renderMs;        // Sum of the stages
+    double intervalMs;      // Time since the previous frame ended
+};
+
+// Rolling statistics over the recent window
+struct StageSummary {
+    double averageMs;
+    double p99Ms;
+};
+
+// Profiler state; a single global instance is shared by the whole viewer
+struct Profiler {
+    bool enabled = false;                   // Master switch; scopes do nothing while false
+    bool logFrames = false;                 // Keep every frame for the CSV dump
+    std::string csvPath;                    // Where the CSV goes on exit (empty: no dump)
+    LONGLONG frequency = 0;                 // QueryPerformanceFrequency ticks per second
+    LONGLONG lastFrameEnd = 0;              // Counter value when the previous frame ended
+    double current[STAGE_COUNT] = {};       // Stage time accumulated for the frame in progress
+    std::vector<FrameProfile> window;       // Ring buffer of recent frames
+    size_t windowNext = 0;                  // Next ring slot to overwrite
+    std::vector<FrameProfile> log;          // Every frame since start, if logFrames
+};
+
+extern Profiler profiler;
+
+// Number of recent frames the overlay statistics cover
+const size_t PROFILE_WINDOW = 120;
+
+// Reads the performance counter
+inline LONGLONG profileNow() {
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+    return t.QuadPart;
+}
+
+// Adds the time since start, a profileNow reading taken while enabled (0 otherwise), to one stage of the current frame
+inline void addProfileTime(ProfileStage stage, LONGLONG start) {
+    if (profiler.enabled && start) {
+        profiler.current[stage] += (profileNow() - start) * 1000.0 / profiler.frequency;
+    }
+}
+
+// Times the enclosing block into one stage of the current frame
+struct ProfileScope {
+    explicit ProfileScope(ProfileStage stage) : stage(stage), start(profiler.enabled ? profileNow() : 0) {}
+    ~ProfileScope() {
+        addProfileTime(stage, start);
+    }
+    ProfileStage stage;
+    LONGLONG start;
+};
+
+// Turns profiling on or off, resetting statistics when it is switched on
+void setProfilerEnabled(bool enabled);
+
+// Closes the current frame: records its stage times and starts accumulating the next one
+void endProfileFrame();
+
+// Rolling average and p99 of a stage (or of the whole render when stage == STAGE_COUNT)
+StageSummary summarizeStage(int stage);
+
+// Frames per second over the rolling window
+double profiledFps();
+
+// Display name of a stage
+const char* profileStageName(int stage);
+
+// Draws the statistics overlay in the top-left corner of a DC
+void drawProfilerOverlay(HDC hdc, const char* heading);
+
+// Writes the frame log as CSV; returns false if the file cannot be written
+bool writeProfileCsv(const char* path);
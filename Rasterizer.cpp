@@ -0,0 +1,269 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Software Rasterizer
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rasterizer.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+
+// Sub-pixel precision of the fixed-point edge setup (28.4)
+const int SUBPIXEL_BITS = 4;
+const int64_t SUBPIXEL_ONE = 1 << SUBPIXEL_BITS;
+
+// Largest screen coordinate accepted; keeps fixed-point edge functions far from overflow
+// without needing guard-band clipping
+const float MAX_SCREEN_COORD = 16384.0f;
+
+// Returns true if the vertex is finite and within the accepted coordinate range
+inline bool inRange(const ScreenVertex& v) {
+    return fabsf(v.x) <= MAX_SCREEN_COORD && fabsf(v.y) <= MAX_SCREEN_COORD;
+}
+
+// Twice the signed area of (a, b, p); positive when p is inside for a clockwise-on-screen triangle
+inline int64_t edgeFunction(int64_t ax, int64_t ay, int64_t bx, int64_t by, int64_t px, int64_t py) {
+    return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+}
+
+// Top-left fill rule: pixels exactly on a shared edge belong to exactly one of the two triangles
+inline bool isTopLeft(int64_t ax, int64_t ay, int64_t bx, int64_t by) {
+    return (ay == by && bx > ax) || (by < ay);
+}
+
+} // namespace
+
+// Point the frame buffer at a color buffer and size the depth buffer to match
+void attachFrameBuffer(FrameBuffer& fb, uint32_t* pixels, int width, int height) {
+    fb.pixels = pixels;
+    fb.width = width;
+    fb.height = height;
+    fb.depth.resize(static_cast<size_t>(width) * height);
+}
+
+// Clear color to a solid fill and depth to "infinitely far"
+void clearFrameBuffer(FrameBuffer& fb, uint32_t color) {
+    size_t count = static_cast<size_t>(fb.width) * fb.height;
+    std::fill(fb.pixels, fb.pixels + count, color);
+    std::fill(fb.depth.begin(), fb.depth.end(), -FLT_MAX);
+}
+
+// Clear one rectangle, e.g. a single screen tile
+void clearFrameBuffer(FrameBuffer& fb, uint32_t color, const PixelRect& clip) {
+    for (int y = clip.y0; y < clip.y1; ++y) {
+        size_t row = static_cast<size_t>(y) * fb.width;
+        std::fill(fb.pixels + row + clip.x0, fb.pixels + row + clip.x1, color);
+        std::fill(fb.depth.begin() + row + clip.x0, fb.depth.begin() + row + clip.x1, -FLT_MAX);
+    }
+}
+
+// Fill a triangle anywhere in the buffer
+void fillTriangle(FrameBuffer& fb, const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c, uint32_t color) {
+    fillTriangle(fb, a, b, c, color, { 0, 0, fb.width, fb.height });
+}
+
+// Fill a flat-colored triangle using fixed-point edge functions and an interpolated depth plane
+void fillTriangle(FrameBuffer& fb, const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c, uint32_t color, const PixelRect& clip) {
+    if (!inRange(a) || !inRange(b) || !inRange(c)) return;
+
+    const ScreenVertex* v0 = &a;
+    const ScreenVertex* v1 = &b;
+    const ScreenVertex* v2 = &c;
+    int64_t x0 = lrintf(v0->x * SUBPIXEL_ONE), y0 = lrintf(v0->y * SUBPIXEL_ONE);
+    int64_t x1 = lrintf(v1->x * SUBPIXEL_ONE), y1 = lrintf(v1->y * SUBPIXEL_ONE);
+    int64_t x2 = lrintf(v2->x * SUBPIXEL_ONE), y2 = lrintf(v2->y * SUBPIXEL_ONE);
+
+    // Normalize winding so the interior has positive edge functions
+    int64_t area = edgeFunction(x0, y0, x1, y1, x2, y2);
+    if (area == 0) return;
+    if (area < 0) {
+        std::swap(v1, v2);
+        std::swap(x1, x2);
+        std::swap(y1, y2);
+        area = -area;
+    }
+
+    // Bounding box clipped to the clip rectangle
+    int minX = std::max(clip.x0, static_cast<int>(std::min({ x0, x1, x2 }) >> SUBPIXEL_BITS));
+    int minY = std::max(clip.y0, static_cast<int>(std::min({ y0, y1, y2 }) >> SUBPIXEL_BITS));
+    int maxX = std::min(clip.x1 - 1, static_cast<int>((std::max({ x0, x1, x2 }) + SUBPIXEL_ONE - 1) >> SUBPIXEL_BITS));
+    int maxY = std::min(clip.y1 - 1, static_cast<int>((std::max({ y0, y1, y2 }) + SUBPIXEL_ONE - 1) >> SUBPIXEL_BITS));
+    if (minX > maxX || minY > maxY) return;
+
+    // Edge functions at the first pixel center; w0 weights v0, w1 weights v1, w2 weights v2
+    int64_t px = (static_cast<int64_t>(minX) << SUBPIXEL_BITS) + SUBPIXEL_ONE / 2;
+    int64_t py = (static_cast<int64_t>(minY) << SUBPIXEL_BITS) + SUBPIXEL_ONE / 2;
+    int64_t e0 = edgeFunction(x1, y1, x2, y2, px, py);
+    int64_t e1 = edgeFunction(x2, y2, x0, y0, px, py);
+    int64_t e2 = edgeFunction(x0, y0, x1, y1, px, py);
+    int64_t stepX0 = (y1 - y2) * SUBPIXEL_ONE, stepY0 = (x2 - x1) * SUBPIXEL_ONE;
+    int64_t stepX1 = (y2 - y0) * SUBPIXEL_ONE, stepY1 = (x0 - x2) * SUBPIXEL_ONE;
+    int64_t stepX2 = (y0 - y1) * SUBPIXEL_ONE, stepY2 = (x1 - x0) * SUBPIXEL_ONE;
+
+    // Depth is a linear plane in screen space, anchored at v0 rather than the clipped box, so
+    // every pixel gets the same depth no matter which clip rectangle (tile) it is drawn through
+    double invArea = 1.0 / static_cast<double>(area);
+    double dzdx = (stepX0 * static_cast<double>(v0->z) + stepX1 * static_cast<double>(v1->z) + stepX2 * static_cast<double>(v2->z)) * invArea;
+    double dzdy = (stepY0 * static_cast<double>(v0->z) + stepY1 * static_cast<double>(v1->z) + stepY2 * static_cast<double>(v2->z)) * invArea;
+    double zOrigin = v0->z - dzdx * (static_cast<double>(x0) / SUBPIXEL_ONE - 0.5) - dzdy * (static_cast<double>(y0) / SUBPIXEL_ONE - 0.5);
+    const float dzdxf = static_cast<float>(dzdx);
+
+    // Shared edges that are not top-left are pulled inside by one unit
+    int64_t row0 = e0 - (isTopLeft(x1, y1, x2, y2) ? 0 : 1);
+    int64_t row1 = e1 - (isTopLeft(x2, y2, x0, y0) ? 0 : 1);
+    int64_t row2 = e2 - (isTopLeft(x0, y0, x1, y1) ? 0 : 1);
+
+    for (int y = minY; y <= maxY; ++y) {
+        uint32_t* pixelRow = fb.pixels + static_cast<size_t>(y) * fb.width;
+        float* depthRow = fb.depth.data() + static_cast<size_t>(y) * fb.width;
+        int64_t w0 = row0, w1 = row1, w2 = row2;
+        const float zRow = static_cast<float>(zOrigin + dzdy * y);
+
+        for (int x = minX; x <= maxX; ++x) {
+            if ((w0 | w1 | w2) >= 0) {
+                float z = zRow + dzdxf * x;
+                if (z > depthRow[x]) {
+                    depthRow[x] = z;
+                    pixelRow[x] = color;
+                }
+            }
+            w0 += stepX0;
+            w1 += stepX1;
+            w2 += stepX2;
+        }
+
+        row0 += stepY0;
+        row1 += stepY1;
+        row2 += stepY2;
+    }
+}
+
+// Draw a line anywhere in the buffer
+void drawLine(FrameBuffer& fb, const ScreenVertex& a, const ScreenVertex& b, uint32_t color, float depthBias) {
+    drawLine(fb, a, b, color, depthBias, { 0, 0, fb.width, fb.height });
+}
+
+// Draw a depth-tested line with a simple DDA; the depth buffer itself is left untouched
+void drawLine(FrameBuffer& fb, const ScreenVertex& a, const ScreenVertex& b, uint32_t color, float depthBias, const PixelRect& clip) {
+    if (!inRange(a) || !inRange(b)) return;
+
+    // Trivially reject lines entirely off one side of the clip rectangle
+    float left = static_cast<float>(clip.x0), top = static_cast<float>(clip.y0);
+    float right = static_cast<float>(clip.x1), bottom = static_cast<float>(clip.y1);
+    if ((a.x < left && b.x < left) || (a.y < top && b.y < top) ||
+        (a.x >= right && b.x >= right) || (a.y >= bottom && b.y >= bottom)) return;
+
+    float dx = b.x - a.x, dy = b.y - a.y, dz = b.z - a.z;
+    int steps = std::max(1, static_cast<int>(ceilf(std::max(fabsf(dx), fabsf(dy)))));
+    float inv = 1.0f / steps;
+
+    // Liang-Barsky narrows the step range to the part of the line near the clip rectangle;
+    // the per-pixel test below still decides exactly, so results match the unclipped line
+    float t0 = 0.0f, t1 = 1.0f;
+    const float p[4] = { -dx, dx, -dy, dy };
+    const float q[4] = { a.x - left, right - a.x, a.y - top, bottom - a.y };
+    for (int k = 0; k < 4; ++k) {
+        if (p[k] == 0) continue;
+        float t = q[k] / p[k];
+        if (p[k] < 0) t0 = std::max(t0, t);
+        else t1 = std::min(t1, t);
+    }
+    int first = std::max(0, static_cast<int>(floorf(t0 * steps)) - 1);
+    int last = std::min(steps, static_cast<int>(ceilf(t1 * steps)) + 1);
+
+    for (int i = first; i <= last; ++i) {
+        float t = i * inv;
+        int x = static_cast<int>(floorf(a.x + dx * t));
+        int y = static_cast<int>(floorf(a.y + dy * t));
+        if (x < clip.x0 || y < clip.y0 || x >= clip.x1 || y >= clip.y1) continue;
+
+        size_t index = static_cast<size_t>(y) * fb.width + x;
+        if (a.z + dz * t + depthBias >= fb.depth[index]) {
+            fb.pixels[index] = color;
+        }
+    }
+}
+
+namespace {
+
+// The 6x6 ellipse GDI drew for each dot: 1 is the outline pen, 2 the brush
+const uint8_t DOT_MASK[DOT_SIZE][DOT_SIZE] = {
+    { 0, 1, 1, 1, 1, 0 },
+    { 1, 2, 2, 2, 2, 1 },
+    { 1, 2, 2, 2, 2, 1 },
+    { 1, 2, 2, 2, 2, 1 },
+    { 1, 2, 2, 2, 2, 1 },
+    { 0, 1, 1, 1, 1, 0 },
+};
+
+// Copy the sprite with its top-left corner at (left, top), clipped to the buffer
+void stampDot(FrameBuffer& fb, int left, int top, const uint32_t colors[3]) {
+    const int x0 = std::max(left, 0), x1 = std::min(left + DOT_SIZE, fb.width);
+    const int y0 = std::max(top, 0), y1 = std::min(top + DOT_SIZE, fb.height);
+    for (int py = y0; py < y1; ++py) {
+        const uint8_t* maskRow = DOT_MASK[py - top];
+        uint32_t* row = fb.pixels + static_cast<size_t>(py) * fb.width;
+        for (int px = x0; px < x1; ++px) {
+            const uint8_t m = maskRow[px - left];
+            if (m) row[px] = colors[m];
+        }
+    }
+}
+
+} // namespace
+
+// One byte per sprite-sized cell, covering the buffer
+size_t dotGridSize(const FrameBuffer& fb) {
+    const size_t columns = (fb.width + DOT_SIZE - 1) / DOT_SIZE;
+    const size_t rows = (fb.height + DOT_SIZE - 1) / DOT_SIZE;
+    return columns * rows;
+}
+
+// A dot is placed at the pixel its vertex falls in, the same truncation GDI's Ellipse saw; hidden dots are
+// rejected before they can claim a cell, so a hidden cluster never blocks a visible dot. Each cell is one
+// sprite wide and records where in it the dot drawn there sits (0 for none), so any sprite that could
+// overlap a new one is in the new dot's cell or one of its eight neighbours.
+DotStats stampDots(FrameBuffer& fb, const float* x, const float* y, const float* z, const uint8_t* mask, size_t count,
+    const DotStyle& style, uint8_t* grid) {
+    DotStats stats = {};
+    const uint32_t colors[3] = { 0, style.outline, style.fill };
+    const int columns = (fb.width + DOT_SIZE - 1) / DOT_SIZE;
+    const int rows = (fb.height + DOT_SIZE - 1) / DOT_SIZE;
+    const float maxX = static_cast<float>(fb.width), maxY = static_cast<float>(fb.height);
+    auto overlapsDrawn = [&](int px, int py) {
+        const int cx = px / DOT_SIZE, cy = py / DOT_SIZE;
+        for (int ny = std::max(cy - 1, 0); ny <= std::min(cy + 1, rows - 1); ++ny) {
+            for (int nx = std::max(cx - 1, 0); nx <= std::min(cx + 1, columns - 1); ++nx) {
+                const int slot = grid[ny * columns + nx] - 1;
+                if (slot < 0) continue;
+                const int dx = nx * DOT_SIZE + slot % DOT_SIZE - px, dy = ny * DOT_SIZE + slot / DOT_SIZE - py;
+                if (dx > -DOT_SIZE && dx < DOT_SIZE && dy > -DOT_SIZE && dy < DOT_SIZE) return true;
+            }
+        }
+        return false;
+    };
+
+    for (size_t i = 0; i < count; ++i) {
+        if (mask && !mask[i]) continue;
+        if (!(x[i] >= 0 && x[i] < maxX && y[i] >= 0 && y[i] < maxY)) continue;
+
+        const int px = static_cast<int>(x[i]), py = static_cast<int>(y[i]);
+        if (style.depthTest && z[i] + style.depthBias < fb.depth[static_cast<size_t>(py) * fb.width + px]) {
+            ++stats.hidden;
+            continue;
+        }
+
+        if (overlapsDrawn(px, py)) {
+            ++stats.crowded;
+            continue;
+        }
+        grid[(py / DOT_SIZE) * columns + px / DOT_SIZE] = static_cast<uint8_t>(1 + (py % DOT_SIZE) * DOT_SIZE + px % DOT_SIZE);
+
+        stampDot(fb, px - DOT_SIZE / 2, py - DOT_SIZE / 2, colors);
+        ++stats.drawn;
+    }
+    return stats;
+}
@@ -0,0 +1,87 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Software rasterizer: fills triangles, draws lines and stamps
+//      vertex dots straight into a 32-bit pixel buffer with a
+//      per-pixel depth buffer, so faces no longer need sorting or
+//      per-face GDI objects.
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Vertex in screen space: pixel coordinates plus view-space depth (larger z is nearer)
+struct ScreenVertex {
+    float x;    // Pixel column
+    float y;    // Pixel row
+    float z;    // View-space depth
+};
+
+// Half-open pixel rectangle [x0, x1) x [y0, y1) that drawing is clipped to
+struct PixelRect {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+};
+
+// Color and depth buffers the rasterizer draws into
+struct FrameBuffer {
+    uint32_t* pixels = nullptr;   // Color buffer (0x00RRGGBB, top-down rows), owned by the caller
+    int width = 0;                // Width in pixels
+    int height = 0;               // Height in pixels
+    std::vector<float> depth;     // Depth buffer, width * height entries
+};
+
+// Packs an RGB triple into the 0x00RRGGBB layout of a 32-bit DIB section
+inline uint32_t packPixel(int r, int g, int b) {
+    return (static_cast<uint32_t>(r) << 16) | (static_cast<uint32_t>(g) << 8) | static_cast<uint32_t>(b);
+}
+
+// Points the frame buffer at a color buffer and sizes the depth buffer to match
+void attachFrameBuffer(FrameBuffer& fb, uint32_t* pixels, int width, int height);
+
+// Fills the color buffer with a solid color and resets every depth sample to "infinitely far"
+void clearFrameBuffer(FrameBuffer& fb, uint32_t color);
+
+// Fills a rectangle of the color buffer and resets its depth samples
+void clearFrameBuffer(FrameBuffer& fb, uint32_t color, const PixelRect& clip);
+
+// Fills a triangle of either winding with a flat color, keeping only the nearest fragments
+void fillTriangle(FrameBuffer& fb, const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c, uint32_t color);
+void fillTriangle(FrameBuffer& fb, const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c, uint32_t color, const PixelRect& clip);
+
+// Draws a 1-pixel line, skipping pixels hidden behind stored depth by more than depthBias.
+// Clipping changes which pixels are written, never where they land, so tiles join seamlessly.
+void drawLine(FrameBuffer& fb, const ScreenVertex& a, const ScreenVertex& b, uint32_t color, float depthBias);
+void drawLine(FrameBuffer& fb, const ScreenVertex& a, const ScreenVertex& b, uint32_t color, float depthBias, const PixelRect& clip);
+
+// Side of the square sprite a vertex dot is stamped from
+const int DOT_SIZE = 6;
+
+// How vertex dots are drawn
+struct DotStyle {
+    uint32_t fill;          // Interior color
+    uint32_t outline;       // Rim color
+    bool depthTest;         // Skip dots whose center pixel is covered by a surface nearer than the dot
+    float depthBias;        // Slack for the depth test, so a vertex is not hidden by its own faces
+};
+
+// Dots drawn and dropped by one stampDots call
+struct DotStats {
+    size_t drawn;
+    size_t hidden;          // Failed the depth test
+    size_t crowded;         // Dropped because they would overlap a dot already drawn
+};
+
+// Bytes of zeroed scratch stampDots needs for a frame of this size: one per DOT_SIZE x DOT_SIZE cell
+size_t dotGridSize(const FrameBuffer& fb);
+
+// Stamps the dot sprite centered on each of the first count points whose mask entry is set (every point
+// if mask is null), in index order. Points whose center lies outside the buffer are skipped. The depth
+// buffer is read, never written. A dot whose sprite would overlap one already drawn is dropped, so no two
+// dots ever overlap; grid must hold dotGridSize zeroed bytes and carries that record across calls.
+DotStats stampDots(FrameBuffer& fb, const float* x, const float* y, const float* z, const uint8_t* mask, size_t count,
+    const DotStyle& style, uint8_t* grid);
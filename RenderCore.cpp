@@ -0,0 +1,495 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Portable Render Core
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "RenderCore.hpp"
+#include "MeshLoader.hpp"
+#include "MeshLod.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Brackets a block as one stage of the hooks, however it is left
+struct StageScope {
+    StageScope(RenderHooks& hooks, RenderStage stage) : hooks(hooks), stage(stage) { hooks.beginStage(stage); }
+    ~StageScope() { hooks.endStage(stage); }
+    RenderHooks& hooks;
+    RenderStage stage;
+};
+
+} // namespace
+
+// Sine and cosine of an angle in degrees, reduced to one turn first so that accumulated drag angles keep full precision
+void sinCosDegrees(float degrees, float& s, float& c) {
+    float rad = fmodf(degrees, 360.0f) * 3.14159265f / 180.0f;
+    s = sinf(rad);
+    c = cosf(rad);
+}
+
+// Rotation about X by angleX followed by rotation about Y by angleY, as one matrix
+Matrix3 rotationMatrix(float angleX, float angleY) {
+    float sx, cx, sy, cy;
+    sinCosDegrees(angleX, sx, cx);
+    sinCosDegrees(angleY, sy, cy);
+    return { {
+        { cy,  sx * sy, cx * sy },
+        { 0,   cx,      -sx     },
+        { -sy, sx * cy, cx * cy }
+    } };
+}
+
+// Centroid of the positions and the largest distance from it; an empty or single-point set gets unit extent
+ModelFrame computeModelFrame(const std::vector<Vertex>& source) {
+    if (source.empty()) return { 0, 0, 0, 1 };
+
+    // Compute model centroid
+    float cx = 0, cy = 0, cz = 0;
+    for (const auto& v : source) {
+        cx += v.x; cy += v.y; cz += v.z;
+    }
+    cx /= source.size();
+    cy /= source.size();
+    cz /= source.size();
+
+    // Calculate max distance from center
+    float maxExtent = 0;
+    for (const auto& v : source) {
+        float dx = v.x - cx, dy = v.y - cy, dz = v.z - cz;
+        float dist = sqrtf(dx * dx + dy * dy + dz * dz);
+        if (dist > maxExtent) maxExtent = dist;
+    }
+    if (maxExtent <= 0) maxExtent = 1;
+    return { cx, cy, cz, maxExtent };
+}
+
+// Center on the frame's centroid and scale into the unit sphere, whatever the source
+void normalizePositions(const std::vector<Vertex>& source, const ModelFrame& frame, VertexStream& out) {
+    resizeVertexStream(out, source.size());
+    for (size_t i = 0; i < source.size(); ++i) {
+        out.x[i] = (source[i].x - frame.cx) / frame.extent;
+        out.y[i] = (source[i].y - frame.cy) / frame.extent;
+        out.z[i] = (source[i].z - frame.cz) / frame.extent;
+    }
+}
+
+// Cross product of two edges per face; the mesh is rigid, so this runs once per load
+void computeFaceNormals(const VertexStream& positions, const std::vector<Face>& faceList, VertexStream& normals,
+    std::vector<uint8_t>& degenerate) {
+    resizeVertexStream(normals, faceList.size());
+    degenerate.assign(faceList.size(), 0);
+
+    for (size_t i = 0; i < faceList.size(); ++i) {
+        const size_t i1 = faceList[i].v1 - 1, i2 = faceList[i].v2 - 1, i3 = faceList[i].v3 - 1;
+
+        float ux = positions.x[i2] - positions.x[i1];
+        float uy = positions.y[i2] - positions.y[i1];
+        float uz = positions.z[i2] - positions.z[i1];
+        float vx = positions.x[i3] - positions.x[i1];
+        float vy = positions.y[i3] - positions.y[i1];
+        float vz = positions.z[i3] - positions.z[i1];
+        float nx = uy * vz - uz * vy;
+        float ny = uz * vx - ux * vz;
+        float nz = ux * vy - uy * vx;
+        float length = sqrtf(nx * nx + ny * ny + nz * nz);
+        if (length < 1e-6f) {
+            degenerate[i] = 1;
+            continue;
+        }
+        normals.x[i] = nx / length;
+        normals.y[i] = ny / length;
+        normals.z[i] = nz / length;
+    }
+}
+
+// Deduplicate the edges, then flag creases from the face normals
+void buildMeshEdges(const std::vector<Face>& faceList, const VertexStream& normals, const std::vector<uint8_t>& degenerate,
+    EdgeList& edgeList) {
+    buildEdgeList(faceList, edgeList);
+    markCreaseEdges(normals, degenerate, EDGE_CREASE_COS, edgeList);
+}
+
+// Quantize a level's positions and drop the floats; normals and edges were derived from full precision
+void compactPositions(VertexStream& positions, QuantizedStream& out) {
+    quantizeVertexStream(positions, out);
+    positions = VertexStream();
+}
+
+// Normalized positions, normals, edges and hierarchy bounds, all in the frame's space
+void buildDetailLevel(const std::vector<Vertex>& positions, std::vector<Face>& faceList, MeshBvh& bvh,
+    const ModelFrame& frame, bool compact, DetailLevel& level, const EdgeList* edges) {
+    normalizePositions(positions, frame, level.normalized);
+    level.faces = std::move(faceList);
+    level.faceCount = level.faces.size();
+    level.vertexCount = level.normalized.count;
+    computeFaceNormals(level.normalized, level.faces, level.faceNormals, level.degenerateFaces);
+    if (edges) {
+        level.edges = *edges;
+        markCreaseEdges(level.faceNormals, level.degenerateFaces, EDGE_CREASE_COS, level.edges);
+    }
+    else {
+        buildMeshEdges(level.faces, level.faceNormals, level.degenerateFaces, level.edges);
+    }
+    level.bvh = std::move(bvh);
+    normalizeBvhBounds(level.bvh, frame);
+    if (compact) compactPositions(level.normalized, level.quantized);
+}
+
+// The unit sphere fills 80% of the shorter side, centered
+Projection fitProjection(int width, int height) {
+    return { std::min(width, height) * 0.4f, static_cast<float>(width / 2), static_cast<float>(height / 2) };
+}
+
+// Trig, rotation and pixel mapping for one pair of angles
+ViewState makeViewState(float angleX, float angleY, const Projection& projection) {
+    ViewState view;
+    view.rotation = rotationMatrix(angleX, angleY);
+    view.projection = projection;
+    view.screen = screenTransform(view.rotation, view.projection);
+    return view;
+}
+
+// A view drawn into a target scale times the original's size; depth is unchanged
+ViewState scaledViewState(const ViewState& view, float scale) {
+    ViewState state = view;
+    state.projection = { view.projection.scale * scale, view.projection.centerX * scale, view.projection.centerY * scale };
+    state.screen = screenTransform(state.rotation, state.projection);
+    return state;
+}
+
+// An instance seen through a view. Its rotation joins the view rotation and its scale and screen offset join the
+// projection, so normals and the BVH cull still see a pure rotation; the depth row takes the scale and depth offset.
+ViewState instanceViewState(const ViewState& view, const SceneInstance& placement) {
+    float offset[3];
+    for (int row = 0; row < 3; ++row) {
+        offset[row] = view.rotation.m[row][0] * placement.translation[0] + view.rotation.m[row][1] * placement.translation[1] +
+            view.rotation.m[row][2] * placement.translation[2];
+    }
+    ViewState state;
+    state.rotation = multiplyMatrix(view.rotation, placement.rotation);
+    state.projection = { view.projection.scale * placement.scale, view.projection.centerX + view.projection.scale * offset[0],
+        view.projection.centerY - view.projection.scale * offset[1] };
+    state.screen = screenTransform(state.rotation, state.projection);
+    for (int col = 0; col < 3; ++col) state.screen.m[2][col] *= placement.scale;
+    state.screen.t[2] = offset[2];
+    return state;
+}
+
+// Blue shading based on angle with Z-axis: #00005F on edge, #0000FF face-on
+int shadeBlue(float nz) {
+    float intensity = fabs(nz);
+    return static_cast<int>(0x5F + intensity * (0xFF - 0x5F));
+}
+
+// Project the normalized (or quantized) vertices once each and rotate the face normals, into preallocated streams
+void projectLevel(const DetailLevel& level, const ViewState& view, RenderContext& context) {
+    const bool compact = level.quantized.count > 0;
+    const size_t count = compact ? level.quantized.count : level.normalized.count;
+    if (context.screen.count != count) resizeScreenStream(context.screen, count);
+
+    if (context.normalDepth.size() != level.faceNormals.x.size()) {
+        context.normalDepth.resize(level.faceNormals.x.size());
+    }
+
+    // Normals share the vertex rotation; shading only ever needs their view-space z
+    if (compact) transformQuantizedVertices(level.quantized, view.screen, context.kernel, context.screen);
+    else transformVertices(level.normalized, view.screen, context.kernel, context.screen);
+    rotateDepth(level.faceNormals, view.rotation, context.normalDepth);
+}
+
+// Use each face's shading normal to drop the ones that cannot contribute to the frame
+void cullFaces(const DetailLevel& level, const ViewState& view, RenderContext& context, int width, int height,
+    bool cullBackFaces, FrameArray<VisibleFace>& visible, CullStats& stats) {
+    const std::vector<Face>& faces = level.faces;
+    const ScreenStream& screen = context.screen;
+    const AlignedFloats& normalDepth = context.normalDepth;
+    visible = frameArray<VisibleFace>(context.arena, faces.size());
+    stats = CullStats();
+    stats.total = faces.size();
+
+    const float maxX = static_cast<float>(width), maxY = static_cast<float>(height);
+    auto testFace = [&](uint32_t i) {
+        const Face& f = faces[i];
+        if (level.degenerateFaces[i]) {
+            ++stats.degenerate;
+            return;
+        }
+        const float nz = normalDepth[i];
+
+        // Back faces of a closed mesh are always hidden behind front faces
+        if (cullBackFaces && nz < 0) {
+            ++stats.backFacing;
+            return;
+        }
+
+        // Reject triangles whose screen bounds miss the window entirely
+        const size_t i1 = f.v1 - 1, i2 = f.v2 - 1, i3 = f.v3 - 1;
+        if ((screen.x[i1] < 0 && screen.x[i2] < 0 && screen.x[i3] < 0) ||
+            (screen.y[i1] < 0 && screen.y[i2] < 0 && screen.y[i3] < 0) ||
+            (screen.x[i1] >= maxX && screen.x[i2] >= maxX && screen.x[i3] >= maxX) ||
+            (screen.y[i1] >= maxY && screen.y[i2] >= maxY && screen.y[i3] >= maxY)) {
+            ++stats.offScreen;
+            return;
+        }
+
+        visible.push_back({ i, nz });
+    };
+
+    const MeshBvh& bvh = level.bvh;
+    if (bvh.nodes.empty()) {
+        for (size_t i = 0; i < faces.size(); ++i) testFace(static_cast<uint32_t>(i));
+        return;
+    }
+
+    // Whole clusters that are off screen or facing away are dropped at their node, their faces
+    // counted under that reason; faces of the clusters that survive are tested one by one
+    const BvhView bvhView = makeBvhView(view.rotation, view.projection, width, height, cullBackFaces);
+    uint32_t stack[BVH_STACK_SIZE];
+    int depth = 0;
+    stack[depth++] = 0;
+    while (depth > 0) {
+        const uint32_t index = stack[--depth];
+        const BvhNode& node = bvh.nodes[index];
+        const uint32_t count = node.count & ~BVH_LEAF;
+        const BvhVisibility visibility = classifyBvhNode(bvh, index, bvhView);
+        if (visibility == BVH_OFF_SCREEN) {
+            stats.offScreen += count;
+            continue;
+        }
+        if (visibility == BVH_BACK_FACING) {
+            stats.backFacing += count;
+            continue;
+        }
+
+        if (node.count & BVH_LEAF) {
+            for (uint32_t i = node.offset; i < node.offset + count; ++i) testFace(i);
+        }
+        else if (depth + 2 <= BVH_STACK_SIZE) {
+            // Second child below the first, so faces come out in leaf order, which is face order
+            stack[depth++] = node.offset;
+            stack[depth++] = index + 1;
+        }
+        else {
+            // Too deep for the stack (validMeshBvh rejects such trees from the cache): a subtree is one
+            // contiguous run of faces starting at its first leaf, so test that run face by face
+            uint32_t first = index;
+            while (!(bvh.nodes[first].count & BVH_LEAF)) ++first;
+            for (uint32_t i = bvh.nodes[first].offset; i < bvh.nodes[first].offset + count; ++i) testFace(i);
+        }
+    }
+}
+
+// Flagged edges always count as features; a silhouette separates a front face from a back face
+bool edgeShown(const DetailLevel& level, const AlignedFloats& normalDepth, bool featureEdgesOnly, uint32_t edge) {
+    if (!featureEdgesOnly || level.edges.flags[edge]) return true;
+    const MeshEdge& e = level.edges.edges[edge];
+    if (e.face[1] == NO_FACE || level.degenerateFaces[e.face[0]] || level.degenerateFaces[e.face[1]]) return false;
+    return (normalDepth[e.face[0]] > 0) != (normalDepth[e.face[1]] > 0);
+}
+
+// Mark the edges of the visible faces, then gather them in edge order so every edge is drawn once
+void collectVisibleEdges(const DetailLevel& level, RenderContext& context, bool featureEdgesOnly,
+    const FrameArray<VisibleFace>& visible, FrameArray<ScreenEdge>& edges) {
+    const EdgeList& meshEdges = level.edges;
+    uint8_t* edgeMarked = frameAllocateZeroed<uint8_t>(context.arena, meshEdges.edges.size());
+    for (const auto& entry : visible) {
+        const uint32_t* links = &meshEdges.faceEdges[entry.face * 3];
+        for (int k = 0; k < 3; ++k) {
+            if (links[k] != NO_FACE) edgeMarked[links[k]] = 1;
+        }
+    }
+
+    edges = frameArray<ScreenEdge>(context.arena, meshEdges.edges.size());
+    for (size_t i = 0; i < meshEdges.edges.size(); ++i) {
+        if (!edgeMarked[i] || !edgeShown(level, context.normalDepth, featureEdgesOnly, static_cast<uint32_t>(i))) continue;
+        const MeshEdge& e = meshEdges.edges[i];
+        edges.push_back({ { e.v[0], e.v[1] } });
+    }
+}
+
+// One triangle per visible face, colored by its normal
+FrameArray<ScreenTriangle> shadedTriangles(const DetailLevel& level, RenderContext& context, const FrameArray<VisibleFace>& visible) {
+    FrameArray<ScreenTriangle> triangles = frameArray<ScreenTriangle>(context.arena, visible.size);
+    for (const auto& entry : visible) {
+        const Face& f = level.faces[entry.face];
+        triangles.push_back({ { static_cast<uint32_t>(f.v1 - 1), static_cast<uint32_t>(f.v2 - 1), static_cast<uint32_t>(f.v3 - 1) },
+            packPixel(0, 0, shadeBlue(entry.nz)) });
+    }
+    return triangles;
+}
+
+// The stream's arrays, unchanged
+ScreenVertexArrays screenArrays(const RenderContext& context) {
+    return { context.screen.x.data(), context.screen.y.data(), context.screen.z.data() };
+}
+
+// Edges are binned into the tiles the fill pass just used, so binTiles must have run for this frame
+void drawOutlines(const DetailLevel& level, RenderContext& context, bool featureEdgesOnly, FrameBuffer& frame,
+    const FrameArray<VisibleFace>& visible) {
+    FrameArray<ScreenEdge> edges;
+    collectVisibleEdges(level, context, featureEdgesOnly, visible, edges);
+    drawEdgesTiled(context.tiles, context.arena, frame, screenArrays(context), edges.data, edges.size, packPixel(0, 0, 0),
+        WIREFRAME_DEPTH_BIAS);
+}
+
+// Blue dots with a black rim, in index order
+DotStats drawVertexDots(const RenderContext& context, FrameBuffer& frame, const uint8_t* vertexVisible, bool depthTested,
+    uint8_t* dotGrid) {
+    const ScreenStream& screen = context.screen;
+    const DotStyle style = { packPixel(0, 0, 0xFF), packPixel(0, 0, 0), depthTested, DOT_DEPTH_BIAS };
+    return stampDots(frame, screen.x.data(), screen.y.data(), screen.z.data(), vertexVisible, screen.count, style, dotGrid);
+}
+
+// Cull once, then shade only what is left
+bool drawLevel(const DetailLevel& level, const ViewState& view, const RenderSettings& settings, RenderContext& context,
+    FrameBuffer& frame, bool clear, uint8_t* dotGrid, RenderHooks& hooks, CullStats& stats, DotStats& dots) {
+    FrameArray<VisibleFace> visible;
+    CullStats culled;
+    {
+        StageScope scope(hooks, RENDER_CULL);
+        cullFaces(level, view, context, frame.width, frame.height, settings.cullBackFaces, visible, culled);
+    }
+    stats.total += culled.total;
+    stats.backFacing += culled.backFacing;
+    stats.offScreen += culled.offScreen;
+    stats.degenerate += culled.degenerate;
+
+    // The rasterizer's depth buffer decides which dots are hidden; a painted frame has none, so its dots are
+    // the vertices of front faces that lie on the near side of the mesh's center
+    const bool painted = hooks.paintsFaces();
+    uint8_t* vertexVisible = nullptr;
+    if (painted) {
+        if (clear) clearFrameBuffer(frame, settings.background);
+        if (settings.dots) vertexVisible = frameAllocateZeroed<uint8_t>(context.arena, context.screen.count);
+        hooks.paintFaces(level, context, visible, settings, vertexVisible);
+        const float centerDepth = view.screen.t[2];
+        for (size_t i = 0; vertexVisible && i < context.screen.count; ++i) {
+            if (context.screen.z[i] <= centerDepth) vertexVisible[i] = 0;
+        }
+    }
+    else {
+        // Binning plays the part of the painter's sort; an empty frame skips the other passes
+        const FrameArray<ScreenTriangle> triangles = shadedTriangles(level, context, visible);
+        const ScreenVertexArrays arrays = screenArrays(context);
+        {
+            StageScope scope(hooks, RENDER_SORT);
+            if (!binTiles(context.tiles, context.arena, frame, arrays, triangles.data, triangles.size)) return true;
+        }
+        {
+            StageScope scope(hooks, RENDER_FILL);
+            if (clear) fillTiles(context.tiles, frame, arrays, triangles.data, settings.background);
+            else fillTilesOver(context.tiles, frame, arrays, triangles.data);
+        }
+        if (settings.outlines) {
+            if (hooks.interrupted()) return false;
+            StageScope scope(hooks, RENDER_OUTLINES);
+            drawOutlines(level, context, settings.featureEdgesOnly, frame, visible);
+        }
+    }
+    if (!settings.dots) return true;
+    if (hooks.interrupted()) return false;
+
+    StageScope scope(hooks, RENDER_DOTS);
+    const DotStats drawn = drawVertexDots(context, frame, vertexVisible, !painted, dotGrid);
+    dots.drawn += drawn.drawn;
+    dots.hidden += drawn.hidden;
+    dots.crowded += drawn.crowded;
+    return true;
+}
+
+// The depth buffer carries over between instances; a painted frame has none, so it takes the instances back
+// to front by their centers instead
+bool drawScene(const Scene& scene, const ViewState& view, const RenderSettings& settings, RenderContext& context,
+    FrameBuffer& frame, uint8_t* dotGrid, RenderHooks& hooks, CullStats& stats, DotStats& dots) {
+    const size_t count = scene.instances.size();
+    uint32_t* order = frameAllocate<uint32_t>(context.arena, count);
+    for (size_t i = 0; i < count; ++i) order[i] = static_cast<uint32_t>(i);
+    clearFrameBuffer(frame, settings.background);
+    if (hooks.paintsFaces()) {
+        float* depth = frameAllocate<float>(context.arena, count);
+        const Matrix3& r = view.rotation;
+        for (size_t i = 0; i < count; ++i) {
+            const float* t = scene.placements[i].translation;
+            depth[i] = r.m[2][0] * t[0] + r.m[2][1] * t[1] + r.m[2][2] * t[2];
+        }
+        // Ties broken by index keep the order stable without stable_sort's heap buffer
+        std::sort(order, order + count, [depth](uint32_t a, uint32_t b) { return depth[a] < depth[b] || (depth[a] == depth[b] && a < b); });
+    }
+
+    // Each pass's scratch is dead once its pixels are drawn, so the arena only ever holds one instance's worth
+    bool complete = true;
+    for (size_t i = 0; i < count && complete; ++i) {
+        const uint32_t instance = order[i];
+        const DetailLevel& level = scene.meshes[scene.instances[instance].mesh].level;
+        const ViewState instanceView = instanceViewState(view, scene.placements[instance]);
+        const FrameArenaMark mark = markFrameArena(context.arena);
+        {
+            StageScope scope(hooks, RENDER_TRANSFORM);
+            projectLevel(level, instanceView, context);
+        }
+        complete = drawLevel(level, instanceView, settings, context, frame, false, dotGrid, hooks, stats, dots);
+        rewindFrameArena(context.arena, mark);
+    }
+    return complete;
+}
+
+// Everything but the counts, which describe the slot rather than what it currently holds
+void swapLevelGeometry(DetailLevel& a, DetailLevel& b) {
+    std::swap(a.faces, b.faces);
+    std::swap(a.normalized, b.normalized);
+    std::swap(a.quantized, b.quantized);
+    std::swap(a.faceNormals, b.faceNormals);
+    std::swap(a.degenerateFaces, b.degenerateFaces);
+    std::swap(a.edges, b.edges);
+    std::swap(a.bvh, b.bvh);
+}
+
+// Levels get coarser, so the first one within budget is the finest that is
+int dragDetailLevel(const std::vector<DetailLevel>& levels) {
+    int drag = 0;
+    for (size_t i = 1; i < levels.size(); ++i) {
+        if (drag == 0 || levels[drag].faceCount > LOD_DRAG_FACE_BUDGET) drag = static_cast<int>(i);
+    }
+    return drag;
+}
+
+// The viewer's load path without the cache, reordering or LOD chain: hierarchy first, since it reorders the faces
+void buildRenderMesh(std::vector<Vertex>& vertices, std::vector<Face>& faces, RenderMesh& mesh) {
+    MeshBvh bvh;
+    buildMeshBvh(vertices, faces, bvh);
+    mesh.frame = computeModelFrame(vertices);
+    mesh.level = DetailLevel();
+    buildDetailLevel(vertices, faces, bvh, mesh.frame, false, mesh.level);
+    std::vector<Vertex>().swap(vertices);
+}
+
+// Through the memory-mapped parser, which is the fastest single-threaded path
+bool loadRenderMesh(const char* path, RenderMesh& mesh) {
+    std::vector<Vertex> vertices;
+    std::vector<Face> faces;
+    if (!loadMeshFile(path, vertices, faces)) return false;
+    buildRenderMesh(vertices, faces, mesh);
+    return true;
+}
+
+// The context's frame borrows the caller's pixels for the duration of the call; only its depth buffer is kept
+CullStats renderToMemory(const RenderMesh& mesh, float angleX, float angleY, const RenderSettings& settings,
+    RenderContext& context, uint32_t* pixels, int width, int height) {
+    CullStats stats = CullStats();
+    if (!pixels || width <= 0 || height <= 0) return stats;
+
+    FrameBuffer& frame = context.frame;
+    attachFrameBuffer(frame, pixels, width, height);
+    resetFrameArena(context.arena);
+
+    const ViewState view = makeViewState(angleX, angleY, fitProjection(width, height));
+    projectLevel(mesh.level, view, context);
+    uint8_t* dotGrid = frameAllocateZeroed<uint8_t>(context.arena, dotGridSize(frame));
+    DotStats dots = DotStats();
+    RenderHooks hooks;
+    drawLevel(mesh.level, view, settings, context, frame, true, dotGrid, hooks, stats, dots);
+    frame.pixels = nullptr;
+    return stats;
+}
@@ -0,0 +1,253 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Portable render core: loading, normalization, normals and
+//      edges, projection, culling and the software raster passes,
+//      with every input and all scratch passed in explicitly. It
+//      includes no platform headers and keeps no global state, so
+//      any number of threads can render meshes side by side, each
+//      with its own RenderContext.
+//
+//      The Win32 viewer draws its frames with drawLevel and
+//      drawScene, supplying timing, input checks and its GDI
+//      painter's path through RenderHooks. Batch tools load a
+//      RenderMesh and call renderToMemory for each image.
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "FrameArena.hpp"
+#include "MeshBvh.hpp"
+#include "MeshEdges.hpp"
+#include "MeshTypes.hpp"
+#include "Rasterizer.hpp"
+#include "Scene.hpp"
+#include "TileRenderer.hpp"
+#include "VertexTransform.hpp"
+
+// Depth slack that lets edges drawn after the fill pass sit on top of their own faces
+const float WIREFRAME_DEPTH_BIAS = 0.005f;
+
+// A vertex sits up to half a pixel from the sample its dot is tested at, so it needs more slack than an edge
+const float DOT_DEPTH_BIAS = 0.02f;
+
+// Face that survived culling, with its view-space normal z already computed
+struct VisibleFace {
+    uint32_t face;  // Index into faces
+    float nz;       // Normal z component, drives shading
+};
+
+// Per-frame culling counters
+struct CullStats {
+    size_t total;       // Faces in the mesh
+    size_t backFacing;  // Rejected because they face away from the viewer
+    size_t offScreen;   // Rejected because they lie entirely outside the window
+    size_t degenerate;  // Rejected because they have zero area
+};
+
+// Render-ready geometry of one detail level. A level holds either float or quantized positions, never both.
+struct DetailLevel {
+    std::vector<Face> faces;
+    VertexStream normalized;
+    QuantizedStream quantized;      // Replaces normalized in compact mode
+    VertexStream faceNormals;
+    std::vector<uint8_t> degenerateFaces;
+    EdgeList edges;
+    MeshBvh bvh;
+    size_t faceCount = 0;   // Faces and vertices in the level, valid even while the viewer has it swapped out
+    size_t vertexCount = 0;
+};
+
+// Everything derived from the view angles, computed once per frame
+struct ViewState {
+    Matrix3 rotation;           // Model to view space, for normals, culling and picking
+    Projection projection;      // View space to pixels
+    AffineTransform screen;     // Both folded into one 3x4: model to pixel x, pixel y and view depth
+};
+
+// Scratch one renderer reuses from frame to frame; keep one per rendering thread. Each context runs its own
+// tile pool, which starts out as just the calling thread: a batch job with a context per thread would otherwise
+// start a full pool per context. A single context that should use the whole machine configures its tiles.
+struct RenderContext {
+    RenderContext() { tiles.config.threadCount = 1; }
+
+    TileRenderer tiles;             // Calling thread only, unless configureTileRenderer says otherwise
+    TransformKernel kernel = detectTransformKernel();  // Projection kernel, resolved once; supportedTransformKernel to force another
+    FrameArena arena;               // Reset at the start of every frame
+    ScreenStream screen;            // Pixel position and view depth of every vertex of the last projected level
+    AlignedFloats normalDepth;      // View-space z of each face normal for the same projection
+    FrameBuffer frame;              // Depth buffer for renderToMemory; the pixels belong to the caller
+};
+
+// What a frame draws besides the shaded faces
+struct RenderSettings {
+    bool cullBackFaces = true;      // Closed meshes only
+    bool featureEdgesOnly = false;  // Outline only silhouette, crease and boundary edges
+    bool outlines = true;           // Depth-tested wireframe over the faces
+    bool dots = true;               // Blue vertex dots, dropping any that would overlap one already drawn
+    uint32_t background = 0xFFFFFF; // Clear color, 0x00RRGGBB
+};
+
+// A mesh loaded on its own for renderToMemory: its normalization and its full-detail level
+struct RenderMesh {
+    ModelFrame frame = { 0, 0, 0, 1 };
+    DetailLevel level;
+};
+
+// One unique mesh of a scene at full detail, projected once for each instance that places it
+struct SceneMesh {
+    std::string path;
+    ModelFrame frame = {};              // The mesh's own normalization, which its instances' placements undo
+    DetailLevel level;
+};
+
+// Unique meshes plus one placement per copy; instances are sorted by mesh, so each mesh's copies are one batch
+struct Scene {
+    std::vector<SceneMesh> meshes;
+    std::vector<SceneInstance> instances;   // As read from the file, in model units
+    std::vector<SceneInstance> placements;  // Parallel to instances, mapping normalized mesh into normalized scene
+    ModelFrame frame = { 0, 0, 0, 1 };      // Bounds of every instance, normalizing the scene into the unit sphere
+};
+
+// Passes of a frame that RenderHooks can time
+enum RenderStage {
+    RENDER_TRANSFORM,   // projectLevel, for each scene instance
+    RENDER_CULL,        // cullFaces
+    RENDER_SORT,        // Triangle binning, or the painter's depth sort
+    RENDER_FILL,        // Face fill
+    RENDER_OUTLINES,    // Edge overlay
+    RENDER_DOTS,        // Vertex dots
+    RENDER_STAGE_COUNT
+};
+
+// What the owner of a frame adds to drawLevel and drawScene: stage timing, a way to abandon the frame for
+// waiting input, and optionally its own face painter in place of the depth-buffered tile fill. The defaults
+// do none of it, which is how renderToMemory draws.
+class RenderHooks {
+public:
+    virtual ~RenderHooks() {}
+
+    // Bracket each pass
+    virtual void beginStage(RenderStage stage) { (void)stage; }
+    virtual void endStage(RenderStage stage) { (void)stage; }
+
+    // Polled once the faces are down and again before the dots; true stops the frame where it is
+    virtual bool interrupted() { return false; }
+
+    // True if paintFaces draws the faces instead of the tile rasterizer
+    virtual bool paintsFaces() const { return false; }
+
+    // Paints the visible faces back to front with no depth buffer, outlining them too if settings ask for it,
+    // into the frame's pixels. Unless vertexVisible is null, marks the vertices of front faces in it for the
+    // dots. Must be done writing when it returns, since the dots go straight into the pixels.
+    virtual void paintFaces(const DetailLevel& level, RenderContext& context, const FrameArray<VisibleFace>& visible,
+        const RenderSettings& settings, uint8_t* vertexVisible) {
+        (void)level; (void)context; (void)visible; (void)settings; (void)vertexVisible;
+    }
+};
+
+// Sine and cosine of an angle in degrees
+void sinCosDegrees(float degrees, float& s, float& c);
+
+// Builds the combined rotation matrix for a rotation about X by angleX followed by one about Y by angleY
+Matrix3 rotationMatrix(float angleX, float angleY);
+
+// Returns the centroid and radius that normalize a set of positions into the unit sphere
+ModelFrame computeModelFrame(const std::vector<Vertex>& source);
+
+// Applies a frame to any set of positions (the loaded vertices or an LOD level)
+void normalizePositions(const std::vector<Vertex>& source, const ModelFrame& frame, VertexStream& out);
+
+// Computes unit object-space face normals and flags degenerate faces
+void computeFaceNormals(const VertexStream& positions, const std::vector<Face>& faceList, VertexStream& normals,
+    std::vector<uint8_t>& degenerate);
+
+// Builds the edge list and its crease flags for one level's faces and normals
+void buildMeshEdges(const std::vector<Face>& faceList, const VertexStream& normals, const std::vector<uint8_t>& degenerate,
+    EdgeList& edgeList);
+
+// Quantizes positions into out and frees the float stream
+void compactPositions(VertexStream& positions, QuantizedStream& out);
+
+// Fills a detail level from model-space positions, faces and hierarchy, consuming the faces and the hierarchy.
+// edges, if given, is the level's edge list from an earlier build with the same faces: it is copied and only
+// its crease flags are recomputed.
+void buildDetailLevel(const std::vector<Vertex>& positions, std::vector<Face>& faceList, MeshBvh& bvh,
+    const ModelFrame& frame, bool compact, DetailLevel& level, const EdgeList* edges = nullptr);
+
+// Pixel mapping that fits the unit sphere into a width x height frame
+Projection fitProjection(int width, int height);
+
+// Builds the view state for a pair of angles and a pixel mapping: trig and the matrices, nothing per vertex
+ViewState makeViewState(float angleX, float angleY, const Projection& projection);
+
+// The same view drawn into a target scaled by scale in each dimension
+ViewState scaledViewState(const ViewState& view, float scale);
+
+// Combines a view with an instance placement from Scene::placements; the result projects that instance's mesh
+ViewState instanceViewState(const ViewState& view, const SceneInstance& placement);
+
+// Maps a normal's z component to the blue shading level (0x5F edge-on to 0xFF face-on)
+int shadeBlue(float nz);
+
+// Projects a level's vertices (SIMD kernel picked at startup) and rotates its face normals into context
+void projectLevel(const DetailLevel& level, const ViewState& view, RenderContext& context);
+
+// Collects the faces of the last projected level that can reach a width x height frame, dropping degenerate,
+// back-facing and off-screen ones. Walks the level's hierarchy when there is one, rejecting whole clusters where
+// it can. The list is drawn from the context's arena.
+void cullFaces(const DetailLevel& level, const ViewState& view, RenderContext& context, int width, int height,
+    bool cullBackFaces, FrameArray<VisibleFace>& visible, CullStats& stats);
+
+// True if the outline pass draws an edge: always, or in feature mode only for flagged and silhouette edges
+bool edgeShown(const DetailLevel& level, const AlignedFloats& normalDepth, bool featureEdgesOnly, uint32_t edge);
+
+// Lists the shown edges that border at least one visible face, in arena storage
+void collectVisibleEdges(const DetailLevel& level, RenderContext& context, bool featureEdgesOnly,
+    const FrameArray<VisibleFace>& visible, FrameArray<ScreenEdge>& edges);
+
+// Shaded triangles for the visible faces, in arena storage, ready for binTiles
+FrameArray<ScreenTriangle> shadedTriangles(const DetailLevel& level, RenderContext& context, const FrameArray<VisibleFace>& visible);
+
+// The context's screen stream as the tile renderer reads it
+ScreenVertexArrays screenArrays(const RenderContext& context);
+
+// Bins and draws the visible faces' shown edges, depth-tested, over a frame the faces were filled into
+void drawOutlines(const DetailLevel& level, RenderContext& context, bool featureEdgesOnly, FrameBuffer& frame,
+    const FrameArray<VisibleFace>& visible);
+
+// Stamps the projected vertices as dots, depth-tested unless the frame was painted without a depth buffer,
+// in which case vertexVisible picks the dots; dotGrid records drawn dots across passes
+DotStats drawVertexDots(const RenderContext& context, FrameBuffer& frame, const uint8_t* vertexVisible, bool depthTested,
+    uint8_t* dotGrid);
+
+// One complete pass of the last projected level: cull, fill, outline and dot. The frame is cleared to the
+// background first unless clear is false, when the faces go over what it holds. Counts add to stats and dots.
+// Returns false if hooks.interrupted() stopped the pass.
+bool drawLevel(const DetailLevel& level, const ViewState& view, const RenderSettings& settings, RenderContext& context,
+    FrameBuffer& frame, bool clear, uint8_t* dotGrid, RenderHooks& hooks, CullStats& stats, DotStats& dots);
+
+// Clears the frame and draws every instance of a scene, each projected through its placement in view and drawn
+// as one drawLevel pass. Stops at the first interrupted pass and returns false.
+bool drawScene(const Scene& scene, const ViewState& view, const RenderSettings& settings, RenderContext& context,
+    FrameBuffer& frame, uint8_t* dotGrid, RenderHooks& hooks, CullStats& stats, DotStats& dots);
+
+// Exchanges the geometry of two detail levels, leaving their face and vertex counts in place
+void swapLevelGeometry(DetailLevel& a, DetailLevel& b);
+
+// Returns the finest level within LOD_DRAG_FACE_BUDGET, or 0 if there are no coarser levels
+int dragDetailLevel(const std::vector<DetailLevel>& levels);
+
+// Builds a RenderMesh from parsed geometry, consuming it: hierarchy, normalization, normals and edges
+void buildRenderMesh(std::vector<Vertex>& vertices, std::vector<Face>& faces, RenderMesh& mesh);
+
+// Parses an object.txt file and builds it; returns false if it cannot be read or parsed
+bool loadRenderMesh(const char* path, RenderMesh& mesh);
+
+// Renders a mesh seen at a pair of angles into caller-owned 0x00RRGGBB pixels, width x height, rows top-down.
+// The unit sphere is fitted to the image as the viewer fits it to its window. Returns the cull counts.
+CullStats renderToMemory(const RenderMesh& mesh, float angleX, float angleY, const RenderSettings& settings,
+    RenderContext& context, uint32_t* pixels, int width, int height);
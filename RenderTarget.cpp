@@ -0,0 +1,65 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Render Target
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "RenderTarget.hpp"
+
+// Reallocate the DIB section only when the requested size differs from the current one
+bool resizeRenderTarget(RenderTarget& target, int width, int height) {
+    if (width <= 0 || height <= 0) return target.bitmap != nullptr;
+    if (target.bitmap && target.frame.width == width && target.frame.height == height) return true;
+
+    if (!target.memDC) {
+        target.memDC = CreateCompatibleDC(nullptr);
+        if (!target.memDC) return false;
+    }
+
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = width;
+    bmi.bmiHeader.biHeight = -height;   // Negative height: top-down rows
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+    void* bits = nullptr;
+    HBITMAP bitmap = CreateDIBSection(target.memDC, &bmi, DIB_RGB_COLORS, &bits, nullptr, 0);
+    if (!bitmap) return target.bitmap != nullptr;
+
+    // Swap the new bitmap in, keeping the DC's original bitmap for release
+    HBITMAP previous = (HBITMAP)SelectObject(target.memDC, bitmap);
+    if (target.bitmap) {
+        DeleteObject(target.bitmap);
+    }
+    else {
+        target.oldBitmap = previous;
+    }
+    target.bitmap = bitmap;
+    ++target.generation;
+    attachFrameBuffer(target.frame, static_cast<uint32_t*>(bits), width, height);
+    return true;
+}
+
+// Look up (or lazily create) the brush for one shading level
+HBRUSH shadeBrush(RenderTarget& target, int blue) {
+    if (blue < 0x5F) blue = 0x5F;
+    if (blue > 0xFF) blue = 0xFF;
+    HBRUSH& brush = target.shadeBrushes[blue - 0x5F];
+    if (!brush) brush = CreateSolidBrush(RGB(0, 0, blue));
+    return brush;
+}
+
+// Release all GDI objects owned by the target
+void releaseRenderTarget(RenderTarget& target) {
+    for (HBRUSH& brush : target.shadeBrushes) {
+        if (brush) DeleteObject(brush);
+        brush = nullptr;
+    }
+    if (target.memDC) {
+        if (target.oldBitmap) SelectObject(target.memDC, target.oldBitmap);
+        DeleteDC(target.memDC);
+    }
+    if (target.bitmap) DeleteObject(target.bitmap);
+    target = RenderTarget();
+}
@@ -0,0 +1,33 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Render target: the window's offscreen memory DC, its 32-bit
+//      DIB section and a cache of the GDI brushes used to draw into
+//      it. Created once, reallocated only when the window resizes.
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <windows.h>
+#include "Rasterizer.hpp"
+
+// Number of distinct shading levels, #00005F through #0000FF
+const int SHADE_LEVELS = 0xFF - 0x5F + 1;
+
+// Offscreen drawing surface that lives as long as the window
+struct RenderTarget {
+    HDC memDC = nullptr;                      // Memory DC the DIB section stays selected into
+    HBITMAP bitmap = nullptr;                 // 32-bit top-down DIB section
+    HBITMAP oldBitmap = nullptr;              // Bitmap originally selected into memDC
+    FrameBuffer frame;                        // Rasterizer view of the DIB pixels plus depth buffer
+    HBRUSH shadeBrushes[SHADE_LEVELS] = {};   // Solid blue brushes, created on first use
+    uint32_t generation = 0;                  // Bumped on every (re)allocation; the pixels are undefined after one
+};
+
+// (Re)allocates the DIB section when the size changes; returns false if the target is unusable
+bool resizeRenderTarget(RenderTarget& target, int width, int height);
+
+// Returns the cached solid brush for a blue level in [0x5F, 0xFF]
+HBRUSH shadeBrush(RenderTarget& target, int blue);
+
+// Frees the bitmap, memory DC and every cached brush
+void releaseRenderTarget(RenderTarget& target);
@@ -0,0 +1,43 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - CPU Renderer
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Renderer.hpp"
+#include "3DShaderViewer.hpp"
+
+namespace {
+
+// The existing CPU pipeline: renderFrame into renderTarget, then BitBlt
+class GdiRenderer : public Renderer {
+public:
+    ~GdiRenderer() override {
+        releaseRenderTarget(renderTarget);
+        releaseRenderTarget(previewTarget);
+    }
+
+    const char* name() const override {
+        return useSoftwareRasterizer ? "raster" : "GDI";
+    }
+
+    bool usesCpuTransform() const override {
+        return true;
+    }
+
+    bool resize(int width, int height) override {
+        return resizeRenderTarget(renderTarget, width, height);
+    }
+
+    void invalidateMesh() override {}
+
+    void draw(HDC hdc) override {
+        drawShadedModel(hdc);
+    }
+};
+
+} // namespace
+
+std::unique_ptr<Renderer> createGdiRenderer() {
+    return std::unique_ptr<Renderer>(new GdiRenderer());
+}
@@ -0,0 +1,39 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Renderer interface: the window front end draws through this,
+//      so the CPU renderers (software rasterizer or GDI painter's
+//      path, presented with BitBlt) and the Direct3D 11 backend are
+//      interchangeable at run time.
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <windows.h>
+#include <memory>
+
+// One way of turning the current mesh and view angles into pixels on the window
+class Renderer {
+public:
+    virtual ~Renderer() {}
+
+    // Short display name for titles and overlays
+    virtual const char* name() const = 0;
+
+    // True if draw reads the CPU-transformed streams, so applyTransform must run first
+    virtual bool usesCpuTransform() const = 0;
+
+    // Matches the drawing surface to the client area; returns false if the renderer is unusable
+    virtual bool resize(int width, int height) = 0;
+
+    // Drops anything derived from the mesh (GPU buffers); called when the geometry is replaced
+    virtual void invalidateMesh() = 0;
+
+    // Renders the current view and presents it to the window
+    virtual void draw(HDC hdc) = 0;
+};
+
+// CPU rendering into the shared back buffer, presented with BitBlt; always available
+std::unique_ptr<Renderer> createGdiRenderer();
+
+// Direct3D 11 rendering straight to a swap chain on hwnd; returns null if no device can be created
+std::unique_ptr<Renderer> createD3D11Renderer(HWND hwnd);
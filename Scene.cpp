@@ -0,0 +1,145 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Instanced Scenes
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Scene.hpp"
+#include "RenderCore.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#undef min
+#undef max
+
+namespace {
+
+// Directory part of a path, separator included; empty for a bare file name
+std::string directoryOf(const std::string& path) {
+    const size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+// Relative mesh paths are taken from the scene file's directory
+std::string resolvePath(const std::string& directory, const std::string& path) {
+    const bool absolute = !path.empty() && (path[0] == '/' || path[0] == '\\' || (path.size() > 1 && path[1] == ':'));
+    return absolute ? path : directory + path;
+}
+
+// r * v
+void rotateVector(const Matrix3& r, const float v[3], float out[3]) {
+    for (int row = 0; row < 3; ++row) out[row] = r.m[row][0] * v[0] + r.m[row][1] * v[1] + r.m[row][2] * v[2];
+}
+
+// Where an instance puts the centroid of its mesh, in model units
+void instanceCenter(const SceneInstance& instance, const ModelFrame& meshFrame, float out[3]) {
+    const float centroid[3] = { meshFrame.cx, meshFrame.cy, meshFrame.cz };
+    rotateVector(instance.rotation, centroid, out);
+    for (int k = 0; k < 3; ++k) out[k] = instance.scale * out[k] + instance.translation[k];
+}
+
+} // namespace
+
+// Parse line by line so an error can stop at the statement that caused it
+bool loadSceneFile(const char* path, SceneFile& scene) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    scene = SceneFile();
+    const std::string directory = directoryOf(path);
+    std::vector<std::string> names;
+    std::string line;
+    while (std::getline(file, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream words(line);
+        std::string keyword, name;
+        if (!(words >> keyword)) continue;
+        if (!(words >> name)) return false;
+
+        if (keyword == "mesh") {
+            std::string meshPath;
+            if (!(words >> meshPath) || std::find(names.begin(), names.end(), name) != names.end()) return false;
+            names.push_back(name);
+            scene.meshPaths.push_back(resolvePath(directory, meshPath));
+        }
+        else if (keyword == "instance") {
+            // Position, then optionally the three angles, then optionally the scale
+            const auto mesh = std::find(names.begin(), names.end(), name);
+            std::vector<float> numbers;
+            float value;
+            while (words >> value) numbers.push_back(value);
+            if (mesh == names.end() || !words.eof() || (numbers.size() != 3 && numbers.size() != 6 && numbers.size() != 7)) {
+                return false;
+            }
+            if (numbers.size() == 3) numbers.insert(numbers.end(), { 0.0f, 0.0f, 0.0f });
+            if (numbers.size() == 6) numbers.push_back(1.0f);
+            SceneInstance instance;
+            instance.mesh = static_cast<uint32_t>(mesh - names.begin());
+            instance.rotation = eulerRotation(numbers[3], numbers[4], numbers[5]);
+            instance.scale = numbers[6];
+            std::copy_n(numbers.begin(), 3, instance.translation);
+            if (!(instance.scale > 0)) return false;
+            scene.instances.push_back(instance);
+        }
+        else {
+            return false;
+        }
+    }
+
+    std::stable_sort(scene.instances.begin(), scene.instances.end(), [](const SceneInstance& a, const SceneInstance& b) {
+        return a.mesh < b.mesh;
+    });
+    return true;
+}
+
+// Rz * Ry * Rx, so X is applied first
+Matrix3 eulerRotation(float rx, float ry, float rz) {
+    float sx, cx, sy, cy, sz, cz;
+    sinCosDegrees(rx, sx, cx);
+    sinCosDegrees(ry, sy, cy);
+    sinCosDegrees(rz, sz, cz);
+    const Matrix3 x = { { { 1, 0, 0 }, { 0, cx, -sx }, { 0, sx, cx } } };
+    const Matrix3 y = { { { cy, 0, sy }, { 0, 1, 0 }, { -sy, 0, cy } } };
+    const Matrix3 z = { { { cz, -sz, 0 }, { sz, cz, 0 }, { 0, 0, 1 } } };
+    return multiplyMatrix(z, multiplyMatrix(y, x));
+}
+
+// Center of the box around every instance's sphere, then the farthest sphere surface from it
+ModelFrame sceneFrame(const std::vector<ModelFrame>& meshFrames, const std::vector<SceneInstance>& instances) {
+    if (instances.empty()) return { 0, 0, 0, 1 };
+
+    float lo[3], hi[3];
+    for (size_t i = 0; i < instances.size(); ++i) {
+        float center[3];
+        instanceCenter(instances[i], meshFrames[instances[i].mesh], center);
+        const float radius = instances[i].scale * meshFrames[instances[i].mesh].extent;
+        for (int k = 0; k < 3; ++k) {
+            lo[k] = i == 0 ? center[k] - radius : std::min(lo[k], center[k] - radius);
+            hi[k] = i == 0 ? center[k] + radius : std::max(hi[k], center[k] + radius);
+        }
+    }
+
+    ModelFrame frame = { (lo[0] + hi[0]) / 2, (lo[1] + hi[1]) / 2, (lo[2] + hi[2]) / 2, 0 };
+    for (const SceneInstance& instance : instances) {
+        float center[3];
+        instanceCenter(instance, meshFrames[instance.mesh], center);
+        const float dx = center[0] - frame.cx, dy = center[1] - frame.cy, dz = center[2] - frame.cz;
+        frame.extent = std::max(frame.extent, sqrtf(dx * dx + dy * dy + dz * dz) + instance.scale * meshFrames[instance.mesh].extent);
+    }
+    if (frame.extent <= 0) frame.extent = 1;
+    return frame;
+}
+
+// (s * R * (e * p + c) + t - sc) / se = (s * e / se) * R * p + (s * R * c + t - sc) / se
+SceneInstance normalizedInstance(const SceneInstance& instance, const ModelFrame& meshFrame, const ModelFrame& scene) {
+    SceneInstance out = instance;
+    float center[3];
+    instanceCenter(instance, meshFrame, center);
+    out.scale = instance.scale * meshFrame.extent / scene.extent;
+    out.translation[0] = (center[0] - scene.cx) / scene.extent;
+    out.translation[1] = (center[1] - scene.cy) / scene.extent;
+    out.translation[2] = (center[2] - scene.cz) / scene.extent;
+    return out;
+}
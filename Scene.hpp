@@ -0,0 +1,56 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Scenes of instanced meshes. A scene file names each unique
+//      mesh once and then places any number of copies of it, each
+//      with its own rotation, uniform scale and translation. Only
+//      the unique meshes and one placement per instance are kept in
+//      memory; the renderer draws all instances of a mesh as one
+//      batch, projecting the shared vertices once per instance.
+//
+//      File format, one statement per line ('#' starts a comment):
+//
+//          mesh <name> <path>
+//          instance <name> <x> <y> <z> [<rx> <ry> <rz> [<scale>]]
+//
+//      Paths are relative to the scene file and name object.txt
+//      format meshes. Angles are in degrees, applied about X, then
+//      Y, then Z; positions are in the mesh files' own units.
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "VertexTransform.hpp"
+
+struct ModelFrame;
+
+// One copy of a mesh: p' = scale * rotation * p + translation, in model units
+struct SceneInstance {
+    uint32_t mesh;          // Index into the scene's mesh list
+    Matrix3 rotation;
+    float scale;
+    float translation[3];
+};
+
+// A scene file as parsed, before any mesh is loaded
+struct SceneFile {
+    std::vector<std::string> meshPaths;     // In declaration order, resolved against the scene file's directory
+    std::vector<SceneInstance> instances;   // Sorted by mesh, file order within a mesh
+};
+
+// Reads a scene file; returns false if it cannot be read, a line is malformed or an instance names an
+// undeclared mesh. Instances come out sorted by mesh, so that each mesh's copies form one batch.
+bool loadSceneFile(const char* path, SceneFile& scene);
+
+// Rotation by rx about X, then ry about Y, then rz about Z, in degrees
+Matrix3 eulerRotation(float rx, float ry, float rz);
+
+// Centroid and radius of the whole scene, each instance taken as the bounding sphere of its mesh's frame
+ModelFrame sceneFrame(const std::vector<ModelFrame>& meshFrames, const std::vector<SceneInstance>& instances);
+
+// Maps an instance into the scene's normalized space as applied to its mesh's normalized positions: the mesh
+// frame is undone, the instance applied, and the scene frame applied. The result is again rotation, uniform
+// scale and translation, so view rotation and projection can absorb it.
+SceneInstance normalizedInstance(const SceneInstance& instance, const ModelFrame& meshFrame, const ModelFrame& scene);
@@ -0,0 +1,193 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Synthetic Meshes
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "SyntheticMesh.hpp"
+#include "MeshTypes.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+#undef min
+#undef max
+
+namespace {
+
+const float PI = 3.14159265f;
+
+// Appends a vertex with the next 1-based id
+void addVertex(std::vector<Vertex>& vertices, float x, float y, float z) {
+    vertices.push_back({ static_cast<int>(vertices.size() + 1), x, y, z });
+}
+
+// Two triangles over the quad a-b-c-d (counter-clockwise), all 0-based
+void addQuad(std::vector<Face>& faces, size_t a, size_t b, size_t c, size_t d) {
+    faces.push_back({ static_cast<int>(a + 1), static_cast<int>(b + 1), static_cast<int>(c + 1) });
+    faces.push_back({ static_cast<int>(a + 1), static_cast<int>(c + 1), static_cast<int>(d + 1) });
+}
+
+// Grid resolution n such that scale * n * n is close to the target
+size_t gridSteps(size_t targetTriangles, double scale, size_t minimum) {
+    size_t n = static_cast<size_t>(std::sqrt(targetTriangles / scale) + 0.5);
+    return n < minimum ? minimum : n;
+}
+
+// Stacks x 2*stacks slices, with single pole vertices: 4 * stacks^2 - 4 * stacks triangles
+void generateSphere(size_t targetTriangles, std::vector<Vertex>& vertices, std::vector<Face>& faces) {
+    const size_t stacks = gridSteps(targetTriangles, 4.0, 4);
+    const size_t slices = 2 * stacks;
+    vertices.reserve(2 + (stacks - 1) * slices);
+    faces.reserve(2 * slices * (stacks - 1));
+
+    addVertex(vertices, 0, 1, 0);
+    for (size_t i = 1; i < stacks; ++i) {
+        float theta = PI * i / stacks;
+        for (size_t j = 0; j < slices; ++j) {
+            float phi = 2 * PI * j / slices;
+            addVertex(vertices, sinf(theta) * cosf(phi), cosf(theta), -sinf(theta) * sinf(phi));
+        }
+    }
+    addVertex(vertices, 0, -1, 0);
+
+    const size_t south = vertices.size() - 1;
+    auto ring = [&](size_t i, size_t j) { return 1 + (i - 1) * slices + j % slices; };
+    for (size_t j = 0; j < slices; ++j) {
+        faces.push_back({ 1, static_cast<int>(ring(1, j) + 1), static_cast<int>(ring(1, j + 1) + 1) });
+    }
+    for (size_t i = 1; i + 1 < stacks; ++i) {
+        for (size_t j = 0; j < slices; ++j) {
+            addQuad(faces, ring(i, j), ring(i + 1, j), ring(i + 1, j + 1), ring(i, j + 1));
+        }
+    }
+    for (size_t j = 0; j < slices; ++j) {
+        faces.push_back({ static_cast<int>(ring(stacks - 1, j) + 1), static_cast<int>(south + 1), static_cast<int>(ring(stacks - 1, j + 1) + 1) });
+    }
+}
+
+// 2*rings x rings grid wrapped in both directions: 4 * rings^2 triangles
+void generateTorus(size_t targetTriangles, std::vector<Vertex>& vertices, std::vector<Face>& faces) {
+    const size_t minor = gridSteps(targetTriangles, 4.0, 3);
+    const size_t major = 2 * minor;
+    const float R = 1.0f, r = 0.4f;
+    vertices.reserve(major * minor);
+    faces.reserve(2 * major * minor);
+
+    for (size_t i = 0; i < major; ++i) {
+        float u = 2 * PI * i / major;
+        for (size_t j = 0; j < minor; ++j) {
+            float v = 2 * PI * j / minor;
+            float d = R + r * cosf(v);
+            addVertex(vertices, d * cosf(u), r * sinf(v), -d * sinf(u));
+        }
+    }
+
+    auto index = [&](size_t i, size_t j) { return (i % major) * minor + j % minor; };
+    for (size_t i = 0; i < major; ++i) {
+        for (size_t j = 0; j < minor; ++j) {
+            addQuad(faces, index(i, j), index(i + 1, j), index(i + 1, j + 1), index(i, j + 1));
+        }
+    }
+}
+
+// Integer lattice hash in [0, 1)
+float latticeNoise(int x, int y) {
+    uint32_t h = static_cast<uint32_t>(x) * 0x8DA6B343u ^ static_cast<uint32_t>(y) * 0xD8163841u;
+    h = (h ^ (h >> 13)) * 0x85EBCA6Bu;
+    h ^= h >> 16;
+    return (h & 0xFFFFFF) / 16777216.0f;
+}
+
+// Smoothly interpolated value noise
+float valueNoise(float x, float y) {
+    int x0 = static_cast<int>(floorf(x)), y0 = static_cast<int>(floorf(y));
+    float fx = x - x0, fy = y - y0;
+    fx = fx * fx * (3 - 2 * fx);
+    fy = fy * fy * (3 - 2 * fy);
+    float top = latticeNoise(x0, y0) + (latticeNoise(x0 + 1, y0) - latticeNoise(x0, y0)) * fx;
+    float bottom = latticeNoise(x0, y0 + 1) + (latticeNoise(x0 + 1, y0 + 1) - latticeNoise(x0, y0 + 1)) * fx;
+    return top + (bottom - top) * fy;
+}
+
+// Square grid in the XY plane facing the viewer, displaced along Z by three octaves of noise
+void generateNoiseGrid(size_t targetTriangles, std::vector<Vertex>& vertices, std::vector<Face>& faces) {
+    const size_t quads = gridSteps(targetTriangles, 2.0, 4);
+    const size_t side = quads + 1;
+    vertices.reserve(side * side);
+    faces.reserve(2 * quads * quads);
+
+    for (size_t i = 0; i < side; ++i) {
+        float y = 1 - 2.0f * i / quads;
+        for (size_t j = 0; j < side; ++j) {
+            float x = 2.0f * j / quads - 1;
+            float height = 0.25f * valueNoise(x * 2 + 7, y * 2 + 7)
+                + 0.12f * valueNoise(x * 5 + 3, y * 5 + 3)
+                + 0.06f * valueNoise(x * 11, y * 11);
+            addVertex(vertices, x, y, height);
+        }
+    }
+
+    for (size_t i = 0; i < quads; ++i) {
+        for (size_t j = 0; j < quads; ++j) {
+            size_t a = i * side + j;
+            addQuad(faces, a, a + side, a + side + 1, a + 1);
+        }
+    }
+}
+
+} // namespace
+
+bool parseSyntheticShape(const char* name, SyntheticShape& shape) {
+    if (strcmp(name, "sphere") == 0) shape = SyntheticShape::Sphere;
+    else if (strcmp(name, "torus") == 0) shape = SyntheticShape::Torus;
+    else if (strcmp(name, "grid") == 0) shape = SyntheticShape::NoiseGrid;
+    else return false;
+    return true;
+}
+
+// Dispatch on shape; the result replaces whatever the vectors held
+void generateSyntheticMesh(SyntheticShape shape, size_t targetTriangles, std::vector<Vertex>& vertices, std::vector<Face>& faces) {
+    vertices.clear();
+    faces.clear();
+    switch (shape) {
+    case SyntheticShape::Sphere: generateSphere(targetTriangles, vertices, faces); break;
+    case SyntheticShape::Torus: generateTorus(targetTriangles, vertices, faces); break;
+    case SyntheticShape::NoiseGrid: generateNoiseGrid(targetTriangles, vertices, faces); break;
+    }
+}
+
+// Same seed every run, so shuffled benchmarks stay comparable and golden images stay valid
+void shuffleMesh(std::vector<Vertex>& vertices, std::vector<Face>& faces) {
+    std::mt19937 random(12345);
+    std::vector<uint32_t> remap(vertices.size());
+    for (size_t i = 0; i < remap.size(); ++i) remap[i] = static_cast<uint32_t>(i);
+    std::shuffle(remap.begin(), remap.end(), random);
+
+    std::vector<Vertex> shuffled(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        shuffled[remap[i]] = { static_cast<int>(remap[i] + 1), vertices[i].x, vertices[i].y, vertices[i].z };
+    }
+    vertices.swap(shuffled);
+
+    for (Face& f : faces) {
+        f = { static_cast<int>(remap[f.v1 - 1] + 1), static_cast<int>(remap[f.v2 - 1] + 1), static_cast<int>(remap[f.v3 - 1] + 1) };
+    }
+    std::shuffle(faces.begin(), faces.end(), random);
+}
+
+// Buffered stdio; nine significant digits round-trip every float
+bool writeMeshFile(const char* path, const std::vector<Vertex>& vertices, const std::vector<Face>& faces) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+
+    setvbuf(file, nullptr, _IOFBF, 1 << 16);
+
+    fprintf(file, "%zu, %zu\n", vertices.size(), faces.size());
+    for (const auto& v : vertices) fprintf(file, "%d, %.9g, %.9g, %.9g\n", v.id, v.x, v.y, v.z);
+    for (const auto& f : faces) fprintf(file, "%d, %d, %d\n", f.v1, f.v2, f.v3);
+    return fclose(file) == 0;
+}
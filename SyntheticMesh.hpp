@@ -0,0 +1,30 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Synthetic test meshes for benchmarking: closed UV spheres and
+//      tori plus an open noise-displaced height grid, sized by target
+//      triangle count and written in object.txt format on demand.
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstddef>
+#include <vector>
+
+struct Vertex;
+struct Face;
+
+// Shapes the generator knows
+enum class SyntheticShape { Sphere, Torus, NoiseGrid };
+
+// Parses "sphere", "torus" or "grid"; returns false for anything else
+bool parseSyntheticShape(const char* name, SyntheticShape& shape);
+
+// Builds a mesh with approximately targetTriangles faces (at least a few dozen).
+// Closed shapes wind counter-clockwise seen from outside, matching the back-face test.
+void generateSyntheticMesh(SyntheticShape shape, size_t targetTriangles, std::vector<Vertex>& vertices, std::vector<Face>& faces);
+
+// Permutes face order and vertex numbering with a fixed seed, like the effectively random order of a scan export
+void shuffleMesh(std::vector<Vertex>& vertices, std::vector<Face>& faces);
+
+// Writes a mesh as object.txt text: header, "id, x, y, z" lines, then "v1, v2, v3" lines
+bool writeMeshFile(const char* path, const std::vector<Vertex>& vertices, const std::vector<Face>& faces);
@@ -0,0 +1,110 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Thread Pool
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "ThreadPool.hpp"
+
+// Spawn threadCount - 1 workers; the caller of run() is the remaining one
+ThreadPool::ThreadPool(unsigned threadCount) : job(nullptr), pending(0) {
+    if (threadCount == 0) threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0) threadCount = 1;
+
+    for (unsigned i = 0; i < threadCount; ++i) {
+        queues.emplace_back(new WorkQueue());
+    }
+    for (unsigned i = 1; i < threadCount; ++i) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+// Wake every worker with the stop flag set and wait for them to exit
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(stateLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& thread : threads) thread.join();
+}
+
+// Own queue first (front, keeps neighbouring tasks together), then steal from the others (back)
+bool ThreadPool::popTask(unsigned worker, size_t& task) {
+    {
+        WorkQueue& own = *queues[worker];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (own.next < own.end) {
+            task = own.next++;
+            return true;
+        }
+    }
+
+    for (unsigned offset = 1; offset < queues.size(); ++offset) {
+        WorkQueue& victim = *queues[(worker + offset) % queues.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (victim.next < victim.end) {
+            task = --victim.end;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Run tasks until none are left anywhere, signalling the caller after the last one
+void ThreadPool::drain(unsigned worker) {
+    size_t index;
+    while (popTask(worker, index)) {
+        (*job.load())(index, worker);
+        if (--pending == 0) {
+            { std::lock_guard<std::mutex> guard(stateLock); }
+            done.notify_all();
+        }
+    }
+}
+
+// Sleep until a new batch is published, then help drain it
+void ThreadPool::workerLoop(unsigned worker) {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(stateLock);
+    for (;;) {
+        wake.wait(lock, [&] { return stopping || generation != seen; });
+        if (stopping) return;
+        seen = generation;
+        lock.unlock();
+        drain(worker);
+        lock.lock();
+    }
+}
+
+// Deal the tasks out, wake the workers, work alongside them and wait for the batch to finish
+void ThreadPool::run(size_t taskCount, const PoolTask& task) {
+    if (taskCount == 0) return;
+    if (queues.size() == 1 || taskCount == 1) {
+        for (size_t i = 0; i < taskCount; ++i) task(i, 0);
+        return;
+    }
+
+    // Publish the job and the counter before any task becomes visible in a queue
+    pending = taskCount;
+    job = &task;
+
+    const size_t workers = queues.size();
+    for (size_t w = 0; w < workers; ++w) {
+        WorkQueue& queue = *queues[w];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        queue.next = taskCount * w / workers;
+        queue.end = taskCount * (w + 1) / workers;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(stateLock);
+        ++generation;
+    }
+    wake.notify_all();
+
+    drain(0);
+
+    std::unique_lock<std::mutex> lock(stateLock);
+    done.wait(lock, [&] { return pending == 0; });
+}
@@ -0,0 +1,73 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Fixed-size thread pool with per-worker task queues and work
+//      stealing. The calling thread joins in as worker 0, so a pool
+//      of one thread runs everything inline.
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Task callback: task index in [0, taskCount) and the worker running it. A non-owning reference to
+// any callable, so unlike std::function handing a capturing lambda to run() never allocates.
+class PoolTask {
+public:
+    template <typename F>
+    PoolTask(const F& f) : object(&f), invoke(&call<F>) {}
+
+    void operator()(size_t task, unsigned worker) const { invoke(object, task, worker); }
+
+private:
+    template <typename F>
+    static void call(const void* f, size_t task, unsigned worker) { (*static_cast<const F*>(f))(task, worker); }
+
+    const void* object;
+    void (*invoke)(const void*, size_t, unsigned);
+};
+
+class ThreadPool {
+public:
+    // threadCount 0 uses every hardware thread; the count includes the calling thread
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of workers, including the calling thread
+    unsigned size() const { return static_cast<unsigned>(queues.size()); }
+
+    // Runs task(i, worker) for every i in [0, taskCount) and returns once all have finished.
+    // Tasks are dealt out in contiguous blocks; idle workers steal from the back of busy queues.
+    void run(size_t taskCount, const PoolTask& task);
+
+private:
+    // Each worker is dealt one contiguous block, so its queue is just the range still unclaimed
+    struct WorkQueue {
+        std::mutex lock;
+        size_t next = 0;
+        size_t end = 0;
+    };
+
+    bool popTask(unsigned worker, size_t& task);
+    void drain(unsigned worker);
+    void workerLoop(unsigned worker);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> threads;
+    std::mutex stateLock;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::atomic<const PoolTask*> job;   // Published before the tasks, so a popped task always sees its own job
+    uint64_t generation = 0;
+    std::atomic<size_t> pending;
+    bool stopping = false;
+};
@@ -0,0 +1,203 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Tile Renderer
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "TileRenderer.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Range of tiles a primitive touches; x0 > x1 marks one that misses the frame
+struct TileSpan {
+    uint16_t x0, y0, x1, y1;
+};
+
+// Screen bounds of a triangle or edge, widened to whole tiles
+template <typename Primitive>
+TileSpan primitiveSpan(const TileRenderer& renderer, const FrameBuffer& fb, const ScreenVertexArrays& vertices, const Primitive& t) {
+    const size_t corners = sizeof(t.v) / sizeof(t.v[0]);
+    const int tileSize = renderer.config.tileSize;
+    const float maxX = static_cast<float>(fb.width), maxY = static_cast<float>(fb.height);
+
+    float x0 = vertices.x[t.v[0]], x1 = x0;
+    float y0 = vertices.y[t.v[0]], y1 = y0;
+    for (size_t c = 1; c < corners; ++c) {
+        x0 = std::min(x0, vertices.x[t.v[c]]);
+        x1 = std::max(x1, vertices.x[t.v[c]]);
+        y0 = std::min(y0, vertices.y[t.v[c]]);
+        y1 = std::max(y1, vertices.y[t.v[c]]);
+    }
+
+    // Comparisons are written so NaN coordinates fail them and the primitive is dropped
+    if (!(x0 < maxX && y0 < maxY && x1 >= 0 && y1 >= 0)) return { 1, 0, 0, 0 };
+
+    // One pixel of slack covers the rasterizer's conservative rounding
+    TileSpan span;
+    span.x0 = static_cast<uint16_t>(std::max(0, static_cast<int>(std::max(x0, 0.0f)) - 1) / tileSize);
+    span.y0 = static_cast<uint16_t>(std::max(0, static_cast<int>(std::max(y0, 0.0f)) - 1) / tileSize);
+    span.x1 = static_cast<uint16_t>(std::min(fb.width - 1, static_cast<int>(std::min(x1, maxX)) + 1) / tileSize);
+    span.y1 = static_cast<uint16_t>(std::min(fb.height - 1, static_cast<int>(std::min(y1, maxY)) + 1) / tileSize);
+    return span;
+}
+
+// Bin a triangle or edge list in two parallel passes over contiguous slices of it: each slice first counts
+// its primitives per tile, the counts become offsets, and each slice then writes its indices. A tile's
+// bins are laid out slice after slice, so its primitives come out in list order.
+template <typename Primitive>
+void binPrimitives(TileRenderer& renderer, FrameArena& arena, TileBins& bins, const FrameBuffer& fb,
+    const ScreenVertexArrays& vertices, const Primitive* primitives, size_t count) {
+    const size_t slices = renderer.pool->size();
+    const size_t tiles = static_cast<size_t>(renderer.tilesX) * renderer.tilesY;
+    const size_t tilesX = static_cast<size_t>(renderer.tilesX);
+
+    // Counts, then write cursors, slice-major so no two slices share more than a cache line of them
+    TileSpan* spans = frameAllocate<TileSpan>(arena, count);
+    uint32_t* cursors = frameAllocateZeroed<uint32_t>(arena, slices * tiles);
+
+    renderer.pool->run(slices, [&](size_t slice, unsigned) {
+        uint32_t* sliceCounts = cursors + slice * tiles;
+        for (size_t i = count * slice / slices; i < count * (slice + 1) / slices; ++i) {
+            const TileSpan span = primitiveSpan(renderer, fb, vertices, primitives[i]);
+            spans[i] = span;
+            for (size_t ty = span.y0; ty <= span.y1; ++ty) {
+                for (size_t tx = span.x0; tx <= span.x1; ++tx) ++sliceCounts[ty * tilesX + tx];
+            }
+        }
+        });
+
+    bins.offsets = frameAllocate<uint32_t>(arena, tiles * slices + 1);
+    uint32_t total = 0;
+    for (size_t tile = 0; tile < tiles; ++tile) {
+        for (size_t slice = 0; slice < slices; ++slice) {
+            uint32_t& cursor = cursors[slice * tiles + tile];
+            bins.offsets[tile * slices + slice] = total;
+            total += cursor;
+            cursor = bins.offsets[tile * slices + slice];
+        }
+    }
+    bins.offsets[tiles * slices] = total;
+    bins.indices = frameAllocate<uint32_t>(arena, total);
+
+    renderer.pool->run(slices, [&](size_t slice, unsigned) {
+        uint32_t* sliceCursors = cursors + slice * tiles;
+        for (size_t i = count * slice / slices; i < count * (slice + 1) / slices; ++i) {
+            const TileSpan span = spans[i];
+            for (size_t ty = span.y0; ty <= span.y1; ++ty) {
+                for (size_t tx = span.x0; tx <= span.x1; ++tx) {
+                    bins.indices[sliceCursors[ty * tilesX + tx]++] = static_cast<uint32_t>(i);
+                }
+            }
+        }
+        });
+}
+
+// Every primitive binned to one tile, in list order
+void tileRange(const TileRenderer& renderer, const TileBins& bins, size_t tile, const uint32_t*& begin, const uint32_t*& end) {
+    const size_t slices = renderer.pool->size();
+    begin = bins.indices + bins.offsets[tile * slices];
+    end = bins.indices + bins.offsets[(tile + 1) * slices];
+}
+
+// Pixel bounds of a tile, trimmed to the frame
+PixelRect tileRect(const TileRenderer& renderer, size_t tile, const FrameBuffer& fb) {
+    const int tileSize = renderer.config.tileSize;
+    const int tx = static_cast<int>(tile % renderer.tilesX), ty = static_cast<int>(tile / renderer.tilesX);
+    return { tx * tileSize, ty * tileSize, std::min(fb.width, (tx + 1) * tileSize), std::min(fb.height, (ty + 1) * tileSize) };
+}
+
+// Clear one tile, unless drawing over it, and fill every triangle binned to it, in slice order
+void fillTile(TileRenderer& renderer, size_t tile, FrameBuffer& fb, const ScreenVertexArrays& vertices,
+    const ScreenTriangle* triangles, bool clear, uint32_t clearColor) {
+    const PixelRect clip = tileRect(renderer, tile, fb);
+    if (clear) clearFrameBuffer(fb, clearColor, clip);
+
+    const uint32_t *begin, *end;
+    tileRange(renderer, renderer.bins, tile, begin, end);
+    for (const uint32_t* index = begin; index != end; ++index) {
+        const ScreenTriangle& t = triangles[*index];
+        ScreenVertex a = { vertices.x[t.v[0]], vertices.y[t.v[0]], vertices.z[t.v[0]] };
+        ScreenVertex b = { vertices.x[t.v[1]], vertices.y[t.v[1]], vertices.z[t.v[1]] };
+        ScreenVertex c = { vertices.x[t.v[2]], vertices.y[t.v[2]], vertices.z[t.v[2]] };
+        fillTriangle(fb, a, b, c, t.color, clip);
+    }
+}
+
+// Draw every edge binned to one tile against its finished depth
+void drawTileEdges(TileRenderer& renderer, size_t tile, FrameBuffer& fb, const ScreenVertexArrays& vertices,
+    const ScreenEdge* edges, uint32_t wireColor, float wireDepthBias) {
+    const PixelRect clip = tileRect(renderer, tile, fb);
+
+    const uint32_t *begin, *end;
+    tileRange(renderer, renderer.edgeBins, tile, begin, end);
+    for (const uint32_t* index = begin; index != end; ++index) {
+        const ScreenEdge& e = edges[*index];
+        ScreenVertex a = { vertices.x[e.v[0]], vertices.y[e.v[0]], vertices.z[e.v[0]] };
+        ScreenVertex b = { vertices.x[e.v[1]], vertices.y[e.v[1]], vertices.z[e.v[1]] };
+        drawLine(fb, a, b, wireColor, wireDepthBias, clip);
+    }
+}
+
+} // namespace
+
+// Store the settings; the pool is only rebuilt when its size actually changes
+void configureTileRenderer(TileRenderer& renderer, const TileRendererConfig& config) {
+    renderer.config = config;
+    if (renderer.config.tileSize < 8) renderer.config.tileSize = 8;
+
+    unsigned threads = config.threadCount ? config.threadCount : std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    if (!renderer.pool || renderer.pool->size() != threads) {
+        renderer.pool.reset(new ThreadPool(threads));
+    }
+    renderer.tilesX = renderer.tilesY = 0;
+}
+
+// Size the tile grid for the frame, then bin in parallel slices
+bool binTiles(TileRenderer& renderer, FrameArena& arena, const FrameBuffer& fb, const ScreenVertexArrays& vertices,
+    const ScreenTriangle* triangles, size_t triangleCount) {
+    if (!renderer.pool) configureTileRenderer(renderer, renderer.config);
+    if (fb.width <= 0 || fb.height <= 0) return false;
+
+    const int tileSize = renderer.config.tileSize;
+    renderer.tilesX = (fb.width + tileSize - 1) / tileSize;
+    renderer.tilesY = (fb.height + tileSize - 1) / tileSize;
+    binPrimitives(renderer, arena, renderer.bins, fb, vertices, triangles, triangleCount);
+    return true;
+}
+
+// Clear and fill tiles in parallel
+void fillTiles(TileRenderer& renderer, FrameBuffer& fb, const ScreenVertexArrays& vertices,
+    const ScreenTriangle* triangles, uint32_t clearColor) {
+    renderer.pool->run(static_cast<size_t>(renderer.tilesX) * renderer.tilesY, [&](size_t tile, unsigned) {
+        fillTile(renderer, tile, fb, vertices, triangles, true, clearColor);
+        });
+}
+
+// The same without the clear
+void fillTilesOver(TileRenderer& renderer, FrameBuffer& fb, const ScreenVertexArrays& vertices, const ScreenTriangle* triangles) {
+    renderer.pool->run(static_cast<size_t>(renderer.tilesX) * renderer.tilesY, [&](size_t tile, unsigned) {
+        fillTile(renderer, tile, fb, vertices, triangles, false, 0);
+        });
+}
+
+// Bin the edges with the tile grid binTiles set up, then overlay them in parallel
+void drawEdgesTiled(TileRenderer& renderer, FrameArena& arena, FrameBuffer& fb, const ScreenVertexArrays& vertices,
+    const ScreenEdge* edges, size_t edgeCount, uint32_t wireColor, float wireDepthBias) {
+    binPrimitives(renderer, arena, renderer.edgeBins, fb, vertices, edges, edgeCount);
+
+    renderer.pool->run(static_cast<size_t>(renderer.tilesX) * renderer.tilesY, [&](size_t tile, unsigned) {
+        drawTileEdges(renderer, tile, fb, vertices, edges, wireColor, wireDepthBias);
+        });
+}
+
+// All three passes back to back
+void renderTiles(TileRenderer& renderer, FrameArena& arena, FrameBuffer& fb, const ScreenVertexArrays& vertices,
+    const ScreenTriangle* triangles, size_t triangleCount, const ScreenEdge* edges, size_t edgeCount,
+    uint32_t clearColor, uint32_t wireColor, float wireDepthBias) {
+    if (!binTiles(renderer, arena, fb, vertices, triangles, triangleCount)) return;
+    fillTiles(renderer, fb, vertices, triangles, clearColor);
+    drawEdgesTiled(renderer, arena, fb, vertices, edges, edgeCount, wireColor, wireDepthBias);
+}
@@ -0,0 +1,82 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Tile-binned parallel renderer: splits the frame into square
+//      screen tiles, bins triangles into every tile they touch and
+//      rasterizes tiles on a thread pool. Each tile is owned by one
+//      worker at a time, so color and depth writes need no locks.
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <memory>
+#include "FrameArena.hpp"
+#include "Rasterizer.hpp"
+#include "ThreadPool.hpp"
+
+// Triangle ready for binning: 0-based indices into the screen arrays plus its flat fill color
+struct ScreenTriangle {
+    uint32_t v[3];
+    uint32_t color;
+};
+
+// Line segment for the edge overlay: 0-based indices into the screen arrays
+struct ScreenEdge {
+    uint32_t v[2];
+};
+
+// Screen-space positions (pixels) and view-space depth, indexed by vertex
+struct ScreenVertexArrays {
+    const float* x;
+    const float* y;
+    const float* z;
+};
+
+// User-tunable renderer settings
+struct TileRendererConfig {
+    int tileSize = 64;          // Tile edge in pixels
+    unsigned threadCount = 0;   // Worker threads including the caller; 0 uses every hardware thread
+};
+
+// One frame's primitive lists in frame arena storage. Bins are keyed tile-major, (tile, slice), so each
+// tile's primitives are one contiguous run of indices in list order.
+struct TileBins {
+    uint32_t* offsets = nullptr;    // tiles * slices + 1 entries; bin k is indices[offsets[k], offsets[k + 1])
+    uint32_t* indices = nullptr;
+};
+
+// Thread pool plus the bins of the frame being drawn
+struct TileRenderer {
+    std::unique_ptr<ThreadPool> pool;
+    TileRendererConfig config;
+    int tilesX = 0;
+    int tilesY = 0;
+    TileBins bins;        // Triangle indices
+    TileBins edgeBins;    // Edge indices
+};
+
+// Applies a configuration, (re)creating the thread pool if the thread count changed
+void configureTileRenderer(TileRenderer& renderer, const TileRendererConfig& config);
+
+// Sizes the tile grid for the frame and sorts triangles into the tiles they touch, with the bins drawn
+// from arena. Returns false for an empty frame, in which case the other passes must be skipped.
+bool binTiles(TileRenderer& renderer, FrameArena& arena, const FrameBuffer& fb, const ScreenVertexArrays& vertices,
+    const ScreenTriangle* triangles, size_t triangleCount);
+
+// Clears every tile and fills its binned triangles; requires binTiles for the same frame
+void fillTiles(TileRenderer& renderer, FrameBuffer& fb, const ScreenVertexArrays& vertices,
+    const ScreenTriangle* triangles, uint32_t clearColor);
+
+// Fills the binned triangles depth-tested against what the frame already holds, for a frame drawn in several
+// passes; requires binTiles for the same pass
+void fillTilesOver(TileRenderer& renderer, FrameBuffer& fb, const ScreenVertexArrays& vertices, const ScreenTriangle* triangles);
+
+// Bins edges into the tiles of the last binTiles call and overlays them, depth-tested,
+// once fillTiles has finished the depth buffer
+void drawEdgesTiled(TileRenderer& renderer, FrameArena& arena, FrameBuffer& fb, const ScreenVertexArrays& vertices,
+    const ScreenEdge* edges, size_t edgeCount, uint32_t wireColor, float wireDepthBias);
+
+// Runs binTiles, fillTiles and drawEdgesTiled in turn.
+// Within a tile triangles are drawn in list order, so output matches a serial render.
+void renderTiles(TileRenderer& renderer, FrameArena& arena, FrameBuffer& fb, const ScreenVertexArrays& vertices,
+    const ScreenTriangle* triangles, size_t triangleCount, const ScreenEdge* edges, size_t edgeCount,
+    uint32_t clearColor, uint32_t wireColor, float wireDepthBias);
@@ -0,0 +1,336 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//       Software Assessment: Shader Model Viewer - Vertex Transform Kernels
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "VertexTransform.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SHADER_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// GCC and Clang only emit AVX2 instructions inside functions that opt in; MSVC needs no attribute
+#if defined(SHADER_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SHADER_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SHADER_TARGET_AVX2
+#endif
+
+namespace {
+
+// Kernel signature shared by every implementation; n is the padded vertex count
+typedef void (*TransformFn)(const VertexStream& in, const AffineTransform& a, size_t n, ScreenStream& out);
+
+// Quantized-input signature; the matrix already includes the dequantization
+typedef void (*QuantizedTransformFn)(const QuantizedStream& in, const AffineTransform& a, size_t n, ScreenStream& out);
+
+// One row of the matrix, added in the same order by every kernel so they agree bit for bit
+inline float affineRow(const AffineTransform& a, int row, float x, float y, float z) {
+    return a.m[row][0] * x + a.m[row][1] * y + a.m[row][2] * z + a.t[row];
+}
+
+// Reference implementation, also used on CPUs without SSE
+template <typename Stream>
+void transformScalar(const Stream& in, const AffineTransform& a, size_t n, ScreenStream& out) {
+    for (size_t i = 0; i < n; ++i) {
+        float x = in.x[i], y = in.y[i], z = in.z[i];
+        out.x[i] = affineRow(a, 0, x, y, z);
+        out.y[i] = affineRow(a, 1, x, y, z);
+        out.z[i] = affineRow(a, 2, x, y, z);
+    }
+}
+
+#ifdef SHADER_X86
+
+// Four floats
+inline __m128 loadSSE(const float* p) {
+    return _mm_load_ps(p);
+}
+
+// Four 16-bit values widened to floats; SSE2 has no unsigned widening, so interleave with zeros
+inline __m128 loadSSE(const uint16_t* p) {
+    __m128i q = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(q, _mm_setzero_si128()));
+}
+
+// Matrix row broadcast into registers
+struct RowSSE {
+    __m128 m0, m1, m2, t;
+
+    explicit RowSSE(const AffineTransform& a, int row)
+        : m0(_mm_set1_ps(a.m[row][0])), m1(_mm_set1_ps(a.m[row][1])), m2(_mm_set1_ps(a.m[row][2])),
+          t(_mm_set1_ps(a.t[row])) {}
+
+    __m128 apply(__m128 x, __m128 y, __m128 z) const {
+        return _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, x), _mm_mul_ps(m1, y)), _mm_mul_ps(m2, z)), t);
+    }
+};
+
+// Four vertices per iteration
+template <typename Stream>
+void transformSSE(const Stream& in, const AffineTransform& a, size_t n, ScreenStream& out) {
+    const RowSSE rx(a, 0), ry(a, 1), rz(a, 2);
+    for (size_t i = 0; i < n; i += 4) {
+        __m128 x = loadSSE(&in.x[i]);
+        __m128 y = loadSSE(&in.y[i]);
+        __m128 z = loadSSE(&in.z[i]);
+        _mm_store_ps(&out.x[i], rx.apply(x, y, z));
+        _mm_store_ps(&out.y[i], ry.apply(x, y, z));
+        _mm_store_ps(&out.z[i], rz.apply(x, y, z));
+    }
+}
+
+// Eight floats
+SHADER_TARGET_AVX2
+inline __m256 loadAVX2(const float* p) {
+    return _mm256_load_ps(p);
+}
+
+// Eight 16-bit values, widened with one instruction
+SHADER_TARGET_AVX2
+inline __m256 loadAVX2(const uint16_t* p) {
+    return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(p))));
+}
+
+// Eight vertices per iteration; no FMA so results match the scalar and SSE paths bit for bit
+template <typename Stream>
+SHADER_TARGET_AVX2
+void transformAVX2(const Stream& in, const AffineTransform& a, size_t n, ScreenStream& out) {
+    __m256 m[3][3], t[3];
+    for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 3; ++col) m[row][col] = _mm256_set1_ps(a.m[row][col]);
+        t[row] = _mm256_set1_ps(a.t[row]);
+    }
+    float* outAxes[3] = { out.x.data(), out.y.data(), out.z.data() };
+
+    for (size_t i = 0; i < n; i += 8) {
+        __m256 x = loadAVX2(&in.x[i]);
+        __m256 y = loadAVX2(&in.y[i]);
+        __m256 z = loadAVX2(&in.z[i]);
+        for (int row = 0; row < 3; ++row) {
+            __m256 v = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[row][0], x),
+                _mm256_mul_ps(m[row][1], y)), _mm256_mul_ps(m[row][2], z)), t[row]);
+            _mm256_store_ps(outAxes[row] + i, v);
+        }
+    }
+}
+
+// CPUID wrapper for both compiler families
+void cpuid(int leaf, int subleaf, unsigned regs[4]) {
+#ifdef _MSC_VER
+    int r[4];
+    __cpuidex(r, leaf, subleaf);
+    for (int i = 0; i < 4; ++i) regs[i] = static_cast<unsigned>(r[i]);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// Reads XCR0 to confirm the OS saves YMM state across context switches
+uint64_t readXCR0() {
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    uint32_t lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+#endif
+}
+
+#endif // SHADER_X86
+
+// Kernel table indexed by TransformKernel
+TransformFn kernelFunction(TransformKernel kernel) {
+#ifdef SHADER_X86
+    if (kernel == TransformKernel::AVX2) return transformAVX2<VertexStream>;
+    if (kernel == TransformKernel::SSE) return transformSSE<VertexStream>;
+#endif
+    (void)kernel;
+    return transformScalar<VertexStream>;
+}
+
+// Same table for the quantized kernels
+QuantizedTransformFn quantizedKernelFunction(TransformKernel kernel) {
+#ifdef SHADER_X86
+    if (kernel == TransformKernel::AVX2) return transformAVX2<QuantizedStream>;
+    if (kernel == TransformKernel::SSE) return transformSSE<QuantizedStream>;
+#endif
+    (void)kernel;
+    return transformScalar<QuantizedStream>;
+}
+
+// Query CPUID for SSE2 and AVX2, including OS support for the wider registers
+TransformKernel queryTransformKernel() {
+#ifdef SHADER_X86
+    unsigned regs[4];
+    cpuid(0, 0, regs);
+    unsigned maxLeaf = regs[0];
+
+    cpuid(1, 0, regs);
+    bool sse2 = (regs[3] & (1u << 26)) != 0;
+    bool osxsave = (regs[2] & (1u << 27)) != 0;
+    bool avx = (regs[2] & (1u << 28)) != 0;
+
+    bool avx2 = false;
+    if (maxLeaf >= 7 && osxsave && avx && (readXCR0() & 0x6) == 0x6) {
+        cpuid(7, 0, regs);
+        avx2 = (regs[1] & (1u << 5)) != 0;
+    }
+
+    if (avx2) return TransformKernel::AVX2;
+    if (sse2) return TransformKernel::SSE;
+#endif
+    return TransformKernel::Scalar;
+}
+
+} // namespace
+
+// Size the stream, rounding up to whole SIMD registers with zeroed padding
+void resizeVertexStream(VertexStream& stream, size_t count) {
+    size_t padded = (count + VERTEX_LANES - 1) / VERTEX_LANES * VERTEX_LANES;
+    stream.x.assign(padded, 0.0f);
+    stream.y.assign(padded, 0.0f);
+    stream.z.assign(padded, 0.0f);
+    stream.count = count;
+}
+
+// Same padding rule as resizeVertexStream; the padding lanes are computed but never read
+void resizeScreenStream(ScreenStream& screen, size_t count) {
+    size_t padded = (count + VERTEX_LANES - 1) / VERTEX_LANES * VERTEX_LANES;
+    screen.x.resize(padded);
+    screen.y.resize(padded);
+    screen.z.resize(padded);
+    screen.count = count;
+}
+
+// Scale and flip the first two rows into pixels and put the center in the translation
+AffineTransform screenTransform(const Matrix3& r, const Projection& p) {
+    AffineTransform a;
+    for (int col = 0; col < 3; ++col) {
+        a.m[0][col] = r.m[0][col] * p.scale;
+        a.m[1][col] = -r.m[1][col] * p.scale;
+        a.m[2][col] = r.m[2][col];
+    }
+    a.t[0] = p.centerX;
+    a.t[1] = p.centerY;
+    a.t[2] = 0;
+    return a;
+}
+
+// Plain row-by-column product
+Matrix3 multiplyMatrix(const Matrix3& a, const Matrix3& b) {
+    Matrix3 c;
+    for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 3; ++col) {
+            c.m[row][col] = a.m[row][0] * b.m[0][col] + a.m[row][1] * b.m[1][col] + a.m[row][2] * b.m[2][col];
+        }
+    }
+    return c;
+}
+
+// Per-axis bounds of the real vertices, then round to the nearest step; a flat axis keeps scale 0 and q 0
+void quantizeVertexStream(const VertexStream& in, QuantizedStream& out) {
+    const size_t padded = in.x.size();
+    out.x.assign(padded, 0);
+    out.y.assign(padded, 0);
+    out.z.assign(padded, 0);
+    out.count = in.count;
+
+    const AlignedFloats* axes[3] = { &in.x, &in.y, &in.z };
+    AlignedShorts* outAxes[3] = { &out.x, &out.y, &out.z };
+    for (int axis = 0; axis < 3; ++axis) {
+        const AlignedFloats& values = *axes[axis];
+        float lo = 0, hi = 0;
+        if (in.count > 0) {
+            lo = *std::min_element(values.begin(), values.begin() + in.count);
+            hi = *std::max_element(values.begin(), values.begin() + in.count);
+        }
+        out.offset[axis] = lo;
+        out.scale[axis] = hi > lo ? (hi - lo) / 65535.0f : 0.0f;
+        if (out.scale[axis] == 0) continue;
+
+        const float inverse = 65535.0f / (hi - lo);
+        AlignedShorts& q = *outAxes[axis];
+        for (size_t i = 0; i < in.count; ++i) {
+            float step = std::floor((values[i] - lo) * inverse + 0.5f);
+            q[i] = static_cast<uint16_t>(std::min(std::max(step, 0.0f), 65535.0f));
+        }
+    }
+}
+
+// Padding lanes come out as the box minimum, which nothing reads
+void dequantizeVertexStream(const QuantizedStream& in, VertexStream& out) {
+    resizeVertexStream(out, in.count);
+    for (size_t i = 0; i < in.count; ++i) {
+        out.x[i] = in.offset[0] + in.x[i] * in.scale[0];
+        out.y[i] = in.offset[1] + in.y[i] * in.scale[1];
+        out.z[i] = in.offset[2] + in.z[i] * in.scale[2];
+    }
+}
+
+// m * (offset + diag(scale) * q) + t = (m * diag(scale)) * q + (m * offset + t)
+AffineTransform foldDequantization(const AffineTransform& a, const QuantizedStream& stream) {
+    AffineTransform folded;
+    for (int row = 0; row < 3; ++row) {
+        folded.t[row] = a.t[row];
+        for (int col = 0; col < 3; ++col) {
+            folded.m[row][col] = a.m[row][col] * stream.scale[col];
+            folded.t[row] += a.m[row][col] * stream.offset[col];
+        }
+    }
+    return folded;
+}
+
+// The CPU cannot change under a running process, so one query serves every render context
+TransformKernel detectTransformKernel() {
+    static const TransformKernel best = queryTransformKernel();
+    return best;
+}
+
+// Kernels are ordered by width, so anything past the best supported one is clamped to it
+TransformKernel supportedTransformKernel(TransformKernel kernel) {
+    TransformKernel best = detectTransformKernel();
+    return static_cast<int>(kernel) > static_cast<int>(best) ? best : kernel;
+}
+
+// Display name for logs and overlays
+const char* transformKernelName(TransformKernel kernel) {
+    switch (kernel) {
+    case TransformKernel::AVX2: return "AVX2";
+    case TransformKernel::SSE: return "SSE";
+    default: return "scalar";
+    }
+}
+
+// Project the whole stream with the caller's kernel
+void transformVertices(const VertexStream& in, const AffineTransform& a, TransformKernel kernel, ScreenStream& out) {
+    kernelFunction(kernel)(in, a, in.x.size(), out);
+}
+
+// Quantized positions through the matching kernel
+void transformQuantizedVertices(const QuantizedStream& in, const AffineTransform& a, TransformKernel kernel, ScreenStream& out) {
+    quantizedKernelFunction(kernel)(in, foldDequantization(a, in), in.x.size(), out);
+}
+
+// Third matrix row only; a plain SoA loop the compiler vectorizes on its own
+void rotateDepth(const VertexStream& in, const Matrix3& r, AlignedFloats& out) {
+    const float r0 = r.m[2][0], r1 = r.m[2][1], r2 = r.m[2][2];
+    const float* x = in.x.data();
+    const float* y = in.y.data();
+    const float* z = in.z.data();
+    float* result = out.data();
+    const size_t n = in.x.size();
+    for (size_t i = 0; i < n; ++i) {
+        result[i] = r0 * x[i] + r1 * y[i] + r2 * z[i];
+    }
+}
@@ -0,0 +1,137 @@
+/////////////////////////////////////////////////////////////////
+//
+//      Vertex transform kernels: structure-of-arrays vertex storage,
+//      full-precision or quantized to 16 bits, and kernels that take
+//      every vertex straight to pixels and depth with one 3x4 matrix,
+//      in scalar, SSE and AVX2 flavors picked at runtime from the
+//      CPU's feature flags.
+//
+/////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// SIMD width the vertex streams are padded to (one AVX2 register of floats)
+const size_t VERTEX_LANES = 8;
+
+// Row-major 3x3 matrix used for the per-frame model rotation
+struct Matrix3 {
+    float m[3][3];
+};
+
+// Minimal allocator handing out 32-byte aligned storage for SIMD loads and stores
+template <typename T>
+struct AlignedAllocator {
+    typedef T value_type;
+    static const size_t ALIGNMENT = 32;
+
+    AlignedAllocator() = default;
+    template <typename U> AlignedAllocator(const AlignedAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        void* p = ::operator new(n * sizeof(T), std::align_val_t(ALIGNMENT));
+        return static_cast<T*>(p);
+    }
+    void deallocate(T* p, size_t) {
+        ::operator delete(p, std::align_val_t(ALIGNMENT));
+    }
+
+    template <typename U> bool operator==(const AlignedAllocator<U>&) const { return true; }
+    template <typename U> bool operator!=(const AlignedAllocator<U>&) const { return false; }
+};
+
+// 32-byte aligned float array
+typedef std::vector<float, AlignedAllocator<float>> AlignedFloats;
+
+// 32-byte aligned array of 16-bit values
+typedef std::vector<uint16_t, AlignedAllocator<uint16_t>> AlignedShorts;
+
+// Vertex positions stored as separate x/y/z arrays, padded with zeros to a multiple of VERTEX_LANES
+struct VertexStream {
+    AlignedFloats x;
+    AlignedFloats y;
+    AlignedFloats z;
+    size_t count = 0;   // Number of real vertices (arrays may be longer)
+};
+
+// Positions quantized to 16 bits within their bounding box: p = offset + q * scale per axis.
+// Half the size of a VertexStream, padded the same way.
+struct QuantizedStream {
+    AlignedShorts x;
+    AlignedShorts y;
+    AlignedShorts z;
+    size_t count = 0;
+    float offset[3] = { 0, 0, 0 };  // Box minimum
+    float scale[3] = { 0, 0, 0 };   // Box extent / 65535
+};
+
+// 3x4 matrix: out = m * in + t
+struct AffineTransform {
+    float m[3][3];
+    float t[3];
+};
+
+// Every vertex projected once for the frame, parallel to the stream it came from; faces index into it
+struct ScreenStream {
+    AlignedFloats x;    // Pixel column
+    AlignedFloats y;    // Pixel row
+    AlignedFloats z;    // View-space depth; larger is nearer
+    size_t count = 0;
+};
+
+// Screen mapping applied after rotation: screen = center + (x, -y) * scale
+struct Projection {
+    float scale;
+    float centerX;
+    float centerY;
+};
+
+// Available transform kernel implementations
+enum class TransformKernel {
+    Scalar,
+    SSE,
+    AVX2
+};
+
+// Sizes a vertex stream for count vertices, zeroing the padding lanes
+void resizeVertexStream(VertexStream& stream, size_t count);
+
+// Sizes a screen stream for count vertices with the same padding as a vertex stream
+void resizeScreenStream(ScreenStream& screen, size_t count);
+
+// Rotation, scale and centering in one matrix: rows give pixel x, pixel y and view depth
+AffineTransform screenTransform(const Matrix3& r, const Projection& p);
+
+// Returns a * b, the matrix that applies b first
+Matrix3 multiplyMatrix(const Matrix3& a, const Matrix3& b);
+
+// Quantizes a stream within its own bounds; the error is at most half a step of 1/65535 of the box per axis
+void quantizeVertexStream(const VertexStream& in, QuantizedStream& out);
+
+// Expands a quantized stream back to floats
+void dequantizeVertexStream(const QuantizedStream& in, VertexStream& out);
+
+// Combines a transform with a quantized stream's offset and scale, so the same multiply-adds dequantize as well
+AffineTransform foldDequantization(const AffineTransform& a, const QuantizedStream& stream);
+
+// Returns the fastest kernel this CPU and OS support; the CPU is queried once and the answer reused
+TransformKernel detectTransformKernel();
+
+// Returns kernel, or the fastest supported one if the CPU cannot run it
+TransformKernel supportedTransformKernel(TransformKernel kernel);
+
+// Display name for logs and overlays
+const char* transformKernelName(TransformKernel kernel);
+
+// Writes only the rotated z of every vector in the stream (e.g. face normals); out must be pre-sized
+void rotateDepth(const VertexStream& in, const Matrix3& r, AlignedFloats& out);
+
+// Projects every vertex of in through a screenTransform matrix with the given kernel; out must be sized to in's count
+void transformVertices(const VertexStream& in, const AffineTransform& a, TransformKernel kernel, ScreenStream& out);
+
+// The same for quantized positions, folding the dequantization into a first
+void transformQuantizedVertices(const QuantizedStream& in, const AffineTransform& a, TransformKernel kernel, ScreenStream& out);